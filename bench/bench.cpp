@@ -0,0 +1,193 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include <imgui.h>
+
+#include <nonstd.h>
+#include <nonstd_glfw_opengl.h>
+#include <tile_map.h>
+#include "nonstd_imgui.h"
+
+#define BENCH_WIDTH 1280
+#define BENCH_HEIGHT 720
+#define BENCH_WARMUP_FRAMES 16
+#define BENCH_FRAMES 256
+
+typedef struct bench_fixture_s
+{
+    unsigned int numCameras;
+    camera_t *cameraList;
+    unsigned int numModels;
+    model_t *modelList;
+    map_t map;
+    task_queue_t tq;
+} bench_fixture_t;
+
+static void identity(mat4 m)
+{
+    memset(m, 0, sizeof(mat4));
+    m[0][0] = m[1][1] = m[2][2] = m[3][3] = 1.0f;
+}
+
+static void fixture_node(model_node_t *node, unsigned int depth, unsigned int fanout)
+{
+    identity(node->mTransformation);
+    if (depth == 0)
+        return;
+    node->mNumChildren = fanout;
+    node->mChildren = (model_node_t *)calloc(fanout, sizeof(model_node_t));
+    for (unsigned int i = 0; i < fanout; i++)
+        fixture_node(&(node->mChildren[i]), depth - 1, fanout);
+}
+
+static void fixture_node_free(model_node_t *node)
+{
+    for (unsigned int i = 0; i < node->mNumChildren; i++)
+        fixture_node_free(&(node->mChildren[i]));
+    free(node->mChildren);
+}
+
+// Builds size cameras, size / 8 + 1 models of size meshes and a queue with size pending tasks.
+static void fixture_init(bench_fixture_t *fixture, unsigned int size)
+{
+    memset(fixture, 0, sizeof(bench_fixture_t));
+
+    fixture->numCameras = size;
+    fixture->cameraList = (camera_t *)calloc(size, sizeof(camera_t));
+    for (unsigned int i = 0; i < size; i++)
+    {
+        identity(fixture->cameraList[i].mView);
+        identity(fixture->cameraList[i].mProjection);
+        fixture->cameraList[i].mFOV = 45.0f;
+    }
+
+    fixture->numModels = size / 8 + 1;
+    fixture->modelList = (model_t *)calloc(fixture->numModels, sizeof(model_t));
+    for (unsigned int m = 0; m < fixture->numModels; m++)
+    {
+        model_t *model = &(fixture->modelList[m]);
+        model->mNumMeshes = size;
+        model->mMeshList = (mesh_t *)calloc(size, sizeof(mesh_t));
+        for (unsigned int i = 0; i < size; i++)
+        {
+            mesh_t *mesh = &(model->mMeshList[i]);
+            mesh->mNumInstances = 4;
+            mesh->mTransformation = (mat4 *)calloc(mesh->mNumInstances, sizeof(mat4));
+            for (unsigned int j = 0; j < mesh->mNumInstances; j++)
+                identity(mesh->mTransformation[j]);
+        }
+        fixture_node(&(model->mRootNode), 3, size < 8 ? size : 8);
+    }
+
+    queue_t *q = &(fixture->tq.queue);
+    unsigned int numSlots = size + 1;
+    q->item_size = sizeof(async_task_t);
+    q->buf_len = numSlots * q->item_size;
+    q->start = calloc(numSlots, q->item_size);
+    for (unsigned int i = 0; i < size; i++)
+        ((async_task_t *)q->start)[i].funcName = "bench_task";
+    q->tail = q->start;
+    q->head = (char *)q->start + size * q->item_size;
+}
+
+static void fixture_cleanup(bench_fixture_t *fixture)
+{
+    for (unsigned int m = 0; m < fixture->numModels; m++)
+    {
+        model_t *model = &(fixture->modelList[m]);
+        for (unsigned int i = 0; i < model->mNumMeshes; i++)
+            free(model->mMeshList[i].mTransformation);
+        free(model->mMeshList);
+        fixture_node_free(&(model->mRootNode));
+    }
+    free(fixture->modelList);
+    free(fixture->cameraList);
+    free(fixture->tq.queue.start);
+}
+
+int main(int argc, char **argv)
+{
+    (void)argc;
+    (void)argv;
+
+    GLFWwindow *window = imgui_headless_init(BENCH_WIDTH, BENCH_HEIGHT);
+    if (window == NULL)
+    {
+        fprintf(stderr, "bench: failed to create a headless GL context\n");
+        return 1;
+    }
+
+    nonstd_imgui_t gui;
+    memset(&gui, 0, sizeof(gui));
+    imgui_init(&gui, window);
+    gui.paused = 1;
+    gui.options.file_options.unsaved_changes = 0;
+    gui.options.tool_options.show_model_tool = 1;
+    gui.options.tool_options.show_camera_tool = 1;
+    gui.options.tool_options.show_task_queue_tool = 1;
+    gui.options.tool_options.show_map_tool = 1;
+    gui.options.tool_options.show_scene_tool = 1;
+    gui.options.tool_options.show_metrics_tool = 1;
+    gui.options.tool_options.show_search_tool = 1;
+    gui.options.tool_options.show_debug_draw_tool = 1;
+    // Every model, node, mesh and queue tree is laid out, not just the collapsed headers.
+    gui.open_trees = 1;
+
+    const unsigned int sizes[] = {1, 16, 256, 4096};
+    printf("%8s %12s %12s %12s %10s %10s %12s %12s %10s\n", "size", "avg ms", "min ms", "max ms", "vtx", "idx", "allocs/frame", "heap/frame", "peak KiB");
+    for (unsigned int s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+    {
+        bench_fixture_t fixture;
+        fixture_init(&fixture, sizes[s]);
+        // The fixture queue has no workers, so build the search index inline; the search
+        // tool then finds it current and queues nothing.
+        imgui_search_update(NULL, fixture.numModels, fixture.modelList, 0, NULL);
+
+        for (unsigned int f = 0; f < BENCH_WARMUP_FRAMES; f++)
+        {
+            glfwPollEvents();
+            imgui_draw(&gui, &(fixture.tq), fixture.numCameras, fixture.cameraList, fixture.numModels, fixture.modelList, &(fixture.map));
+        }
+        glFinish();
+
+        double total = 0.0;
+        double minTime = 1e9;
+        double maxTime = 0.0;
+        // imgui_alloc_get_stats refreshes one snapshot per thread, so keep a copy.
+        imgui_alloc_stats_t startStats = *imgui_alloc_get_stats();
+        for (unsigned int f = 0; f < BENCH_FRAMES; f++)
+        {
+            glfwPollEvents();
+            double start = glfwGetTime();
+            imgui_draw(&gui, &(fixture.tq), fixture.numCameras, fixture.cameraList, fixture.numModels, fixture.modelList, &(fixture.map));
+            double elapsed = glfwGetTime() - start;
+            total += elapsed;
+            minTime = elapsed < minTime ? elapsed : minTime;
+            maxTime = elapsed > maxTime ? elapsed : maxTime;
+        }
+        glFinish();
+        const imgui_alloc_stats_t *allocStats = imgui_alloc_get_stats();
+
+        ImDrawData *drawData = ImGui::GetDrawData();
+        printf("%8u %12.4f %12.4f %12.4f %10d %10d %12.2f %12.2f %10.1f\n",
+               sizes[s],
+               total * 1000.0 / BENCH_FRAMES,
+               minTime * 1000.0,
+               maxTime * 1000.0,
+               drawData != NULL ? drawData->TotalVtxCount : 0,
+               drawData != NULL ? drawData->TotalIdxCount : 0,
+               (double)(allocStats->totalAllocs - startStats.totalAllocs) / BENCH_FRAMES,
+               (double)(allocStats->totalHeapAllocs - startStats.totalHeapAllocs) / BENCH_FRAMES,
+               allocStats->peakBytes / 1024.0);
+
+        fixture_cleanup(&fixture);
+    }
+
+    imgui_cleanup(&gui);
+    imgui_headless_cleanup(window);
+    return 0;
+}
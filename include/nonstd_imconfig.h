@@ -0,0 +1,14 @@
+#ifndef NONSTD_IMCONFIG_H
+#define NONSTD_IMCONFIG_H
+
+// Dear ImGui user config, selected with -DIMGUI_USER_CONFIG='"nonstd_imconfig.h"'.
+// Every translation unit that includes imgui.h, the host's included, must be built
+// with it so they all agree on where the current context lives.
+
+// The current context is thread-local, so threads can each draw their own GUI
+// (see imgui_make_current). Defined in nonstd_imgui_context.cpp.
+struct ImGuiContext;
+extern thread_local ImGuiContext *NonstdImGuiTLS;
+#define GImGui NonstdImGuiTLS
+
+#endif /* NONSTD_IMCONFIG_H */
@@ -22,6 +22,7 @@ extern "C"
     typedef struct imgui_tool_options_s
     {
         int show_tool_metrics;
+        int show_tool_profiler;
         int show_tool_debug_log;
         int show_tool_id_stack_tool;
         int show_tool_style_editor;
@@ -31,6 +32,10 @@ extern "C"
         int show_camera_tool;
         int show_task_queue_tool;
         int show_map_tool;
+        int show_scene_tool;
+        int show_metrics_tool;
+        int show_search_tool;
+        int show_debug_draw_tool;
     } imgui_tool_options_t;
 
     typedef struct imgui_main_menu_options_s
@@ -39,22 +44,146 @@ extern "C"
         imgui_tool_options_t tool_options;
     } imgui_main_menu_options_t;
 
+    // Idle modes for imgui_draw, see imgui_frame_idle.
+    // IMGUI_IDLE_REUSE re-submits the previous ImDrawData without rebuilding it,
+    // IMGUI_IDLE_SKIP does no GUI work at all (for hosts that also skip the swap).
+    enum
+    {
+        IMGUI_IDLE_OFF = 0,
+        IMGUI_IDLE_REUSE = 1,
+        IMGUI_IDLE_SKIP = 2
+    };
+
+    // How a staged map parameter change should be applied, see map_changed.
+    enum
+    {
+        IMGUI_MAP_APPLY_OFF = 0,     // no apply while dragging; full apply on release, debounce or Apply
+        IMGUI_MAP_APPLY_PREVIEW = 1, // cheap preview (low resolution tiles only)
+        IMGUI_MAP_APPLY_FULL = 2     // full rebuild of the tile cache
+    };
+
+    typedef void (*imgui_map_changed_fn)(map_t *map, int apply, void *user);
+
+    struct aiScene;
+    struct aiMesh;
+    struct ImGuiContext;
+    struct imgui_renderer_s;
+    struct imgui_profiler_s;
+    struct imgui_thumbnail_cache_s;
+    struct imgui_frame_exchange_s;
+
     typedef struct nonstd_imgui_s
     {
         int paused;
         imgui_main_menu_options_t options;
+
+        int idle_mode;
+        int idle_busy;
+        double idle_wake_until;
+        unsigned long long watch_hash;
+
+        // Imported scenes shown by the scene tool, owned by the host.
+        unsigned int numScenes;
+        const struct aiScene **sceneList;
+
+        // The map tool edits a staged copy of the map parameters and writes them back
+        // in one batch, then calls map_changed with IMGUI_MAP_APPLY_FULL when an edit
+        // is released or held still for map_debounce seconds, and with map_drag_apply
+        // at most every map_debounce seconds while a value is being dragged.
+        imgui_map_changed_fn map_changed;
+        void *map_changed_user;
+        double map_debounce;
+        int map_drag_apply;
+
+        // Index into cameraList the debug draw primitives are projected with, -1 hides them.
+        int debug_camera;
+
+        // Forces every tree node of the tool windows open, the bench lays out whole models with it.
+        int open_trees;
+
+        // Owned by imgui_init and released by imgui_cleanup. Every GUI has its own
+        // ImGui context, backend data, renderer, profiler, thumbnail cache, instance
+        // edits, debug draw read positions and frame exchange; imgui_make_current binds them to the calling thread.
+        struct ImGuiContext *context;
+        GLFWwindow *window;
+        struct imgui_renderer_s *renderer;
+        struct imgui_profiler_s *profiler;
+        struct imgui_thumbnail_cache_s *thumbnails;
+        struct imgui_instance_state_s *instances;
+        struct imgui_debug_reader_s *debug_reader;
+        struct imgui_frame_exchange_s *exchange;
+        int threaded;
+        int input_lock;
+        double frame_time;
     } nonstd_imgui_t;
 
+#define IMGUI_MAX_WINDOWS 16
+
+    GLFWwindow *imgui_headless_init(int width, int height);
+    int imgui_headless_cleanup(GLFWwindow *window);
+    // One process can host several GUIs, one per GLFW window. imgui_init and
+    // imgui_cleanup run on the GLFW main thread with the window's GL context current;
+    // imgui_init leaves the new GUI current on that thread, and returns non-zero with
+    // nothing set up when IMGUI_MAX_WINDOWS GUIs already exist. The ImGui context pointer
+    // is thread-local (see nonstd_imconfig.h), so each thread draws the GUI it made
+    // current and N windows can be drawn by N threads in parallel. The tool windows'
+    // caches (node trees, previews, search indices, ...) are per thread: GUIs drawn
+    // by the same thread share them, and a thread releases its own with
+    // imgui_thread_cleanup, with its GL context current, before it exits.
     int imgui_init(nonstd_imgui_t *gui, GLFWwindow *window);
-    int imgui_cleanup();
-    int imgui_start_frame();
-    int imgui_end_frame();
+    int imgui_cleanup(nonstd_imgui_t *gui);
+    void imgui_make_current(nonstd_imgui_t *gui);
+    nonstd_imgui_t *imgui_get_current();
+    // Tool windows call it before each tree node, it opens the node when the current GUI has open_trees set.
+    void imgui_open_next_tree();
+    void imgui_thread_cleanup();
+
+    // Input for every GUI arrives on the GLFW main thread through per-window
+    // callbacks that switch to the window's context and take gui->input_lock. When
+    // another thread draws the GUI, the host sets it threaded and calls
+    // imgui_platform_new_frame on the main thread once per event loop iteration,
+    // after glfwPollEvents, to update display size, mouse cursor and gamepads; the
+    // drawing thread then only takes the lock around ImGui::NewFrame. Threaded GUIs
+    // do not support multi-viewports.
+    void imgui_set_threaded(nonstd_imgui_t *gui, int threaded);
+    void imgui_platform_new_frame(nonstd_imgui_t *gui);
+    void imgui_input_lock(nonstd_imgui_t *gui);
+    void imgui_input_unlock(nonstd_imgui_t *gui);
 
     void ShowMainMenu(imgui_main_menu_options_t *menu_options);
     void ShowFileMenu(imgui_file_options_t *file_options);
     void ShowTools(imgui_tool_options_t *tool_options);
     void ShowClosePopUp(imgui_file_options_t *file_options);
+    void ShowModelStats(model_t *model);
+    void ShowSceneStats(unsigned int num_models, model_t *model);
+    void imgui_model_stats_cleanup();
+    void imgui_set_scenes(nonstd_imgui_t *gui, unsigned int numScenes, const struct aiScene **sceneList);
+    void imgui_ai_texture_cleanup();
+
+    // imgui_draw is imgui_make_current + imgui_start_frame + imgui_build_frame +
+    // imgui_end_frame. The split lets the host start the UI frame early, run its own
+    // work (and its own ImGui calls) in between, and submit the draw data later; the
+    // split calls act on the calling thread's current GUI.
+    int imgui_start_frame();
+    int imgui_build_frame(
+        nonstd_imgui_t *gui,
+        task_queue_t *tq,
+        unsigned int numCameras,
+        camera_t *cameraList,
+        unsigned int numModels,
+        model_t *modelList,
+        map_t *map);
+    int imgui_end_frame();
 
+    // Threaded submission: the UI thread (the GLFW main thread) calls
+    // imgui_start_frame, imgui_build_frame and imgui_publish_frame, which copies
+    // the draw data into an owned triple buffer. The render thread owning the GL
+    // context calls imgui_submit_frame to draw the latest published frame, after
+    // making the same GUI current on its own thread.
+    int imgui_publish_frame();
+    int imgui_submit_frame();
+
+    // Returns 1 when gui->idle_mode skipped building the frame, 0 otherwise.
     int imgui_draw(
         nonstd_imgui_t *gui,
         task_queue_t *tq,
@@ -64,8 +193,536 @@ extern "C"
         model_t *modelList,
         map_t *map);
 
-    int imgui_capture_key();
-    int imgui_capture_mouse();
+    int imgui_frame_idle(
+        nonstd_imgui_t *gui,
+        task_queue_t *tq,
+        unsigned int numCameras,
+        camera_t *cameraList,
+        unsigned int numModels,
+        model_t *modelList,
+        map_t *map);
+    void imgui_request_redraw(nonstd_imgui_t *gui);
+
+    // Safe to call from the main thread while another thread draws gui.
+    int imgui_capture_key(nonstd_imgui_t *gui);
+    int imgui_capture_mouse(nonstd_imgui_t *gui);
+
+    typedef struct imgui_renderer_stats_s
+    {
+        int streaming;
+        unsigned int drawCalls;
+        unsigned int stalls;
+        unsigned int resizes;
+        unsigned long long bytes;
+    } imgui_renderer_stats_t;
+
+    struct ImDrawData;
+
+    // Persistently mapped, triple-buffered streaming renderer (ARB_buffer_storage).
+    // imgui_renderer_render falls back to ImGui_ImplOpenGL3_RenderDrawData when
+    // imgui_renderer_init could not enable it. imgui_renderer_init creates a renderer
+    // for the current GL context and binds it to the calling thread, cleanup destroys
+    // the bound renderer.
+    struct imgui_renderer_s *imgui_renderer_init();
+    int imgui_renderer_cleanup();
+    void imgui_renderer_bind(struct imgui_renderer_s *renderer);
+    void imgui_renderer_render(struct ImDrawData *drawData);
+    const imgui_renderer_stats_t *imgui_renderer_get_stats();
+
+    typedef struct imgui_alloc_stats_s
+    {
+        unsigned long long frames;
+        unsigned int frameAllocs;     // ImGui allocations during the last frame
+        unsigned int frameHeapAllocs; // of those, how many reached malloc
+        unsigned long long totalAllocs;
+        unsigned long long totalHeapAllocs;
+        unsigned long long bytesInUse;
+        unsigned long long peakBytes;
+        unsigned long long reservedBytes;
+        unsigned long long arenaBytes;
+        unsigned long long arenaPeak;
+        unsigned long long arenaCapacity;
+    } imgui_alloc_stats_t;
+
+    // Pooled ImGui allocator (installed by imgui_init, shared by every GUI and
+    // removed with the last one) and a per-thread, per-frame string arena. Arena
+    // memory is valid until the calling thread's next imgui_start_frame; arena
+    // statistics are those of the calling thread. imgui_frame_alloc returns NULL when
+    // out of memory, imgui_frame_printf then returns "".
+    int imgui_alloc_install();
+    int imgui_alloc_cleanup();
+    void imgui_alloc_thread_cleanup();
+    void imgui_alloc_begin_frame();
+    char *imgui_frame_alloc(size_t size);
+    const char *imgui_frame_printf(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
+    const imgui_alloc_stats_t *imgui_alloc_get_stats();
+
+#define IMGUI_FONT_MAX 16
+
+    typedef struct imgui_font_cache_stats_s
+    {
+        int enabled;
+        int hit;
+        unsigned long long key;
+        unsigned long long bytes; // size of the cache file
+        double seconds;           // time spent loading or baking the atlas in imgui_init
+    } imgui_font_cache_stats_t;
+
+    // Fonts and the atlas cache are configured before imgui_init. ranges are pairs of
+    // first/last codepoints terminated by 0 and are copied; NULL means the default
+    // Latin range. When a cache path is set, imgui_init maps the baked atlas and glyph
+    // tables from that file if its key (ImGui version, atlas settings and the size,
+    // mtime, pixel size and ranges of every font file) matches, and otherwise bakes
+    // the atlas and rewrites the file. Fonts loaded from the cache cannot be rebuilt,
+    // so do not add fonts to io.Fonts after imgui_init.
+    int imgui_font_add(const char *file, float size, const unsigned int *ranges);
+    void imgui_font_cache_path(const char *path);
+    int imgui_font_cache_load();
+    int imgui_font_cache_finish();
+    void imgui_font_cache_cleanup();
+    const imgui_font_cache_stats_t *imgui_font_cache_get_stats();
+
+#define IMGUI_INSTANCE_MERGE_GAP 8
+
+    typedef struct imgui_instance_stats_s
+    {
+        unsigned long long flushes;
+        unsigned int ranges; // of the last flush with edits, after coalescing
+        unsigned int calls;
+        unsigned long long bytes;
+        unsigned long long totalBytes;
+    } imgui_instance_stats_t;
+
+    // Edits made by the instance editor are written to mesh->mTransformation and
+    // recorded as dirty ranges of the current GUI; imgui_instance_flush uploads only
+    // those spans with glBufferSubData once per frame. With imgui_publish_frame the
+    // ranges and a copy of their matrices travel with the published frame and
+    // imgui_submit_frame uploads them on the render thread. The host registers where
+    // a mesh's matrices live in its instance buffer (offset of instance 0 and stride
+    // in bytes, 0 for tightly packed mat4s), with the GUI current on the thread that
+    // builds its frames; unregistered meshes are only edited on the CPU.
+    struct imgui_instance_state_s *imgui_instance_init();
+    void imgui_instance_cleanup();
+    void imgui_instance_bind(struct imgui_instance_state_s *state);
+    void imgui_instance_buffer(const mesh_t *mesh, unsigned int buffer, size_t offset, size_t stride);
+    void imgui_instance_mark(const mesh_t *mesh, unsigned int first, unsigned int count);
+    void imgui_instance_flush();
+    struct imgui_instance_batch_s *imgui_instance_batch_create();
+    void imgui_instance_batch_destroy(struct imgui_instance_batch_s *batch);
+    void imgui_instance_take(struct imgui_instance_batch_s *batch);
+    void imgui_instance_upload(struct imgui_instance_batch_s *batch);
+    const imgui_instance_stats_t *imgui_instance_get_stats();
+
+#define IMGUI_THUMBNAIL_SIZE 64
+#define IMGUI_THUMBNAIL_BUILDS_PER_FRAME 8
+#define IMGUI_THUMBNAIL_DEFAULT_BUDGET (16ull * 1024 * 1024)
+
+    typedef struct imgui_thumbnail_stats_s
+    {
+        unsigned long long budget;
+        unsigned long long bytes;
+        unsigned int count;
+        unsigned int maxBuildsPerFrame;
+        unsigned long long hits;
+        unsigned long long misses;
+        unsigned long long builds;
+        unsigned long long evictions;
+    } imgui_thumbnail_stats_t;
+
+    // LRU cache of downscaled previews of GL textures, bounded by a VRAM budget in bytes.
+    // imgui_thumbnail_get returns 1 and the preview texture once it is built; at most
+    // IMGUI_THUMBNAIL_BUILDS_PER_FRAME previews are built per frame, so callers see 0
+    // for a few frames while a long list fills in. Like the renderer, a cache holds
+    // GL objects of one context: imgui_thumbnail_init creates one and binds it to the
+    // calling thread, cleanup destroys the bound cache. Building a frame makes no GL
+    // calls: misses and evictions are queued, imgui_thumbnail_flush runs them from
+    // imgui_end_frame, and with imgui_publish_frame they travel with the published
+    // frame to imgui_submit_frame. A preview drawn by the current frame is never
+    // evicted; builds wait for room instead.
+    struct imgui_thumbnail_cache_s *imgui_thumbnail_init(unsigned long long budget);
+    int imgui_thumbnail_cleanup();
+    void imgui_thumbnail_bind(struct imgui_thumbnail_cache_s *cache);
+    void imgui_thumbnail_begin_frame();
+    void imgui_thumbnail_set_budget(unsigned long long budget);
+    void imgui_thumbnail_invalidate(unsigned int texture);
+    int imgui_thumbnail_get(unsigned int texture, unsigned int *thumbnail, int *width, int *height);
+    void imgui_thumbnail_flush();
+    struct imgui_thumbnail_batch_s *imgui_thumbnail_batch_create();
+    void imgui_thumbnail_batch_destroy(struct imgui_thumbnail_batch_s *batch);
+    void imgui_thumbnail_take(struct imgui_thumbnail_batch_s *batch);
+    void imgui_thumbnail_run(struct imgui_thumbnail_batch_s *batch);
+    const imgui_thumbnail_stats_t *imgui_thumbnail_get_stats();
+
+    enum
+    {
+        IMGUI_PROJECTION_EQUIRECTANGULAR = 0,
+        IMGUI_PROJECTION_MERCATOR = 1
+    };
+
+    // Preview model of a map_t projection: ellipsoid axes a/b, p1 central meridian and
+    // p2 latitude of origin (degrees), p3 scale factor (0 means 1), p4/p5 false easting
+    // and northing. Geodetic coordinates are shared between ellipsoids (no datum shift).
+    typedef struct imgui_projection_s
+    {
+        int type;
+        double a;
+        double b;
+        double lon0;
+        double lat0;
+        double k0;
+        double x0;
+        double y0;
+    } imgui_projection_t;
+
+    // Batch forward projection of n degree lon/lat pairs in single precision,
+    // dispatched at first use to AVX2+FMA, SSE2 or a scalar loop.
+    void imgui_projection_forward(const imgui_projection_t *projection, const float *lon, const float *lat, float *x, float *y, unsigned int n);
+    const char *imgui_projection_kernel_name();
+    void imgui_projection_forward_reference(const imgui_projection_t *projection, double lon, double lat, double *x, double *y);
+    void imgui_projection_inverse_reference(const imgui_projection_t *projection, double x, double y, double *lon, double *lat);
+
+#define IMGUI_BONE_WEIGHT_BUCKETS 10
+#define IMGUI_BONE_MAX_INFLUENCES 16
+#define IMGUI_BONE_TASKS 8
+
+    enum
+    {
+        IMGUI_BONE_ANALYSIS_QUEUED = 0,
+        IMGUI_BONE_ANALYSIS_DONE = 1,
+        IMGUI_BONE_ANALYSIS_CANCELLED = 2
+    };
+
+    typedef struct imgui_bone_stats_s
+    {
+        unsigned int numWeights;
+        unsigned int zeroWeights;
+        float minWeight;
+        float maxWeight;
+        float avgWeight;
+        unsigned int histogram[IMGUI_BONE_WEIGHT_BUCKETS]; // weight in [0, 1] split evenly
+    } imgui_bone_stats_t;
+
+    // Skinning statistics of one aiMesh, filled by task queue workers. Fields other
+    // than state and processed are only valid once state is IMGUI_BONE_ANALYSIS_DONE.
+    typedef struct imgui_bone_analysis_s
+    {
+        int state;
+        unsigned long long processed; // weights visited so far, out of numWeights
+        unsigned long long numWeights;
+        unsigned int numBones;
+        unsigned int numVertices;
+
+        imgui_bone_stats_t *bones;
+        unsigned int outOfRange;   // weights outside [0, 1] or on vertices past mNumVertices
+        unsigned int unnormalized; // weighted vertices whose weights do not sum to 1
+        unsigned int maxInfluences;
+        // influenceCount[k] vertices have k influences, the last entry counts k >= IMGUI_BONE_MAX_INFLUENCES.
+        unsigned int influenceCount[IMGUI_BONE_MAX_INFLUENCES + 1];
+        // Vertex indices ordered by influence count, most influences first, so the
+        // vertices over any limit are a prefix and the unweighted ones a suffix.
+        unsigned int *order;
+        unsigned char *influences; // per vertex, saturated at 255
+    } imgui_bone_analysis_t;
+
+    // Returns the cached analysis of mesh, queueing it on tq the first time the mesh
+    // is seen (or running it inline when tq is NULL). The mesh must stay alive until
+    // the analysis is done. Progress and cancellation go through an imgui_task_status_t
+    // slot; a cancelled analysis stays cached until imgui_bone_analysis_forget.
+    const imgui_bone_analysis_t *imgui_bone_analysis_get(const struct aiMesh *mesh, task_queue_t *tq);
+    void imgui_bone_analysis_forget(const struct aiMesh *mesh);
+    // Analyses queued or running on any thread; imgui_build_frame stays busy meanwhile.
+    unsigned int imgui_bone_analysis_pending();
+    void imgui_bone_analysis_cleanup();
+
+    enum
+    {
+        IMGUI_SEARCH_MODEL_TEXTURE = 0, // a = material, b = texture type, c = texture index
+        IMGUI_SEARCH_AI_NODE,           // ptr = aiNode
+        IMGUI_SEARCH_AI_METADATA,       // a = key index, ptr = aiNode or NULL for the scene metadata
+        IMGUI_SEARCH_AI_MESH,           // a = mesh index
+        IMGUI_SEARCH_AI_MATERIAL,       // a = material index, b = texture type, c = texture index
+        IMGUI_SEARCH_AI_TEXTURE         // a = texture index
+    };
+
+    typedef struct imgui_search_result_s
+    {
+        int kind;
+        unsigned int source; // index into the model or scene list
+        unsigned int a, b, c;
+        const void *owner; // model_t or aiScene
+        const void *ptr;
+        const char *text; // valid until the next imgui_search_update
+    } imgui_search_result_t;
+
+    typedef struct imgui_search_stats_s
+    {
+        unsigned int entries;
+        unsigned int trigrams;
+        unsigned int building;
+        unsigned long long generation; // bumped whenever a rebuilt index is swapped in
+        double querySeconds;
+    } imgui_search_stats_t;
+
+    // Trigram index over texture paths of models and node, mesh, material texture,
+    // embedded texture and metadata names of scenes. Each model and scene has its own
+    // index, built on tq (inline when tq is NULL) the first time it is seen and again
+    // when its pointer or element counts change, so sources must stay alive while
+    // their index builds. Queries are case-insensitive substring matches; results
+    // beyond max are only counted in total, except for queries shorter than three
+    // characters, which stop at max.
+    void imgui_search_update(task_queue_t *tq, unsigned int numModels, const model_t *models, unsigned int numScenes, const struct aiScene **scenes);
+    unsigned int imgui_search_query(const char *query, imgui_search_result_t *results, unsigned int max, unsigned int *total);
+    const imgui_search_stats_t *imgui_search_get_stats();
+    void imgui_search_cleanup();
+
+#define IMGUI_PROFILER_MAX_FRAMES 256
+#define IMGUI_PROFILER_MAX_SCOPES 32
+#define IMGUI_PROFILER_GPU_QUERIES 4
+
+    typedef struct imgui_profiler_scope_s
+    {
+        const char *name;
+        double start;
+        double end;
+        int depth;
+    } imgui_profiler_scope_t;
+
+    typedef struct imgui_profiler_frame_s
+    {
+        double start;
+        double end;
+        double gpuTime;
+        unsigned int numScopes;
+        imgui_profiler_scope_t scopes[IMGUI_PROFILER_MAX_SCOPES];
+    } imgui_profiler_frame_t;
+
+    // Per GUI, created and bound to the calling thread by imgui_profiler_init.
+    struct imgui_profiler_s *imgui_profiler_init();
+    int imgui_profiler_cleanup();
+    void imgui_profiler_bind(struct imgui_profiler_s *profiler);
+    void imgui_profiler_begin_frame();
+    void imgui_profiler_end_frame();
+    void imgui_profiler_push(const char *name);
+    void imgui_profiler_pop();
+    void imgui_profiler_gpu_begin();
+    void imgui_profiler_gpu_end();
+    unsigned int imgui_profiler_num_frames();
+    const imgui_profiler_frame_t *imgui_profiler_get_frame(unsigned int framesAgo);
+
+#define IMGUI_TQ_SNAPSHOT_MAX 256
+#define IMGUI_TQ_MAX_FUNCS 32
+#define IMGUI_TQ_LATENCY_BUCKETS 16
+
+    typedef struct imgui_tq_snapshot_s
+    {
+        double time;
+        unsigned int numSlots;
+        unsigned int headSlot;
+        unsigned int tailSlot;
+        unsigned int depth;
+        unsigned int numTasks;
+        const char *funcNames[IMGUI_TQ_SNAPSHOT_MAX];
+    } imgui_tq_snapshot_t;
+
+    typedef struct imgui_tq_stats_s
+    {
+        double lastTime;
+        unsigned int lastHeadSlot;
+        unsigned int lastTailSlot;
+        unsigned long long enqueued;
+        unsigned long long dequeued;
+        float enqueueRate;
+        float dequeueRate;
+    } imgui_tq_stats_t;
+
+    // Completed task counters, written by workers through imgui_tq_record. The
+    // tasks this library queues (the test buttons, bone analysis and the search
+    // index build) record themselves; host tasks call it with their funcName and
+    // run time before returning.
+    // Buckets are log2 microseconds: bucket i holds latencies in [2^i, 2^(i+1)) us.
+    typedef struct imgui_tq_func_stats_s
+    {
+        const char *funcName;
+        unsigned long long count;
+        unsigned long long totalMicros;
+        unsigned long long latency[IMGUI_TQ_LATENCY_BUCKETS];
+    } imgui_tq_func_stats_t;
+
+    int imgui_tq_snapshot(task_queue_t *tq, imgui_tq_snapshot_t *snapshot);
+    void imgui_tq_update_stats(imgui_tq_stats_t *stats, const imgui_tq_snapshot_t *snapshot);
+    void imgui_tq_record(const char *funcName, double seconds);
+    unsigned int imgui_tq_read_func_stats(imgui_tq_func_stats_t *out, unsigned int max);
+    unsigned int imgui_tq_depth(task_queue_t *tq);
+
+#define IMGUI_TASK_STATUS_MAX 64
+#define IMGUI_TASK_STATUS_LINGER 5.0 // seconds a finished task stays listed
+
+    enum
+    {
+        IMGUI_TASK_CLAIMED = -1, // being filled in by imgui_task_claim, not shown yet
+        IMGUI_TASK_FREE = 0,
+        IMGUI_TASK_QUEUED,
+        IMGUI_TASK_RUNNING,
+        IMGUI_TASK_DONE,
+        IMGUI_TASK_CANCELLED,
+        IMGUI_TASK_FAILED
+    };
+
+    // Status slot a long running task publishes through; every field is written
+    // with atomics so the task queue tool can read it while the worker runs.
+    typedef struct imgui_task_status_s
+    {
+        int state;
+        int cancel;
+        const char *name;  // string literal
+        const char *stage; // string literal, may change while running
+        unsigned long long done;
+        unsigned long long total; // 0 when unknown
+        unsigned long long bytes;
+        double queuedTime;
+        double startTime;
+        double endTime;
+    } imgui_task_status_t;
+
+    // Protocol: the submitter claims a slot and passes it to the task in its args, the
+    // task calls begin, reports progress, polls imgui_task_cancelled at convenient
+    // points and finishes with imgui_task_end. The slot must not be touched after
+    // imgui_task_end; the tool frees it IMGUI_TASK_STATUS_LINGER seconds later.
+    // Returns NULL when every slot is in use, all other calls accept NULL.
+    imgui_task_status_t *imgui_task_claim(const char *name);
+    void imgui_task_begin(imgui_task_status_t *status);
+    void imgui_task_stage(imgui_task_status_t *status, const char *stage);
+    void imgui_task_progress(imgui_task_status_t *status, unsigned long long done, unsigned long long total, unsigned long long bytes);
+    void imgui_task_advance(imgui_task_status_t *status, unsigned long long done, unsigned long long bytes);
+    int imgui_task_cancelled(const imgui_task_status_t *status);
+    void imgui_task_cancel(imgui_task_status_t *status);
+    void imgui_task_end(imgui_task_status_t *status, int state);
+    imgui_task_status_t *imgui_task_status(unsigned int index);
+    double imgui_task_load_time(const double *time);
+    void imgui_task_reap(double now);
+
+    typedef struct imgui_replay_frame_s
+    {
+        float cpuMs;
+        float gpuMs; // -1 when the timer query never came back
+        unsigned int drawCalls;
+        unsigned int drawLists;
+        unsigned int vertices;
+        unsigned int indices;
+    } imgui_replay_frame_t;
+
+    typedef struct imgui_replay_summary_s
+    {
+        unsigned int frames;
+        float cpuMean;
+        float cpuP50;
+        float cpuP95;
+        float cpuMax;
+        float gpuMean;
+        float drawCallsMean;
+        unsigned int drawCallsMax;
+    } imgui_replay_summary_t;
+
+    // Input record/replay for comparing builds on the same interaction. While
+    // recording, imgui_start_frame appends each frame's new ImGui input events, delta
+    // time and display size to a binary log that starts with the ini layout and tool
+    // options. Replaying restores both and then feeds the log through ImGuiIO instead
+    // of the backend's input, one logged frame per imgui_start_frame, timing every
+    // frame. Logs only replay on the ImGui version that wrote them. imgui_replay_run
+    // draws frames until the log is exhausted, which works with imgui_headless_init.
+    // Recorder and player belong to the calling thread and act on the GUI it draws.
+    int imgui_record_begin(const char *path, const imgui_tool_options_t *tools);
+    int imgui_record_end();
+    int imgui_recording();
+    unsigned int imgui_record_frames();
+    int imgui_replay_begin(const char *path, imgui_tool_options_t *tools);
+    int imgui_replay_end();
+    int imgui_replay_active();
+    int imgui_replay_run(
+        nonstd_imgui_t *gui,
+        task_queue_t *tq,
+        unsigned int numCameras,
+        camera_t *cameraList,
+        unsigned int numModels,
+        model_t *modelList,
+        map_t *map);
+    void imgui_replay_new_frame();
+    void imgui_replay_end_frame();
+    unsigned int imgui_replay_progress(unsigned int *total);
+    unsigned int imgui_replay_num_frames();
+    const imgui_replay_frame_t *imgui_replay_get_frames();
+    void imgui_replay_summarize(imgui_replay_summary_t *summary);
+    int imgui_replay_write_report(const char *path);
+    void imgui_replay_cleanup();
+
+#define IMGUI_METRIC_MAX 64
+#define IMGUI_METRIC_CAPACITY (1 << 17)
+
+    typedef struct imgui_metric_bucket_s
+    {
+        float min;
+        float max;
+        float avg;
+    } imgui_metric_bucket_t;
+
+    // Time series shown by the Metrics tool. name identifies the series and is copied
+    // by the first push, so it may live on the stack; each series keeps its last
+    // IMGUI_METRIC_CAPACITY samples. imgui_metric_push is lock-free and may be called
+    // from any number of threads; concurrent producers of one series interleave their
+    // samples, and each sample is published with one atomic store. Built in series
+    // are "imgui.frame_ms" and "task_queue.depth", fed by every GUI; hosts add their own, for example
+    // imgui_metric_push("map.tile_load_ms", ms) from the tile loader.
+    void imgui_metric_push(const char *name, float value);
+    unsigned int imgui_metric_count();
+    const char *imgui_metric_name(unsigned int index);
+    unsigned long long imgui_metric_total(unsigned int index);
+    unsigned int imgui_metric_decimate(unsigned int index, unsigned int numSamples, imgui_metric_bucket_t *buckets, unsigned int numBuckets);
+    void imgui_metrics_cleanup();
+
+#define IMGUI_DEBUG_CHANNELS 32
+#define IMGUI_DEBUG_MAX_THREADS 64
+#define IMGUI_DEBUG_PRIMITIVES (1 << 14) // ring of lines, boxes and points per thread
+#define IMGUI_DEBUG_TEXTS (1 << 10)
+#define IMGUI_DEBUG_TEXT_MAX 64
+#define IMGUI_DEBUG_DEFAULT_BUDGET (1 << 16)
+
+    typedef struct imgui_debug_stats_s
+    {
+        unsigned int threads;            // submitting threads
+        unsigned int drawn;              // primitives drawn by the last imgui_debug_render
+        unsigned int culled;             // behind the camera
+        unsigned long long overBudget;   // skipped once the budget was reached
+        unsigned long long lost;         // overwritten before they were drawn
+        unsigned long long unregistered; // dropped because all IMGUI_DEBUG_MAX_THREADS buffers are taken, total
+    } imgui_debug_stats_t;
+
+    // Immediate mode debug drawing in world space from any thread, without locks.
+    // Each thread appends to its own rings of IMGUI_DEBUG_PRIMITIVES primitives and
+    // IMGUI_DEBUG_TEXTS labels that overwrite their oldest entries, so submitting
+    // never waits on the GUI; submissions to a disabled channel return after one
+    // load. imgui_build_frame draws everything submitted since the GUI's previous
+    // frame into the background draw list through gui->debug_camera, stopping at the
+    // primitive budget; each GUI keeps its own read positions, so every GUI sees
+    // every primitive. channel is below IMGUI_DEBUG_CHANNELS and its name usually a
+    // string literal. Colors are IM_COL32 values, a box counts as one primitive and a
+    // point's radius is in pixels.
+    void imgui_debug_line(unsigned int channel, const float a[3], const float b[3], unsigned int color);
+    void imgui_debug_box(unsigned int channel, const float min[3], const float max[3], unsigned int color);
+    void imgui_debug_point(unsigned int channel, const float p[3], float radius, unsigned int color);
+    void imgui_debug_text(unsigned int channel, const float p[3], unsigned int color, const char *fmt, ...) __attribute__((format(printf, 4, 5)));
+    void imgui_debug_enable(unsigned int channel, int enabled);
+    int imgui_debug_enabled(unsigned int channel);
+    void imgui_debug_channel_name(unsigned int channel, const char *name);
+    const char *imgui_debug_get_channel_name(unsigned int channel);
+    void imgui_debug_set_budget(unsigned int primitives);
+    unsigned int imgui_debug_get_budget();
+    struct imgui_debug_reader_s *imgui_debug_reader_init();
+    int imgui_debug_reader_cleanup();
+    void imgui_debug_reader_bind(struct imgui_debug_reader_s *reader);
+    int imgui_debug_pending();
+    void imgui_debug_render(const camera_t *camera);
+    const imgui_debug_stats_t *imgui_debug_get_stats();
+    void imgui_debug_cleanup();
 
 #ifdef __cplusplus
 }
@@ -1,7 +1,14 @@
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
 
 #include <imgui.h>
+#include <imgui_internal.h>
 #include <imgui_impl_glfw.h>
 #include <imgui_impl_opengl3.h>
 
@@ -10,12 +17,114 @@
 #include <tile_map.h>
 #include "nonstd_imgui.h"
 
+// Creates an invisible window with a current GL context that imgui_init can
+// drive. Without a display server GLFW's null platform is used with an EGL
+// (surfaceless) context, falling back to OSMesa/llvmpipe.
+GLFWwindow *imgui_headless_init(int width, int height)
+{
+    int hasDisplay = getenv("DISPLAY") != NULL || getenv("WAYLAND_DISPLAY") != NULL;
+#ifdef GLFW_PLATFORM_NULL
+    if (!hasDisplay)
+        glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+#endif
+    if (!glfwInit())
+        return NULL;
+
+    glfwDefaultWindowHints();
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    if (!hasDisplay)
+        glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_EGL_CONTEXT_API);
+
+    GLFWwindow *window = glfwCreateWindow(width, height, "nonstd_imgui headless", NULL, NULL);
+    if (window == NULL && !hasDisplay)
+    {
+        glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
+        window = glfwCreateWindow(width, height, "nonstd_imgui headless", NULL, NULL);
+    }
+    if (window == NULL)
+    {
+        glfwTerminate();
+        return NULL;
+    }
+
+    glfwMakeContextCurrent(window);
+    glewExperimental = GL_TRUE;
+    GLenum err = glewInit();
+    // GLEW reports GLEW_ERROR_NO_GLX_DISPLAY for EGL contexts even though the entry points are loaded.
+    if (err != GLEW_OK && err != GLEW_ERROR_NO_GLX_DISPLAY)
+    {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return NULL;
+    }
+    return window;
+}
+
+int imgui_headless_cleanup(GLFWwindow *window)
+{
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return 0;
+}
+
+// GUIs alive; shared modules are released with the last one. imgui_init and
+// imgui_cleanup only run on the GLFW main thread.
+static int guiCount = 0;
+static thread_local nonstd_imgui_t *currentGui = NULL;
+
+int imgui_window_install(nonstd_imgui_t *gui, GLFWwindow *window);
+void imgui_window_uninstall(GLFWwindow *window);
+static struct imgui_frame_exchange_s *imgui_exchange_create();
+static void imgui_exchange_destroy(struct imgui_frame_exchange_s *exchange);
+
+// Binds gui's ImGui context, renderer, profiler, thumbnail cache, instance edits and
+// debug draw reader to the calling thread. Only one thread may build a GUI's frames at a time; the render thread of
+// imgui_submit_frame makes the same GUI current to draw them.
+void imgui_make_current(nonstd_imgui_t *gui)
+{
+    currentGui = gui;
+    ImGui::SetCurrentContext(gui != NULL ? gui->context : NULL);
+    imgui_renderer_bind(gui != NULL ? gui->renderer : NULL);
+    imgui_profiler_bind(gui != NULL ? gui->profiler : NULL);
+    imgui_thumbnail_bind(gui != NULL ? gui->thumbnails : NULL);
+    imgui_instance_bind(gui != NULL ? gui->instances : NULL);
+    imgui_debug_reader_bind(gui != NULL ? gui->debug_reader : NULL);
+}
+
+nonstd_imgui_t *imgui_get_current()
+{
+    return currentGui;
+}
+
+void imgui_open_next_tree()
+{
+    if (currentGui != NULL && currentGui->open_trees)
+        ImGui::SetNextItemOpen(true);
+}
+
 int imgui_init(nonstd_imgui_t *gui, GLFWwindow *window)
 {
     // Setup Dear ImGui context
     IMGUI_CHECKVERSION();
-    ImGui::CreateContext();
+    imgui_alloc_install();
+    guiCount++;
+    gui->context = ImGui::CreateContext();
+    gui->window = window;
+    gui->renderer = NULL;
+    gui->profiler = NULL;
+    gui->thumbnails = NULL;
+    gui->instances = NULL;
+    gui->debug_reader = NULL;
+    gui->exchange = imgui_exchange_create();
+    gui->threaded = 0;
+    gui->input_lock = 0;
+    gui->frame_time = 0.0;
+    imgui_make_current(gui);
     ImGuiIO &io = ImGui::GetIO();
+    imgui_font_cache_load();
     io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard; // Enable Keyboard Controls
     io.ConfigFlags |= ImGuiConfigFlags_NavEnableGamepad;  // Enable Gamepad Controls
     io.ConfigFlags |= ImGuiConfigFlags_DockingEnable;     // Enable Docking
@@ -35,13 +144,41 @@ int imgui_init(nonstd_imgui_t *gui, GLFWwindow *window)
         style.Colors[ImGuiCol_WindowBg].w = 1.0f;
     }
 
-    // Setup Platform/Renderer backends
-    ImGui_ImplGlfw_InitForOpenGL(window, true);
+    // Setup Platform/Renderer backends. The backend's own callbacks would feed
+    // whichever context is current on the main thread, so events are routed per window.
+    ImGui_ImplGlfw_InitForOpenGL(window, false);
+    if (imgui_window_install(gui, window) != 0)
+    {
+        // Every window slot is taken, the GUI would never receive input.
+        ImGui_ImplGlfw_Shutdown();
+        imgui_exchange_destroy(gui->exchange);
+        ImGui::DestroyContext(gui->context);
+        imgui_make_current(NULL);
+        gui->context = NULL;
+        gui->exchange = NULL;
+        if (--guiCount == 0)
+            imgui_font_cache_cleanup();
+        imgui_alloc_cleanup();
+        return 1;
+    }
     const char *glsl_version = "#version 130";
     ImGui_ImplOpenGL3_Init(glsl_version);
+    // Create the renderer's device objects (and bake the font atlas) now, while
+    // the GL context is current, so frames can later be built on a thread without it.
+    ImGui_ImplOpenGL3_NewFrame();
+    imgui_font_cache_finish();
+    gui->renderer = imgui_renderer_init();
+    gui->profiler = imgui_profiler_init();
+    gui->thumbnails = imgui_thumbnail_init(IMGUI_THUMBNAIL_DEFAULT_BUDGET);
+    gui->instances = imgui_instance_init();
+    gui->debug_reader = imgui_debug_reader_init();
 
     {
         gui->paused = 1;
+        gui->idle_mode = IMGUI_IDLE_OFF;
+        gui->idle_busy = 1;
+        gui->idle_wake_until = 0.0;
+        gui->watch_hash = 0;
         gui->options.file_options.options_enabled = 0;
         gui->options.file_options.should_close = 0;
         gui->options.file_options.requesting_close = 0;
@@ -51,18 +188,79 @@ int imgui_init(nonstd_imgui_t *gui, GLFWwindow *window)
         gui->options.tool_options.show_tool_debug_log = 0;
         gui->options.tool_options.show_tool_id_stack_tool = 0;
         gui->options.tool_options.show_tool_metrics = 0;
+        gui->options.tool_options.show_tool_profiler = 0;
         gui->options.tool_options.show_tool_style_editor = 0;
+        gui->options.tool_options.show_scene_tool = 0;
+        gui->options.tool_options.show_metrics_tool = 0;
+        gui->options.tool_options.show_search_tool = 0;
+        gui->options.tool_options.show_debug_draw_tool = 0;
+        gui->numScenes = 0;
+        gui->sceneList = NULL;
+        gui->map_changed = NULL;
+        gui->map_changed_user = NULL;
+        gui->map_debounce = 0.25;
+        gui->map_drag_apply = IMGUI_MAP_APPLY_PREVIEW;
+        gui->debug_camera = 0;
+        gui->open_trees = 0;
     }
 
     return 0;
 }
 
-int imgui_cleanup()
+void imgui_node_tree_cleanup();
+void imgui_map_preview_cleanup();
+void imgui_camera_table_cleanup();
+void imgui_instance_editor_cleanup();
+void imgui_search_window_cleanup();
+
+// Releases the tool window caches of the calling thread, with the GL context they
+// were drawn with current.
+void imgui_thread_cleanup()
+{
+    imgui_model_stats_cleanup();
+    imgui_node_tree_cleanup();
+    imgui_map_preview_cleanup();
+    imgui_camera_table_cleanup();
+    imgui_instance_editor_cleanup();
+    imgui_ai_texture_cleanup();
+    imgui_bone_analysis_cleanup();
+    imgui_search_cleanup();
+    imgui_search_window_cleanup();
+    imgui_replay_cleanup();
+    imgui_alloc_thread_cleanup();
+}
+
+int imgui_cleanup(nonstd_imgui_t *gui)
 {
     // Cleanup
+    imgui_make_current(gui);
+    imgui_thread_cleanup();
+    imgui_exchange_destroy(gui->exchange);
+    imgui_instance_cleanup();
+    imgui_debug_reader_cleanup();
+    imgui_thumbnail_cleanup();
+    imgui_profiler_cleanup();
+    imgui_renderer_cleanup();
     ImGui_ImplOpenGL3_Shutdown();
+    imgui_window_uninstall(gui->window);
     ImGui_ImplGlfw_Shutdown();
-    ImGui::DestroyContext();
+    ImGui::DestroyContext(gui->context);
+    imgui_make_current(NULL);
+    gui->context = NULL;
+    gui->exchange = NULL;
+    gui->renderer = NULL;
+    gui->profiler = NULL;
+    gui->thumbnails = NULL;
+    gui->instances = NULL;
+    gui->debug_reader = NULL;
+
+    if (--guiCount == 0)
+    {
+        imgui_metrics_cleanup();
+        imgui_debug_cleanup();
+        imgui_font_cache_cleanup();
+    }
+    imgui_alloc_cleanup();
 
     return 0;
 }
@@ -85,6 +283,124 @@ void ShowAiMat4(const char *name, aiMatrix4x4 matrix)
     ImGui::Text("[%.3f,%.3f,%.3f,%.3f]", matrix.a4, matrix.b4, matrix.c4, matrix.d4);
 }
 
+// Example of the progress protocol: sleeps through 100 steps, cancellable between steps.
+static void *TQProgressTest(void *args)
+{
+    imgui_task_status_t *status = (imgui_task_status_t *)args;
+    const unsigned int steps = 100;
+    double start = glfwGetTime();
+    int state = IMGUI_TASK_DONE;
+    imgui_task_begin(status);
+    imgui_task_stage(status, "Sleeping");
+    for (unsigned int i = 0; i < steps; i++)
+    {
+        if (imgui_task_cancelled(status))
+        {
+            state = IMGUI_TASK_CANCELLED;
+            break;
+        }
+        usleep(50000);
+        imgui_task_progress(status, i + 1, steps, (i + 1) * 1024ull * 1024ull);
+    }
+    imgui_task_end(status, state);
+    imgui_tq_record("imgui_progress_test", glfwGetTime() - start);
+    return NULL;
+}
+
+// Times async_async_test for the per-function stats of the task queue tool.
+static void *TQAsyncTest(void *args)
+{
+    double start = glfwGetTime();
+    void *result = async_async_test(args);
+    imgui_tq_record("async_async_test", glfwGetTime() - start);
+    return result;
+}
+
+static const char *TaskStateName(int state)
+{
+    switch (state)
+    {
+    case IMGUI_TASK_QUEUED:
+        return "queued";
+    case IMGUI_TASK_RUNNING:
+        return "running";
+    case IMGUI_TASK_DONE:
+        return "done";
+    case IMGUI_TASK_CANCELLED:
+        return "cancelled";
+    case IMGUI_TASK_FAILED:
+        return "failed";
+    default:
+        return "-";
+    }
+}
+
+static void ShowTaskStatusTable()
+{
+    const ImGuiTableFlags tableFlags = ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersOuter | ImGuiTableFlags_BordersV;
+    if (!ImGui::BeginTable("In Flight Table", 6, tableFlags))
+        return;
+    ImGui::TableSetupColumn("Task", ImGuiTableColumnFlags_WidthFixed);
+    ImGui::TableSetupColumn("Stage", ImGuiTableColumnFlags_WidthFixed);
+    ImGui::TableSetupColumn("Progress", ImGuiTableColumnFlags_WidthFixed, 200.0f);
+    ImGui::TableSetupColumn("Elapsed", ImGuiTableColumnFlags_WidthFixed);
+    ImGui::TableSetupColumn("Throughput", ImGuiTableColumnFlags_WidthFixed);
+    ImGui::TableSetupColumn("", ImGuiTableColumnFlags_WidthFixed);
+    ImGui::TableHeadersRow();
+
+    double now = glfwGetTime();
+    for (unsigned int i = 0; i < IMGUI_TASK_STATUS_MAX; i++)
+    {
+        imgui_task_status_t *status = imgui_task_status(i);
+        if (status == NULL)
+            continue;
+        int state = __atomic_load_n(&(status->state), __ATOMIC_ACQUIRE);
+        // Reaped and claimed again since imgui_task_status.
+        if (state <= IMGUI_TASK_FREE)
+            continue;
+        const char *name = __atomic_load_n(&(status->name), __ATOMIC_RELAXED);
+        const char *stage = __atomic_load_n(&(status->stage), __ATOMIC_ACQUIRE);
+        unsigned long long done = __atomic_load_n(&(status->done), __ATOMIC_ACQUIRE);
+        unsigned long long total = __atomic_load_n(&(status->total), __ATOMIC_RELAXED);
+        unsigned long long bytes = __atomic_load_n(&(status->bytes), __ATOMIC_RELAXED);
+        double start = imgui_task_load_time(&(status->startTime));
+        double end = state >= IMGUI_TASK_DONE ? imgui_task_load_time(&(status->endTime)) : now;
+        double elapsed = state == IMGUI_TASK_QUEUED ? now - imgui_task_load_time(&(status->queuedTime)) : end - start;
+
+        ImGui::PushID((int)i);
+        ImGui::TableNextRow();
+        ImGui::TableNextColumn();
+        ImGui::TextUnformatted(name != NULL ? name : "(null)");
+        ImGui::TableNextColumn();
+        ImGui::Text("%s", state == IMGUI_TASK_RUNNING && stage != NULL ? stage : TaskStateName(state));
+        ImGui::TableNextColumn();
+        if (total > 0)
+            ImGui::ProgressBar((float)((double)done / (double)total), ImVec2(-FLT_MIN, 0), imgui_frame_printf("%llu / %llu", done, total));
+        else if (state == IMGUI_TASK_RUNNING)
+            ImGui::ProgressBar(-1.0f * (float)now, ImVec2(-FLT_MIN, 0), imgui_frame_printf("%llu", done));
+        else
+            ImGui::TextDisabled("-");
+        ImGui::TableNextColumn();
+        ImGui::Text("%.1f s%s", elapsed, state == IMGUI_TASK_QUEUED ? " queued" : "");
+        ImGui::TableNextColumn();
+        if (state != IMGUI_TASK_QUEUED && elapsed > 0.0 && bytes > 0)
+            ImGui::Text("%.2f MiB/s", bytes / elapsed / (1024.0 * 1024.0));
+        else
+            ImGui::TextDisabled("-");
+        ImGui::TableNextColumn();
+        if (state <= IMGUI_TASK_RUNNING)
+        {
+            bool cancelling = imgui_task_cancelled(status);
+            ImGui::BeginDisabled(cancelling);
+            if (ImGui::SmallButton(cancelling ? "Cancelling" : "Cancel"))
+                imgui_task_cancel(status);
+            ImGui::EndDisabled();
+        }
+        ImGui::PopID();
+    }
+    ImGui::EndTable();
+}
+
 void ShowTQToolWindow(bool *p_open, task_queue_t *tq)
 {
     if (!ImGui::Begin("Task Queue Tool Window", p_open, ImGuiWindowFlags_AlwaysAutoResize))
@@ -97,76 +413,122 @@ void ShowTQToolWindow(bool *p_open, task_queue_t *tq)
     {
         async_task_t task = {0};
         task.funcName = "async_async_test";
-        task.func = async_async_test;
+        task.func = TQAsyncTest;
         task.args = tq;
         QUEUE_PUSH(tq->queue, task, 1);
     }
-    queue_t *q = &(tq->queue);
-    void *item = q->tail;
-    while (item != q->head)
+    ImGui::SameLine();
+    if (ImGui::Button("Progress Test"))
     {
-        async_task_t *task = (async_task_t *)item;
-        ImGui::Text("%s", task->funcName);
-        item += q->item_size;
-        if (item + q->item_size > q->start + q->buf_len)
+        imgui_task_status_t *status = imgui_task_claim("Progress Test");
+        if (status != NULL)
         {
-            item = q->start;
+            async_task_t task = {0};
+            task.funcName = "imgui_progress_test";
+            task.func = TQProgressTest;
+            task.args = status;
+            QUEUE_PUSH(tq->queue, task, 1);
         }
     }
 
-    ImGui::End();
-}
+    static thread_local imgui_tq_snapshot_t snapshot;
+    static thread_local imgui_tq_stats_t stats;
+    imgui_tq_snapshot(tq, &snapshot);
+    imgui_tq_update_stats(&stats, &snapshot);
 
-void ShowCamera(camera_t *camera)
-{
-    static ImGuiSliderFlags flags = ImGuiSliderFlags_None;
+    ImGui::Separator();
+    ImGui::Text("Depth: %u / %u", snapshot.depth, snapshot.numSlots);
+    ImGui::Text("Enqueue: %.1f/s (%llu total)", stats.enqueueRate, stats.enqueued);
+    ImGui::Text("Dequeue: %.1f/s (%llu total)", stats.dequeueRate, stats.dequeued);
+    ImGui::Separator();
 
-    if (ImGui::CollapsingHeader("Camera"))
+    imgui_open_next_tree();
+    if (ImGui::TreeNodeEx("In Flight", ImGuiTreeNodeFlags_DefaultOpen))
     {
-
-        ImGui::DragFloat("Sensitivity", &(camera->mMouseSensitivity), 0.005f, -FLT_MAX, FLT_MAX, "%f", flags);
-        ImGui::Separator();
-        ImGui::DragFloat("Pos X", &(camera->mPosition[0]), 0.005f, -FLT_MAX, FLT_MAX, "%.3f", flags);
-        ImGui::DragFloat("Pos Y", &(camera->mPosition[1]), 0.005f, -FLT_MAX, FLT_MAX, "%.3f", flags);
-        ImGui::DragFloat("Pos Z", &(camera->mPosition[2]), 0.005f, -FLT_MAX, FLT_MAX, "%.3f", flags);
-
-        ImGui::DragFloat("Pitch X", &(camera->mPitch), 0.05f, -180.0f, 180.0f, "%.3f", flags);
-        ImGui::DragFloat("Roll X", &(camera->mRoll), 0.05f, -180.0f, 180.0f, "%.3f", flags);
-        ImGui::DragFloat("Yaw X", &(camera->mYaw), 0.05f, -180.0f, 180.0f, "%.3f", flags);
-
-        ImGui::DragFloat("FOV", &(camera->mFOV), 0.05f, 0.0f, 180.0f, "%.3f", flags);
-        ImGui::Separator();
-
-        ImGui::Text("Front:  [%.3f,%.3f,%.3f]", camera->front[0], camera->front[1], camera->front[2]);
-        ImGui::Text("Woldup: [%.3f,%.3f,%.3f]", camera->mWorldUp[0], camera->mWorldUp[1], camera->mWorldUp[2]);
-        ImGui::Text("up:     [%.3f,%.3f,%.3f]", camera->up[0], camera->up[1], camera->up[2]);
-        ImGui::Separator();
-        ShowMat4("View:", camera->mView);
-        ImGui::Separator();
-        ShowMat4("projection:", camera->mProjection);
+        ShowTaskStatusTable();
+        ImGui::TreePop();
     }
-}
 
-void ShowCameraToolWindow(bool *p_open, unsigned int numCameras, camera_t *camera)
-{
-    if (!ImGui::Begin("Camera Tool Window", p_open, ImGuiWindowFlags_AlwaysAutoResize))
+    imgui_open_next_tree();
+    if (ImGui::TreeNode("Pending"))
     {
-        ImGui::End();
-        return;
+        // Per-funcName counts over the copied part of the queue.
+        const char *names[IMGUI_TQ_MAX_FUNCS];
+        unsigned int counts[IMGUI_TQ_MAX_FUNCS];
+        unsigned int numNames = 0;
+        for (unsigned int i = 0; i < snapshot.numTasks; i++)
+        {
+            const char *name = snapshot.funcNames[i] != NULL ? snapshot.funcNames[i] : "(null)";
+            unsigned int n = 0;
+            while (n < numNames && strcmp(names[n], name) != 0)
+                n++;
+            if (n == numNames)
+            {
+                if (numNames == IMGUI_TQ_MAX_FUNCS)
+                    continue;
+                names[n] = name;
+                counts[n] = 0;
+                numNames++;
+            }
+            counts[n]++;
+        }
+        if (snapshot.numTasks < snapshot.depth)
+            ImGui::Text("Showing first %u of %u", snapshot.numTasks, snapshot.depth);
+        for (unsigned int n = 0; n < numNames; n++)
+            ImGui::Text("%s : %u", names[n], counts[n]);
+
+        ImGui::BeginChild("Pending Tasks", ImVec2(0, ImGui::GetTextLineHeightWithSpacing() * 10), ImGuiChildFlags_Border);
+        ImGuiListClipper clipper;
+        clipper.Begin((int)snapshot.numTasks);
+        while (clipper.Step())
+        {
+            for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++)
+                ImGui::Text("%s", snapshot.funcNames[i] != NULL ? snapshot.funcNames[i] : "(null)");
+        }
+        ImGui::EndChild();
+        ImGui::TreePop();
     }
-    ImGui::Text("Camera Tool Window");
-    ImGui::Separator();
-    for (unsigned int index = 0; index < numCameras; index++)
+
+    imgui_open_next_tree();
+    if (ImGui::TreeNode("Completed"))
     {
-        ShowCamera(&(camera[index]));
+        imgui_tq_func_stats_t funcStats[IMGUI_TQ_MAX_FUNCS];
+        unsigned int numFuncs = imgui_tq_read_func_stats(funcStats, IMGUI_TQ_MAX_FUNCS);
+        if (numFuncs == 0)
+            ImGui::Text("No tasks reported through imgui_tq_record");
+        for (unsigned int i = 0; i < numFuncs; i++)
+        {
+            imgui_tq_func_stats_t *entry = &(funcStats[i]);
+            double avg = entry->count > 0 ? (double)entry->totalMicros / (double)entry->count : 0.0;
+            imgui_open_next_tree();
+            if (ImGui::TreeNode((void *)(intptr_t)i, "%s : %llu, avg %.1f us", entry->funcName, entry->count, avg))
+            {
+                float histogram[IMGUI_TQ_LATENCY_BUCKETS];
+                for (unsigned int b = 0; b < IMGUI_TQ_LATENCY_BUCKETS; b++)
+                    histogram[b] = (float)entry->latency[b];
+                ImGui::PlotHistogram("log2(us)", histogram, IMGUI_TQ_LATENCY_BUCKETS, 0, NULL, 0.0f, FLT_MAX, ImVec2(0, 60));
+                ImGui::TreePop();
+            }
+        }
+        ImGui::TreePop();
     }
 
     ImGui::End();
 }
 
+// Camera table, frustum overlay and camera details, in nonstd_imgui_cameras.cpp.
+void ShowCameraToolWindow(bool *p_open, unsigned int numCameras, camera_t *camera);
+
 void showTexture(material_texture_t *texture)
 {
-
+    unsigned int thumbnail = 0;
+    int width = 0, height = 0;
+    if (imgui_thumbnail_get((unsigned int)texture->mTexturePtr, &thumbnail, &width, &height))
+    {
+        ImGui::Image((ImTextureID)(intptr_t)thumbnail, ImVec2((float)width, (float)height));
+        ImGui::SameLine();
+    }
+    ImGui::BeginGroup();
     ImGui::Text("path: %s", texture->path.data);
     ImGui::Text("mapping: %d", texture->mapping);
     ImGui::Text("uvindex: %u", texture->uvindex);
@@ -175,6 +537,50 @@ void showTexture(material_texture_t *texture)
     ImGui::Text("mapmode: %u", texture->mapmode);
     ImGui::Text("flags: %u", texture->flags);
     ImGui::Text("mTextureIndex: %lu", texture->mTexturePtr);
+    ImGui::EndGroup();
+}
+
+void ShowThumbnailStats()
+{
+    const imgui_thumbnail_stats_t *stats = imgui_thumbnail_get_stats();
+    int budgetMB = (int)(stats->budget / (1024 * 1024));
+    if (ImGui::SliderInt("Budget (MB)", &budgetMB, 1, 256))
+        imgui_thumbnail_set_budget((unsigned long long)budgetMB * 1024 * 1024);
+    ImGui::ProgressBar(stats->budget > 0 ? (float)((double)stats->bytes / (double)stats->budget) : 0.0f);
+    ImGui::Text("Thumbnails: %u (%.2f MB)", stats->count, (double)stats->bytes / (1024.0 * 1024.0));
+    ImGui::Text("Hits: %llu  Misses: %llu", stats->hits, stats->misses);
+    ImGui::Text("Builds: %llu  Evictions: %llu", stats->builds, stats->evictions);
+}
+
+// Result picked in the search tool. The tree nodes on its path are forced open
+// for a few frames so windows drawn before the search tool catch up as well.
+#define SEARCH_NAV_FRAMES 3
+
+typedef struct search_nav_s
+{
+    imgui_search_result_t target;
+    int frames;
+    int revealed; // node trees only scroll to the target once
+} search_nav_t;
+
+static thread_local search_nav_t searchNav;
+
+static bool SearchNavOwner(const void *owner)
+{
+    return searchNav.frames > 0 && searchNav.target.owner == owner;
+}
+
+static bool SearchNavKind(const void *owner, int kind)
+{
+    return SearchNavOwner(owner) && searchNav.target.kind == kind;
+}
+
+static void SearchNavOpen(bool open)
+{
+    if (open)
+        ImGui::SetNextItemOpen(true);
+    else
+        imgui_open_next_tree();
 }
 
 #define X(N) #N,
@@ -184,15 +590,22 @@ const char *materialNames[] = {
 
 void ShowMaterial(material_t *material)
 {
+    bool navigating = searchNav.frames > 0 && searchNav.target.kind == IMGUI_SEARCH_MODEL_TEXTURE && searchNav.target.ptr == material;
     for (unsigned int type = 0; type < AI_TEXTURE_TYPE_MAX + 1; type++)
     {
         if (material->mTextureCount[type] > 0)
         {
+            SearchNavOpen(navigating && searchNav.target.b == type);
             if (ImGui::TreeNode((void *)(intptr_t)type, "Texture %s", materialNames[type]))
             {
                 for (unsigned int index = 0; index < material->mTextureCount[type]; index++)
                 {
-                    if (ImGui::TreeNode((void *)(intptr_t)index, "Texture %d", index))
+                    bool target = navigating && searchNav.target.b == type && searchNav.target.c == index;
+                    SearchNavOpen(target);
+                    bool open = ImGui::TreeNode((void *)(intptr_t)index, "Texture %d", index);
+                    if (target)
+                        ImGui::SetScrollHereY(0.25f);
+                    if (open)
                     {
                         showTexture(&(material->mTextures[type][index]));
                         ImGui::TreePop();
@@ -211,31 +624,328 @@ void ShowMaterial(material_t *material)
     }
 }
 
-void ShowMesh(mesh_t *mesh)
+// Instance table and transform editor, in nonstd_imgui_instance_editor.cpp.
+void ShowMesh(mesh_t *mesh);
+
+void ShowShader(const shader_t *shader)
+{
+}
+
+// Flattened, preorder copy of a node hierarchy. Built once per root and only
+// rebuilt when the root's children change, then drawn iteratively with a
+// list clipper so per-frame cost follows the visible rows, not the tree size.
+typedef struct imgui_flat_node_s
+{
+    const void *node;
+    int parent;
+    int depth;
+    int end;
+    int childIndex;
+    unsigned int label;
+    unsigned int numChildren;
+} imgui_flat_node_t;
+
+typedef struct imgui_node_tree_s
+{
+    const void *root;
+    unsigned long long key;
+    ImVector<imgui_flat_node_t> nodes;
+    ImVector<char> labels;
+    ImVector<unsigned char> open;
+    ImVector<int> visible;
+    ImVector<int> matches;
+    ImGuiTextFilter filter;
+    int visibleDirty;
+    int matchesDirty;
+    int selected;
+    int scrollTo; // node to bring into view on the next draw, or -1
+} imgui_node_tree_t;
+
+static thread_local ImVector<imgui_node_tree_t *> nodeTrees;
+
+#define NODE_TREE_LINES 20
+#define NODE_TREE_MAX_DEPTH 1024
+
+static unsigned long long NodeTreeKey(const void *root, const void *children, unsigned int numChildren)
+{
+    return ((unsigned long long)(uintptr_t)root * 31ULL + (unsigned long long)(uintptr_t)children) * 31ULL + numChildren;
+}
+
+static imgui_node_tree_t *GetNodeTree(const void *root, unsigned long long key)
 {
-    // ImGui::Text("NumInstances: %d", mesh->mNumInstances);
-    for (unsigned int index = 0; index < mesh->mNumInstances; index++)
+    imgui_node_tree_t *tree = NULL;
+    for (int i = 0; i < nodeTrees.Size; i++)
     {
-        if (ImGui::TreeNode((void *)(intptr_t)index, "Instance %d", index))
+        if (nodeTrees[i]->root == root)
         {
-            ShowMat4("Transform:", mesh->mTransformation[index]);
-            ImGui::TreePop();
+            tree = nodeTrees[i];
+            break;
+        }
+    }
+    if (tree == NULL)
+    {
+        tree = IM_NEW(imgui_node_tree_t)();
+        tree->root = root;
+        tree->key = key + 1;
+        tree->scrollTo = -1;
+        nodeTrees.push_back(tree);
+    }
+    if (tree->key != key)
+    {
+        tree->key = key;
+        tree->nodes.resize(0);
+        tree->labels.resize(0);
+        tree->open.resize(0);
+        tree->matches.resize(0);
+        tree->visibleDirty = 1;
+        tree->matchesDirty = 1;
+        tree->selected = -1;
+        tree->scrollTo = -1;
+    }
+    return tree;
+}
+
+static unsigned int NodeTreeAddLabel(imgui_node_tree_t *tree, const char *label)
+{
+    unsigned int offset = (unsigned int)tree->labels.Size;
+    size_t len = strlen(label);
+    tree->labels.resize(tree->labels.Size + (int)len + 1);
+    memcpy(tree->labels.Data + offset, label, len + 1);
+    return offset;
+}
+
+// Fills in the subtree ends and open flags once all nodes are appended in preorder.
+static void NodeTreeFinish(imgui_node_tree_t *tree)
+{
+    for (int i = 0; i < tree->nodes.Size; i++)
+        tree->nodes[i].end = i + 1;
+    for (int i = tree->nodes.Size - 1; i > 0; i--)
+    {
+        imgui_flat_node_t *parent = &(tree->nodes[tree->nodes[i].parent]);
+        parent->end = tree->nodes[i].end > parent->end ? tree->nodes[i].end : parent->end;
+    }
+    tree->open.resize(tree->nodes.Size);
+    if (tree->open.Size > 0)
+        memset(tree->open.Data, 0, (size_t)tree->open.Size);
+    tree->visibleDirty = 1;
+}
+
+typedef struct imgui_node_visit_s
+{
+    const void *node;
+    int parent;
+    int depth;
+    int childIndex;
+} imgui_node_visit_t;
+
+static void BuildModelNodeTree(imgui_node_tree_t *tree, const model_node_t *root)
+{
+    char strbuffer[MAXLEN];
+    ImVector<imgui_node_visit_t> stack;
+    imgui_node_visit_t first = {root, -1, 0, 0};
+    stack.push_back(first);
+    while (stack.Size > 0)
+    {
+        imgui_node_visit_t visit = stack.back();
+        stack.pop_back();
+        const model_node_t *node = (const model_node_t *)visit.node;
+        imgui_flat_node_t flat;
+        flat.node = node;
+        flat.parent = visit.parent;
+        flat.depth = visit.depth;
+        flat.childIndex = visit.childIndex;
+        flat.numChildren = node->mNumChildren;
+        snprintf(strbuffer, MAXLEN, visit.parent < 0 ? "Node" : "Node %d", visit.childIndex);
+        flat.label = NodeTreeAddLabel(tree, strbuffer);
+        int index = tree->nodes.Size;
+        tree->nodes.push_back(flat);
+        for (unsigned int i = node->mNumChildren; i > 0; i--)
+        {
+            imgui_node_visit_t child = {&(node->mChildren[i - 1]), index, visit.depth + 1, (int)i - 1};
+            stack.push_back(child);
         }
     }
+    NodeTreeFinish(tree);
 }
 
-void ShowShader(const shader_t *shader)
+static void BuildAiNodeTree(imgui_node_tree_t *tree, const aiNode *root)
+{
+    ImVector<imgui_node_visit_t> stack;
+    imgui_node_visit_t first = {root, -1, 0, 0};
+    stack.push_back(first);
+    while (stack.Size > 0)
+    {
+        imgui_node_visit_t visit = stack.back();
+        stack.pop_back();
+        const aiNode *node = (const aiNode *)visit.node;
+        imgui_flat_node_t flat;
+        flat.node = node;
+        flat.parent = visit.parent;
+        flat.depth = visit.depth;
+        flat.childIndex = visit.childIndex;
+        flat.numChildren = node->mNumChildren;
+        flat.label = NodeTreeAddLabel(tree, node->mName.data);
+        int index = tree->nodes.Size;
+        tree->nodes.push_back(flat);
+        for (unsigned int i = node->mNumChildren; i > 0; i--)
+        {
+            if (node->mChildren[i - 1] == NULL)
+                continue;
+            imgui_node_visit_t child = {node->mChildren[i - 1], index, visit.depth + 1, (int)i - 1};
+            stack.push_back(child);
+        }
+    }
+    NodeTreeFinish(tree);
+}
+
+// Writes the '/' separated label path of a node into buffer.
+static void NodeTreePath(const imgui_node_tree_t *tree, int index, char *buffer, size_t size)
+{
+    int chain[NODE_TREE_MAX_DEPTH];
+    int depth = 0;
+    for (int i = index; i >= 0 && depth < NODE_TREE_MAX_DEPTH; i = tree->nodes[i].parent)
+        chain[depth++] = i;
+
+    size_t len = 0;
+    buffer[0] = '\0';
+    for (int d = depth - 1; d >= 0 && len < size; d--)
+        len += snprintf(buffer + len, size - len, d == depth - 1 ? "%s" : "/%s", tree->labels.Data + tree->nodes[chain[d]].label);
+}
+
+static void NodeTreeUpdateVisible(imgui_node_tree_t *tree)
+{
+    tree->visible.resize(0);
+    int i = 0;
+    while (i < tree->nodes.Size)
+    {
+        tree->visible.push_back(i);
+        i = tree->open[i] ? i + 1 : tree->nodes[i].end;
+    }
+    tree->visibleDirty = 0;
+}
+
+static void NodeTreeUpdateMatches(imgui_node_tree_t *tree)
+{
+    char path[1024];
+    tree->matches.resize(0);
+    for (int i = 0; i < tree->nodes.Size; i++)
+    {
+        NodeTreePath(tree, i, path, sizeof(path));
+        if (tree->filter.PassFilter(path))
+            tree->matches.push_back(i);
+    }
+}
+
+// Opens the ancestors of a node, selects it and scrolls it into view. Returns
+// false when node is not part of the tree.
+static bool NodeTreeReveal(imgui_node_tree_t *tree, const void *node)
+{
+    int index = -1;
+    for (int i = 0; i < tree->nodes.Size && index < 0; i++)
+        index = tree->nodes[i].node == node ? i : -1;
+    if (index < 0)
+        return false;
+    for (int i = tree->nodes[index].parent; i >= 0; i = tree->nodes[i].parent)
+        tree->open[i] = 1;
+    tree->filter.Clear();
+    tree->visibleDirty = 1;
+    tree->selected = index;
+    tree->scrollTo = index;
+    return true;
+}
+
+// Draws the cached hierarchy and returns the index of the selected node, or -1.
+static int ShowNodeTree(imgui_node_tree_t *tree)
+{
+    if (tree->filter.Draw("Filter (name/path)"))
+        tree->matchesDirty = 1;
+    bool filtering = tree->filter.IsActive();
+    if (filtering && tree->matchesDirty)
+    {
+        NodeTreeUpdateMatches(tree);
+        tree->matchesDirty = 0;
+    }
+    if (!filtering && tree->visibleDirty)
+        NodeTreeUpdateVisible(tree);
+    ImVector<int> *rows = filtering ? &(tree->matches) : &(tree->visible);
+
+    ImGui::PushID(tree);
+    ImGui::BeginChild("Node Tree", ImVec2(0, ImGui::GetTextLineHeightWithSpacing() * NODE_TREE_LINES), ImGuiChildFlags_Border | ImGuiChildFlags_ResizeY);
+    char path[1024];
+    const float indent = ImGui::GetStyle().IndentSpacing;
+    ImGuiListClipper clipper;
+    clipper.Begin(rows->Size);
+    if (tree->scrollTo >= 0)
+    {
+        int row = rows->find_index(tree->scrollTo);
+        if (row >= 0)
+            clipper.IncludeItemByIndex(row);
+        else
+            tree->scrollTo = -1;
+    }
+    while (clipper.Step())
+    {
+        for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; row++)
+        {
+            int index = (*rows)[row];
+            const imgui_flat_node_t *flat = &(tree->nodes[index]);
+            ImGuiTreeNodeFlags flags = ImGuiTreeNodeFlags_NoTreePushOnOpen | ImGuiTreeNodeFlags_OpenOnArrow | ImGuiTreeNodeFlags_SpanAvailWidth;
+            if (flat->numChildren == 0 || filtering)
+                flags |= ImGuiTreeNodeFlags_Leaf;
+            if (index == tree->selected)
+                flags |= ImGuiTreeNodeFlags_Selected;
+
+            const char *label = tree->labels.Data + flat->label;
+            if (filtering)
+            {
+                NodeTreePath(tree, index, path, sizeof(path));
+                label = path;
+            }
+            else if (flat->depth > 0)
+            {
+                ImGui::Indent(flat->depth * indent);
+            }
+
+            if (!filtering)
+                ImGui::SetNextItemOpen(tree->open[index] != 0 || (currentGui != NULL && currentGui->open_trees));
+            bool open = ImGui::TreeNodeEx((void *)(intptr_t)index, flags, "%s", label);
+            if (ImGui::IsItemClicked() && !ImGui::IsItemToggledOpen())
+                tree->selected = index;
+            if (index == tree->scrollTo)
+            {
+                ImGui::SetScrollHereY(0.5f);
+                tree->scrollTo = -1;
+            }
+            if (!filtering && open != (tree->open[index] != 0))
+            {
+                tree->open[index] = open;
+                tree->visibleDirty = 1;
+            }
+
+            if (!filtering && flat->depth > 0)
+                ImGui::Unindent(flat->depth * indent);
+        }
+    }
+    ImGui::EndChild();
+    ImGui::PopID();
+    return tree->selected;
+}
+
+void imgui_node_tree_cleanup()
 {
+    for (int i = 0; i < nodeTrees.Size; i++)
+        IM_DELETE(nodeTrees[i]);
+    nodeTrees.clear();
 }
 
-void ShowNode(model_node_t *node, const char *parentstr)
+void ShowNode(model_node_t *node)
 {
-    char strbuffer[1024];
     ShowMat4("Transform:", node->mTransformation);
 
     ImGui::Text("mNumMeshes: %d", node->mNumMeshes);
     for (unsigned int index = 0; index < node->mNumMeshes; index++)
     {
+        imgui_open_next_tree();
         if (ImGui::TreeNode((void *)(intptr_t)index, "Mesh %d", index))
         {
             ImGui::Text("mMeshInstance: %d", node->mMeshData[index].mMeshInstance);
@@ -243,26 +953,41 @@ void ShowNode(model_node_t *node, const char *parentstr)
             ImGui::TreePop();
         }
     }
+    ImGui::Text("mNumChildren: %d", node->mNumChildren);
+}
+
+void ShowNodeHierarchy(model_node_t *root)
+{
+    imgui_node_tree_t *tree = GetNodeTree(root, NodeTreeKey(root, root->mChildren, root->mNumChildren));
+    if (tree->nodes.Size == 0)
+        BuildModelNodeTree(tree, root);
 
-    // ImGui::Text("mNumChildren: %d", node->mNumChildren);
-    for (unsigned int index = 0; index < node->mNumChildren; index++)
+    int selected = ShowNodeTree(tree);
+    if (selected >= 0)
     {
-        snprintf(strbuffer, 1024, "%s %d", parentstr, index);
-        if (ImGui::TreeNode((void *)(intptr_t)index, strbuffer))
-        {
-            ShowNode(&(node->mChildren[index]), strbuffer);
-            ImGui::TreePop();
-        }
+        char path[1024];
+        NodeTreePath(tree, selected, path, sizeof(path));
+        ImGui::SeparatorText(path);
+        ShowNode((model_node_t *)tree->nodes[selected].node);
     }
 }
 
 void ShowModel(model_t *model)
 {
+    imgui_open_next_tree();
+    if (ImGui::TreeNode("Statistics"))
+    {
+        ShowModelStats(model);
+        ImGui::TreePop();
+    }
 
+    bool navigating = SearchNavKind(model, IMGUI_SEARCH_MODEL_TEXTURE);
+    SearchNavOpen(navigating);
     if (model->mNumMaterials > 0 && ImGui::TreeNode("Materials"))
     { // ImGui::Text("mNumMaterials: %d", model->mNumMaterials);
         for (unsigned int materialIndex = 0; materialIndex < model->mNumMaterials; materialIndex++)
         {
+            SearchNavOpen(navigating && searchNav.target.a == materialIndex);
             if (ImGui::TreeNode((void *)(intptr_t)materialIndex, "Material %d", materialIndex))
             {
                 ShowMaterial(&(model->mMaterialList[materialIndex]));
@@ -272,10 +997,12 @@ void ShowModel(model_t *model)
         ImGui::TreePop();
     }
 
+    imgui_open_next_tree();
     if (model->mNumMeshes > 0 && ImGui::TreeNode("Meshes"))
     { // ImGui::Text("mNumMeshes: %d", model->mNumMeshes);
         for (unsigned int meshIndex = 0; meshIndex < model->mNumMeshes; meshIndex++)
         {
+            imgui_open_next_tree();
             if (ImGui::TreeNode((void *)(intptr_t)meshIndex, "Mesh %d", meshIndex))
             {
                 ShowMesh(&(model->mMeshList[meshIndex]));
@@ -287,9 +1014,10 @@ void ShowModel(model_t *model)
 
     // ShowShader(model->mShader);
 
+    imgui_open_next_tree();
     if (ImGui::TreeNode("RootNode"))
     {
-        ShowNode(&(model->mRootNode), "Node");
+        ShowNodeHierarchy(&(model->mRootNode));
         ImGui::TreePop();
     }
 }
@@ -303,11 +1031,25 @@ void ShowModelToolWindow(bool *p_open, unsigned int num_models, model_t *model)
     }
     ImGui::Text("Model Tool Window");
     ImGui::Separator();
+    imgui_open_next_tree();
+    if (ImGui::TreeNode("Scene Statistics"))
+    {
+        ShowSceneStats(num_models, model);
+        ImGui::TreePop();
+    }
+    imgui_open_next_tree();
+    if (ImGui::TreeNode("Thumbnail Cache"))
+    {
+        ShowThumbnailStats();
+        ImGui::TreePop();
+    }
+    SearchNavOpen(searchNav.frames > 0 && searchNav.target.kind == IMGUI_SEARCH_MODEL_TEXTURE);
     if (ImGui::TreeNode("Models"))
     {
         // ImGui::Text("num_models: %d", num_models);
         for (unsigned int index = 0; index < num_models; index++)
         {
+            SearchNavOpen(SearchNavOwner(&(model[index])));
             if (ImGui::TreeNode((void *)(intptr_t)index, "Model %d", index))
             {
                 ShowModel(&(model[index]));
@@ -322,6 +1064,7 @@ void ShowModelToolWindow(bool *p_open, unsigned int num_models, model_t *model)
 
 void showAiMetadata(const char *name, aiMetadata *Meta)
 {
+    imgui_open_next_tree();
     if (Meta != NULL && ImGui::TreeNode(name))
     {
         for (unsigned int i = 0; i < Meta->mNumProperties; i++)
@@ -358,9 +1101,7 @@ void showAiMetadata(const char *name, aiMetadata *Meta)
             }
             case AI_AIMETADATA:
             {
-                char newName[MAXLEN];
-                snprintf(newName, MAXLEN, "%s:%d", name, i);
-                showAiMetadata(newName, static_cast<aiMetadata *>(e));
+                showAiMetadata(imgui_frame_printf("%s:%d", name, i), static_cast<aiMetadata *>(e));
                 break;
             }
             case AI_INT64:
@@ -379,284 +1120,1969 @@ void showAiMetadata(const char *name, aiMetadata *Meta)
 
 void ShowAiNode(aiNode *node)
 {
-    if (node != NULL && ImGui::TreeNode(node->mName.data))
-    {
-        ShowAiMat4("Transform:", node->mTransformation);
-        ImGui::Text("Parent : %s", node->mParent == NULL ? "None" : node->mParent->mName.data);
-        ImGui::Text("NumMeshes : %d", node->mNumMeshes);
-
-        if (ImGui::TreeNode((void *)(intptr_t)node->mNumMeshes, "NumMeshes %d", node->mNumMeshes))
-        {
-            for (unsigned int i = 0; i < node->mNumMeshes; i++)
-            {
-                ImGui::Text("Mesh[%u] : %u", i, node->mMeshes[i]);
-            }
-            ImGui::TreePop();
-        }
-        showAiMetadata("Metadata", node->mMetaData);
+    ShowAiMat4("Transform:", node->mTransformation);
+    ImGui::Text("Parent : %s", node->mParent == NULL ? "None" : node->mParent->mName.data);
+    ImGui::Text("NumMeshes : %d", node->mNumMeshes);
 
-        if (ImGui::TreeNode((void *)(intptr_t)node->mNumChildren, "NumChildren %d", node->mNumChildren))
+    imgui_open_next_tree();
+    if (ImGui::TreeNode((void *)(intptr_t)node->mNumMeshes, "NumMeshes %d", node->mNumMeshes))
+    {
+        for (unsigned int i = 0; i < node->mNumMeshes; i++)
         {
-            for (unsigned int i = 0; i < node->mNumChildren; i++)
-            {
-                ShowAiNode(node->mChildren[i]);
-            }
-            ImGui::TreePop();
+            ImGui::Text("Mesh[%u] : %u", i, node->mMeshes[i]);
         }
         ImGui::TreePop();
     }
+    SearchNavOpen(searchNav.frames > 0 && searchNav.target.kind == IMGUI_SEARCH_AI_METADATA && searchNav.target.ptr == node);
+    showAiMetadata("Metadata", node->mMetaData);
+    ImGui::Text("NumChildren : %d", node->mNumChildren);
 }
 
-void ShowAiMesh(aiMesh *mesh)
+void ShowAiNodeHierarchy(aiNode *root)
 {
-    bool points = aiPrimitiveType_POINT & mesh->mPrimitiveTypes;
-    bool lines = aiPrimitiveType_LINE & mesh->mPrimitiveTypes;
-    bool tris = aiPrimitiveType_TRIANGLE & mesh->mPrimitiveTypes;
-    bool polys = aiPrimitiveType_POLYGON & mesh->mPrimitiveTypes;
-    bool ngons = aiPrimitiveType_NGONEncodingFlag & mesh->mPrimitiveTypes;
-    ImGui::BeginDisabled();
-    ImGui::Checkbox("points", &points);
-    ImGui::Checkbox("lines", &lines);
-    ImGui::Checkbox("tris", &tris);
-    ImGui::Checkbox("polys", &polys);
-    ImGui::Checkbox("ngons", &ngons);
-    ImGui::EndDisabled();
-    ImGui::Separator();
-    ImGui::Text("Name: %s", mesh->mName.data);
-    ImGui::Separator();
-    ImGui::Text("NumFaces: %u", mesh->mNumFaces);
-    if (mesh->mFaces != NULL && ImGui::TreeNode("Mesh Faces"))
+    if (root == NULL)
+        return;
+    imgui_node_tree_t *tree = GetNodeTree(root, NodeTreeKey(root, root->mChildren, root->mNumChildren));
+    if (tree->nodes.Size == 0)
+        BuildAiNodeTree(tree, root);
+
+    int kind = searchNav.target.kind;
+    if (searchNav.frames > 0 && !searchNav.revealed && (kind == IMGUI_SEARCH_AI_NODE || kind == IMGUI_SEARCH_AI_METADATA) &&
+        searchNav.target.ptr != NULL && ((const aiScene *)searchNav.target.owner)->mRootNode == root)
+        searchNav.revealed = NodeTreeReveal(tree, searchNav.target.ptr);
+
+    int selected = ShowNodeTree(tree);
+    if (selected >= 0)
     {
-        for (unsigned int i = 0; i < mesh->mNumFaces; i++)
-        {
-            if (mesh->mFaces[i].mIndices != NULL && ImGui::TreeNode((void *)(intptr_t)i, "Face[%d]", i))
-            {
-                for (unsigned int j = 0; j < mesh->mFaces[i].mNumIndices; j++)
-                {
-                    if (j > 0)
-                    {
-                        ImGui::SameLine();
-                        ImGui::Text(", ");
-                        ImGui::SameLine();
-                    }
-                    ImGui::Text("%d", mesh->mFaces[i].mIndices[j]);
-                }
-                ImGui::TreePop();
-            }
-        }
-        ImGui::TreePop();
+        char path[1024];
+        NodeTreePath(tree, selected, path, sizeof(path));
+        ImGui::SeparatorText(path);
+        ShowAiNode((aiNode *)tree->nodes[selected].node);
     }
-    ImGui::Text("Num Vertecies: %u", mesh->mNumVertices);
-    if (mesh->mVertices != NULL && ImGui::TreeNode("Mesh Verticies"))
+}
+
+// Height of the scrolling region used by the clipped per-element tables, in text lines.
+#define MESH_TABLE_LINES 20
+
+void ShowAiMeshFaces(aiMesh *mesh)
+{
+    const ImGuiTableFlags tableFlags = ImGuiTableFlags_ScrollY | ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersOuter | ImGuiTableFlags_BordersV | ImGuiTableFlags_Resizable;
+    ImVec2 outerSize = ImVec2(0.0f, ImGui::GetTextLineHeightWithSpacing() * MESH_TABLE_LINES);
+    if (!ImGui::BeginTable("Mesh Faces Table", 3, tableFlags, outerSize))
+        return;
+
+    ImGui::TableSetupScrollFreeze(0, 1);
+    ImGui::TableSetupColumn("Face", ImGuiTableColumnFlags_WidthFixed);
+    ImGui::TableSetupColumn("NumIndices", ImGuiTableColumnFlags_WidthFixed);
+    ImGui::TableSetupColumn("Indices", ImGuiTableColumnFlags_WidthStretch);
+    ImGui::TableHeadersRow();
+
+    // Only the rows inside the visible scroll region are formatted and submitted.
+    char strbuffer[MAXLEN];
+    ImGuiListClipper clipper;
+    clipper.Begin((int)mesh->mNumFaces);
+    while (clipper.Step())
     {
-        for (unsigned int i = 0; i < mesh->mNumVertices; i++)
+        for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; row++)
         {
-
-            ImGui::Text("Vertex : [%u]", i);
-            if (mesh->mVertices != NULL)
+            const aiFace *face = &(mesh->mFaces[row]);
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("%d", row);
+            ImGui::TableNextColumn();
+            ImGui::Text("%u", face->mNumIndices);
+            ImGui::TableNextColumn();
+            if (face->mIndices == NULL)
             {
-                aiVector3D v = mesh->mVertices[i];
-                ImGui::SameLine();
-                ImGui::Text("\tPos: [%f, %f, %f]", v.x, v.y, v.z);
+                ImGui::TextUnformatted("-");
+                continue;
             }
-            if (mesh->mNormals != NULL)
+            int len = 0;
+            strbuffer[0] = '\0';
+            for (unsigned int j = 0; j < face->mNumIndices && len < MAXLEN; j++)
             {
-                aiVector3D v = mesh->mNormals[i];
-                ImGui::SameLine();
-                ImGui::Text("\tnorm: [%f, %f, %f]", v.x, v.y, v.z);
+                len += snprintf(strbuffer + len, MAXLEN - len, j > 0 ? ", %u" : "%u", face->mIndices[j]);
+            }
+            ImGui::TextUnformatted(strbuffer);
+        }
+    }
+    ImGui::EndTable();
+}
+
+void ShowAiMeshVertices(aiMesh *mesh)
+{
+    unsigned int colorSets[AI_MAX_NUMBER_OF_COLOR_SETS];
+    unsigned int uvSets[AI_MAX_NUMBER_OF_TEXTURECOORDS];
+    unsigned int numColorSets = 0;
+    unsigned int numUVSets = 0;
+    for (unsigned int t = 0; t < AI_MAX_NUMBER_OF_COLOR_SETS; t++)
+        if (mesh->mColors[t] != NULL)
+            colorSets[numColorSets++] = t;
+    for (unsigned int t = 0; t < AI_MAX_NUMBER_OF_TEXTURECOORDS; t++)
+        if (mesh->mTextureCoords[t] != NULL)
+            uvSets[numUVSets++] = t;
+
+    int numColumns = 2;
+    numColumns += mesh->mNormals != NULL;
+    numColumns += mesh->mTangents != NULL;
+    numColumns += mesh->mBitangents != NULL;
+    numColumns += numColorSets + numUVSets;
+
+    const ImGuiTableFlags tableFlags = ImGuiTableFlags_ScrollY | ImGuiTableFlags_ScrollX | ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersOuter | ImGuiTableFlags_BordersV | ImGuiTableFlags_Resizable;
+    ImVec2 outerSize = ImVec2(0.0f, ImGui::GetTextLineHeightWithSpacing() * MESH_TABLE_LINES);
+    if (!ImGui::BeginTable("Mesh Verticies Table", numColumns, tableFlags, outerSize))
+        return;
+
+    ImGui::TableSetupScrollFreeze(1, 1);
+    ImGui::TableSetupColumn("Vertex", ImGuiTableColumnFlags_WidthFixed);
+    ImGui::TableSetupColumn("Pos", ImGuiTableColumnFlags_WidthFixed);
+    if (mesh->mNormals != NULL)
+        ImGui::TableSetupColumn("Norm", ImGuiTableColumnFlags_WidthFixed);
+    if (mesh->mTangents != NULL)
+        ImGui::TableSetupColumn("Tan", ImGuiTableColumnFlags_WidthFixed);
+    if (mesh->mBitangents != NULL)
+        ImGui::TableSetupColumn("BitTan", ImGuiTableColumnFlags_WidthFixed);
+    for (unsigned int c = 0; c < numColorSets; c++)
+    {
+        ImGui::TableSetupColumn(imgui_frame_printf("Color[%u]", colorSets[c]), ImGuiTableColumnFlags_WidthFixed);
+    }
+    for (unsigned int c = 0; c < numUVSets; c++)
+    {
+        ImGui::TableSetupColumn(imgui_frame_printf("UV[%u]", uvSets[c]), ImGuiTableColumnFlags_WidthFixed);
+    }
+    ImGui::TableHeadersRow();
+
+    // Only the rows inside the visible scroll region are formatted and submitted.
+    ImGuiListClipper clipper;
+    clipper.Begin((int)mesh->mNumVertices);
+    while (clipper.Step())
+    {
+        for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; row++)
+        {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("%d", row);
+            ImGui::TableNextColumn();
+            aiVector3D v = mesh->mVertices[row];
+            ImGui::Text("[%f, %f, %f]", v.x, v.y, v.z);
+            if (mesh->mNormals != NULL)
+            {
+                v = mesh->mNormals[row];
+                ImGui::TableNextColumn();
+                ImGui::Text("[%f, %f, %f]", v.x, v.y, v.z);
             }
             if (mesh->mTangents != NULL)
             {
-                aiVector3D v = mesh->mTangents[i];
-                ImGui::SameLine();
-                ImGui::Text("\tTan: [%f, %f, %f]", v.x, v.y, v.z);
+                v = mesh->mTangents[row];
+                ImGui::TableNextColumn();
+                ImGui::Text("[%f, %f, %f]", v.x, v.y, v.z);
             }
             if (mesh->mBitangents != NULL)
             {
-                aiVector3D v = mesh->mBitangents[i];
-                ImGui::SameLine();
-                ImGui::Text("\tBitTan: [%f, %f, %f]", v.x, v.y, v.z);
+                v = mesh->mBitangents[row];
+                ImGui::TableNextColumn();
+                ImGui::Text("[%f, %f, %f]", v.x, v.y, v.z);
             }
-            for (unsigned int t = 0; t < AI_MAX_NUMBER_OF_COLOR_SETS; t++)
+            for (unsigned int c = 0; c < numColorSets; c++)
             {
-                if (mesh->mColors[t] != NULL)
-                {
-                    aiColor4D v = mesh->mColors[t][i];
-                    ImGui::Text("\tColor[%u]: [%f, %f, %f, %f]", t, v.r, v.g, v.b, v.a);
-                }
+                aiColor4D color = mesh->mColors[colorSets[c]][row];
+                ImGui::TableNextColumn();
+                ImGui::Text("[%f, %f, %f, %f]", color.r, color.g, color.b, color.a);
             }
-            for (unsigned int t = 0; t < AI_MAX_NUMBER_OF_TEXTURECOORDS; t++)
+            for (unsigned int c = 0; c < numUVSets; c++)
             {
-                if (mesh->mTextureCoords[t] != NULL)
-                {
-                    aiVector3D v = mesh->mTextureCoords[t][i];
-                    ImGui::Text("\tUV[%u]: [%f, %f, %f]", t, v.x, v.y, v.z);
-                }
+                v = mesh->mTextureCoords[uvSets[c]][row];
+                ImGui::TableNextColumn();
+                ImGui::Text("[%f, %f, %f]", v.x, v.y, v.z);
+            }
+        }
+    }
+    ImGui::EndTable();
+}
+
+static float BoneHistogramValue(void *data, int idx)
+{
+    return (float)((const unsigned int *)data)[idx];
+}
+
+// Clipped table of vertex indices taken from a range of analysis->order.
+static void ShowBoneVertexTable(const char *id, const imgui_bone_analysis_t *analysis, unsigned int first, unsigned int count)
+{
+    const ImGuiTableFlags tableFlags = ImGuiTableFlags_ScrollY | ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersOuter | ImGuiTableFlags_BordersV;
+    ImVec2 outerSize = ImVec2(0.0f, ImGui::GetTextLineHeightWithSpacing() * (count < MESH_TABLE_LINES ? count + 1 : MESH_TABLE_LINES));
+    if (!ImGui::BeginTable(id, 2, tableFlags, outerSize))
+        return;
+    ImGui::TableSetupScrollFreeze(0, 1);
+    ImGui::TableSetupColumn("Vertex", ImGuiTableColumnFlags_WidthStretch);
+    ImGui::TableSetupColumn("Influences", ImGuiTableColumnFlags_WidthStretch);
+    ImGui::TableHeadersRow();
+    ImGuiListClipper clipper;
+    clipper.Begin((int)count);
+    while (clipper.Step())
+    {
+        for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; row++)
+        {
+            unsigned int vertex = analysis->order[first + row];
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("%u", vertex);
+            ImGui::TableNextColumn();
+            ImGui::Text("%u", (unsigned int)analysis->influences[vertex]);
+        }
+    }
+    ImGui::EndTable();
+}
+
+static void ShowAiBoneWeights(const aiBone *bone)
+{
+    const ImGuiTableFlags tableFlags = ImGuiTableFlags_ScrollY | ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersOuter | ImGuiTableFlags_BordersV;
+    ImVec2 outerSize = ImVec2(0.0f, ImGui::GetTextLineHeightWithSpacing() * MESH_TABLE_LINES);
+    if (bone->mWeights == NULL || !ImGui::BeginTable("Bone Weights Table", 2, tableFlags, outerSize))
+        return;
+    ImGui::TableSetupScrollFreeze(0, 1);
+    ImGui::TableSetupColumn("Vertex", ImGuiTableColumnFlags_WidthStretch);
+    ImGui::TableSetupColumn("Weight", ImGuiTableColumnFlags_WidthStretch);
+    ImGui::TableHeadersRow();
+    ImGuiListClipper clipper;
+    clipper.Begin((int)bone->mNumWeights);
+    while (clipper.Step())
+    {
+        for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; row++)
+        {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("%u", bone->mWeights[row].mVertexId);
+            ImGui::TableNextColumn();
+            ImGui::Text("%f", bone->mWeights[row].mWeight);
+        }
+    }
+    ImGui::EndTable();
+}
+
+// Skinning summary computed on the task queue, a per-bone table and the raw
+// weights of the selected bone. Nothing here walks the weights on the UI thread.
+static void ShowAiMeshBones(const aiMesh *mesh, task_queue_t *tq)
+{
+    const imgui_bone_analysis_t *analysis = imgui_bone_analysis_get(mesh, tq);
+    if (analysis == NULL)
+    {
+        ImGui::TextDisabled("Bone analysis unavailable");
+        return;
+    }
+    int state = __atomic_load_n(&(analysis->state), __ATOMIC_ACQUIRE);
+    if (state == IMGUI_BONE_ANALYSIS_CANCELLED)
+    {
+        ImGui::TextDisabled("Bone analysis cancelled");
+        ImGui::SameLine();
+        if (ImGui::SmallButton("Retry"))
+            imgui_bone_analysis_forget(mesh);
+        return;
+    }
+    if (state != IMGUI_BONE_ANALYSIS_DONE)
+    {
+        unsigned long long processed = __atomic_load_n(&(analysis->processed), __ATOMIC_RELAXED);
+        float fraction = analysis->numWeights > 0 ? (float)((double)processed / (double)analysis->numWeights) : 1.0f;
+        ImGui::ProgressBar(fraction, ImVec2(-FLT_MIN, 0), imgui_frame_printf("Analysing %llu / %llu weights", processed, analysis->numWeights));
+        return;
+    }
+
+    ImGui::Text("Weights: %llu  Vertices: %u  Max influences: %u", analysis->numWeights, analysis->numVertices, analysis->maxInfluences);
+    ImGui::Text("Unnormalized: %u  Out of range: %u", analysis->unnormalized, analysis->outOfRange);
+
+    int *limit = ImGui::GetStateStorage()->GetIntRef(ImGui::GetID("InfluenceLimit"), 4);
+    ImGui::SliderInt("Influence limit", limit, 1, IMGUI_BONE_MAX_INFLUENCES - 1);
+    unsigned int numOver = 0;
+    for (int k = *limit + 1; k <= IMGUI_BONE_MAX_INFLUENCES; k++)
+        numOver += analysis->influenceCount[k];
+    unsigned int numUnweighted = analysis->influenceCount[0];
+    ImGui::PlotHistogram("Influences", BoneHistogramValue, (void *)analysis->influenceCount, IMGUI_BONE_MAX_INFLUENCES + 1, 0, NULL, 0.0f, FLT_MAX, ImVec2(0, 60));
+
+    imgui_open_next_tree();
+    if (ImGui::TreeNode("Over Limit", "Vertices over limit (%u)", numOver))
+    {
+        ShowBoneVertexTable("Over Limit Table", analysis, 0, numOver);
+        ImGui::TreePop();
+    }
+    imgui_open_next_tree();
+    if (ImGui::TreeNode("Unweighted", "Unweighted vertices (%u)", numUnweighted))
+    {
+        ShowBoneVertexTable("Unweighted Table", analysis, analysis->numVertices - numUnweighted, numUnweighted);
+        ImGui::TreePop();
+    }
+
+    int *selected = ImGui::GetStateStorage()->GetIntRef(ImGui::GetID("SelectedBone"), -1);
+    if (*selected >= (int)analysis->numBones)
+        *selected = -1;
+    const ImGuiTableFlags tableFlags = ImGuiTableFlags_ScrollY | ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersOuter | ImGuiTableFlags_BordersV | ImGuiTableFlags_Resizable;
+    ImVec2 outerSize = ImVec2(0.0f, ImGui::GetTextLineHeightWithSpacing() * MESH_TABLE_LINES);
+    if (ImGui::BeginTable("Mesh Bones Table", 7, tableFlags, outerSize))
+    {
+        ImGui::TableSetupScrollFreeze(0, 1);
+        ImGui::TableSetupColumn("Bone", ImGuiTableColumnFlags_WidthFixed);
+        ImGui::TableSetupColumn("Name", ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableSetupColumn("Weights", ImGuiTableColumnFlags_WidthFixed);
+        ImGui::TableSetupColumn("Zero", ImGuiTableColumnFlags_WidthFixed);
+        ImGui::TableSetupColumn("Min / Max", ImGuiTableColumnFlags_WidthFixed);
+        ImGui::TableSetupColumn("Avg", ImGuiTableColumnFlags_WidthFixed);
+        ImGui::TableSetupColumn("Histogram", ImGuiTableColumnFlags_WidthFixed, 120.0f);
+        ImGui::TableHeadersRow();
+        ImGuiListClipper clipper;
+        clipper.Begin((int)analysis->numBones);
+        while (clipper.Step())
+        {
+            for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; row++)
+            {
+                const imgui_bone_stats_t *stats = &(analysis->bones[row]);
+                const aiBone *bone = mesh->mBones[row];
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::PushID(row);
+                if (ImGui::Selectable(imgui_frame_printf("%d", row), *selected == row, ImGuiSelectableFlags_SpanAllColumns))
+                    *selected = *selected == row ? -1 : row;
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(bone != NULL ? bone->mName.data : "(null)");
+                ImGui::TableNextColumn();
+                ImGui::Text("%u", stats->numWeights);
+                ImGui::TableNextColumn();
+                ImGui::Text("%u", stats->zeroWeights);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f / %.3f", stats->minWeight, stats->maxWeight);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", stats->avgWeight);
+                ImGui::TableNextColumn();
+                ImGui::PlotHistogram("##histogram", BoneHistogramValue, (void *)stats->histogram, IMGUI_BONE_WEIGHT_BUCKETS, 0, NULL, 0.0f, FLT_MAX, ImVec2(-FLT_MIN, ImGui::GetTextLineHeight()));
+                ImGui::PopID();
             }
         }
+        ImGui::EndTable();
+    }
+
+    if (*selected < 0 || mesh->mBones[*selected] == NULL)
+        return;
+    const aiBone *bone = mesh->mBones[*selected];
+    ImGui::SeparatorText(imgui_frame_printf("Bone[%d] %s", *selected, bone->mName.data));
+    imgui_open_next_tree();
+    if (bone->mArmature != NULL && ImGui::TreeNode("Armature"))
+    {
+        ShowAiNodeHierarchy(bone->mArmature);
+        ImGui::TreePop();
+    }
+    imgui_open_next_tree();
+    if (bone->mNode != NULL && ImGui::TreeNode("Node"))
+    {
+        ShowAiNodeHierarchy(bone->mNode);
+        ImGui::TreePop();
+    }
+    ShowAiMat4("OffsetMatrix", bone->mOffsetMatrix);
+    ShowAiBoneWeights(bone);
+}
+
+void ShowAiMesh(aiMesh *mesh, task_queue_t *tq)
+{
+    bool points = aiPrimitiveType_POINT & mesh->mPrimitiveTypes;
+    bool lines = aiPrimitiveType_LINE & mesh->mPrimitiveTypes;
+    bool tris = aiPrimitiveType_TRIANGLE & mesh->mPrimitiveTypes;
+    bool polys = aiPrimitiveType_POLYGON & mesh->mPrimitiveTypes;
+    bool ngons = aiPrimitiveType_NGONEncodingFlag & mesh->mPrimitiveTypes;
+    ImGui::BeginDisabled();
+    ImGui::Checkbox("points", &points);
+    ImGui::Checkbox("lines", &lines);
+    ImGui::Checkbox("tris", &tris);
+    ImGui::Checkbox("polys", &polys);
+    ImGui::Checkbox("ngons", &ngons);
+    ImGui::EndDisabled();
+    ImGui::Separator();
+    ImGui::Text("Name: %s", mesh->mName.data);
+    ImGui::Separator();
+    ImGui::Text("NumFaces: %u", mesh->mNumFaces);
+    imgui_open_next_tree();
+    if (mesh->mFaces != NULL && ImGui::TreeNode("Mesh Faces"))
+    {
+        ShowAiMeshFaces(mesh);
+        ImGui::TreePop();
+    }
+    ImGui::Text("Num Vertecies: %u", mesh->mNumVertices);
+    imgui_open_next_tree();
+    if (mesh->mVertices != NULL && ImGui::TreeNode("Mesh Verticies"))
+    {
+        ShowAiMeshVertices(mesh);
         ImGui::TreePop();
     }
     ImGui::Text("Numbones: %u", mesh->mNumBones);
+    imgui_open_next_tree();
     if (mesh->mBones != NULL && ImGui::TreeNode("Mesh Bones"))
     {
-        for (unsigned int i = 0; i < mesh->mNumBones; i++)
+        ShowAiMeshBones(mesh, tq);
+        ImGui::TreePop();
+    }
+    ImGui::Text("NumAnimMeshes: %u", mesh->mNumAnimMeshes);
+    imgui_open_next_tree();
+    if (mesh->mAnimMeshes != NULL && ImGui::TreeNode("Mesh Animeshes"))
+    {
+        for (unsigned int i = 0; i < mesh->mNumAnimMeshes; i++)
         {
-            if (mesh->mBones[i] != NULL && ImGui::TreeNode((void *)(intptr_t)i, "Bone[%d]", i))
+            imgui_open_next_tree();
+            if (mesh->mAnimMeshes[i] != NULL && ImGui::TreeNode((void *)(intptr_t)i, "AnimMesh[%d]", i))
             {
-                ShowAiNode(mesh->mBones[i]->mArmature);
-                ShowAiNode(mesh->mBones[i]->mNode);
 
-                ImGui::Text(mesh->mBones[i]->mName.data);
-                ShowAiMat4("OffsetMatrix", mesh->mBones[i]->mOffsetMatrix);
+                ImGui::TreePop();
+            }
+        }
+        ImGui::TreePop();
+    }
+}
+// Height of the clipped lists used by the scene inspector, in text lines.
+#define SCENE_LIST_LINES 12
+
+typedef void (*AiLabelFn)(const void *items, unsigned int index, char *buffer, size_t size);
 
-                for (unsigned int j = 0; j < mesh->mBones[i]->mNumWeights; j++)
-                {
-                    ImGui::Text("ID %d, WEIGHT %f", mesh->mBones[i]->mWeights[j].mVertexId, mesh->mBones[i]->mWeights[j].mWeight);
-                }
+static thread_local int selectListReveal = -1;
+
+// Selects index in the next ShowAiSelectList with the same id and scrolls it into view.
+static void SearchNavSelect(const char *id, unsigned int index)
+{
+    *ImGui::GetStateStorage()->GetIntRef(ImGui::GetID(id), -1) = (int)index;
+    selectListReveal = (int)index;
+}
+
+// Clipped, selectable list of count items. The selection is kept in the window
+// state storage under id and returned, -1 when nothing is selected.
+static int ShowAiSelectList(const char *id, const void *items, unsigned int count, AiLabelFn label)
+{
+    int *selected = ImGui::GetStateStorage()->GetIntRef(ImGui::GetID(id), -1);
+    if (*selected >= (int)count)
+        *selected = -1;
+    int reveal = selectListReveal < (int)count ? selectListReveal : -1;
+    selectListReveal = -1;
+
+    char *strbuffer = imgui_frame_alloc(MAXLEN);
+    if (strbuffer == NULL)
+        return *selected;
+    ImGui::BeginChild(id, ImVec2(0, ImGui::GetTextLineHeightWithSpacing() * (count < SCENE_LIST_LINES ? count + 1 : SCENE_LIST_LINES)), ImGuiChildFlags_Border | ImGuiChildFlags_ResizeY);
+    ImGuiListClipper clipper;
+    clipper.Begin((int)count);
+    if (reveal >= 0)
+        clipper.IncludeItemByIndex(reveal);
+    while (clipper.Step())
+    {
+        for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++)
+        {
+            label(items, (unsigned int)i, strbuffer, MAXLEN);
+            ImGui::PushID(i);
+            if (ImGui::Selectable(strbuffer, *selected == i))
+                *selected = *selected == i ? -1 : i;
+            if (i == reveal)
+                ImGui::SetScrollHereY(0.5f);
+            ImGui::PopID();
+        }
+    }
+    ImGui::EndChild();
+    return *selected;
+}
+
+static void ShowAiVector3D(const char *name, aiVector3D v)
+{
+    ImGui::Text("%s: [%f, %f, %f]", name, v.x, v.y, v.z);
+}
+
+static void ShowAiColor3D(const char *name, aiColor3D c)
+{
+    ImGui::Text("%s: [%f, %f, %f]", name, c.r, c.g, c.b);
+}
+
+// Formats the first few values of a material property; long arrays are summarized.
+static void FormatAiMaterialProperty(const aiMaterialProperty *prop, char *buffer, size_t size)
+{
+    const unsigned int maxValues = 4;
+    size_t len = 0;
+    buffer[0] = '\0';
+    switch (prop->mType)
+    {
+    case aiPTI_Float:
+    case aiPTI_Double:
+    case aiPTI_Integer:
+    {
+        unsigned int stride = prop->mType == aiPTI_Double ? sizeof(double) : 4;
+        unsigned int n = prop->mDataLength / stride;
+        for (unsigned int i = 0; i < n && i < maxValues && len < size; i++)
+        {
+            const char *sep = i > 0 ? ", " : "";
+            if (prop->mType == aiPTI_Float)
+                len += snprintf(buffer + len, size - len, "%s%f", sep, ((const float *)prop->mData)[i]);
+            else if (prop->mType == aiPTI_Double)
+                len += snprintf(buffer + len, size - len, "%s%f", sep, ((const double *)prop->mData)[i]);
+            else
+                len += snprintf(buffer + len, size - len, "%s%d", sep, ((const int32_t *)prop->mData)[i]);
+        }
+        if (n > maxValues && len < size)
+            snprintf(buffer + len, size - len, ", ... (%u)", n);
+        break;
+    }
+    case aiPTI_String:
+        // aiString is stored as a 32 bit length followed by the characters.
+        snprintf(buffer, size, "%s", prop->mDataLength > 4 ? prop->mData + 4 : "");
+        break;
+    default:
+        snprintf(buffer, size, "<%u bytes>", prop->mDataLength);
+        break;
+    }
+}
+
+void ShowAiMaterial(aiMaterial *material)
+{
+    aiString name;
+    if (material->Get(AI_MATKEY_NAME, name) == AI_SUCCESS)
+        ImGui::Text("Name: %s", name.data);
+    ImGui::Text("NumProperties: %u", material->mNumProperties);
+
+    const ImGuiTableFlags tableFlags = ImGuiTableFlags_ScrollY | ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersOuter | ImGuiTableFlags_BordersV | ImGuiTableFlags_Resizable;
+    ImVec2 outerSize = ImVec2(0.0f, ImGui::GetTextLineHeightWithSpacing() * MESH_TABLE_LINES);
+    if (!ImGui::BeginTable("Material Properties", 4, tableFlags, outerSize))
+        return;
+    ImGui::TableSetupScrollFreeze(0, 1);
+    ImGui::TableSetupColumn("Key", ImGuiTableColumnFlags_WidthFixed);
+    ImGui::TableSetupColumn("Semantic", ImGuiTableColumnFlags_WidthFixed);
+    ImGui::TableSetupColumn("Index", ImGuiTableColumnFlags_WidthFixed);
+    ImGui::TableSetupColumn("Value", ImGuiTableColumnFlags_WidthStretch);
+    ImGui::TableHeadersRow();
+
+    char strbuffer[MAXLEN];
+    ImGuiListClipper clipper;
+    clipper.Begin((int)material->mNumProperties);
+    while (clipper.Step())
+    {
+        for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; row++)
+        {
+            const aiMaterialProperty *prop = material->mProperties[row];
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(prop->mKey.data);
+            ImGui::TableNextColumn();
+            if (prop->mSemantic > 0 && prop->mSemantic < AI_TEXTURE_TYPE_MAX + 1)
+                ImGui::Text("%s", materialNames[prop->mSemantic]);
+            else
+                ImGui::Text("%u", prop->mSemantic);
+            ImGui::TableNextColumn();
+            ImGui::Text("%u", prop->mIndex);
+            ImGui::TableNextColumn();
+            FormatAiMaterialProperty(prop, strbuffer, MAXLEN);
+            ImGui::TextUnformatted(strbuffer);
+        }
+    }
+    ImGui::EndTable();
+}
+
+static void ShowAiVectorKeys(const char *id, const aiVectorKey *keys, unsigned int numKeys)
+{
+    if (!ImGui::BeginTable(id, 2, ImGuiTableFlags_ScrollY | ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersOuter, ImVec2(0.0f, ImGui::GetTextLineHeightWithSpacing() * MESH_TABLE_LINES)))
+        return;
+    ImGui::TableSetupScrollFreeze(0, 1);
+    ImGui::TableSetupColumn("Time");
+    ImGui::TableSetupColumn("Value");
+    ImGui::TableHeadersRow();
+    ImGuiListClipper clipper;
+    clipper.Begin((int)numKeys);
+    while (clipper.Step())
+    {
+        for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; row++)
+        {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("%f", keys[row].mTime);
+            ImGui::TableNextColumn();
+            ImGui::Text("[%f, %f, %f]", keys[row].mValue.x, keys[row].mValue.y, keys[row].mValue.z);
+        }
+    }
+    ImGui::EndTable();
+}
+
+static void ShowAiQuatKeys(const char *id, const aiQuatKey *keys, unsigned int numKeys)
+{
+    if (!ImGui::BeginTable(id, 2, ImGuiTableFlags_ScrollY | ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersOuter, ImVec2(0.0f, ImGui::GetTextLineHeightWithSpacing() * MESH_TABLE_LINES)))
+        return;
+    ImGui::TableSetupScrollFreeze(0, 1);
+    ImGui::TableSetupColumn("Time");
+    ImGui::TableSetupColumn("Value");
+    ImGui::TableHeadersRow();
+    ImGuiListClipper clipper;
+    clipper.Begin((int)numKeys);
+    while (clipper.Step())
+    {
+        for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; row++)
+        {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("%f", keys[row].mTime);
+            ImGui::TableNextColumn();
+            ImGui::Text("[%f, %f, %f, %f]", keys[row].mValue.w, keys[row].mValue.x, keys[row].mValue.y, keys[row].mValue.z);
+        }
+    }
+    ImGui::EndTable();
+}
+
+static void AiChannelLabel(const void *items, unsigned int index, char *buffer, size_t size)
+{
+    const aiNodeAnim *channel = ((aiNodeAnim *const *)items)[index];
+    snprintf(buffer, size, "%s  (P %u, R %u, S %u)", channel->mNodeName.data, channel->mNumPositionKeys, channel->mNumRotationKeys, channel->mNumScalingKeys);
+}
+
+void ShowAiAnimation(aiAnimation *animation)
+{
+    ImGui::Text("Name: %s", animation->mName.data);
+    ImGui::Text("Duration: %f ticks @ %f ticks/s", animation->mDuration, animation->mTicksPerSecond);
+    ImGui::Text("NumChannels: %u  NumMeshChannels: %u  NumMorphMeshChannels: %u", animation->mNumChannels, animation->mNumMeshChannels, animation->mNumMorphMeshChannels);
+    if (animation->mChannels == NULL || animation->mNumChannels == 0)
+        return;
+
+    int selected = ShowAiSelectList("Channels", animation->mChannels, animation->mNumChannels, AiChannelLabel);
+    if (selected < 0)
+        return;
+
+    // Keyframe arrays are only walked when their node is opened, through clipped tables.
+    const aiNodeAnim *channel = animation->mChannels[selected];
+    ImGui::SeparatorText(channel->mNodeName.data);
+    ImGui::Text("PreState: %d  PostState: %d", channel->mPreState, channel->mPostState);
+    imgui_open_next_tree();
+    if (channel->mPositionKeys != NULL && ImGui::TreeNode("Position Keys", "Position Keys (%u)", channel->mNumPositionKeys))
+    {
+        ShowAiVectorKeys("Position Keys", channel->mPositionKeys, channel->mNumPositionKeys);
+        ImGui::TreePop();
+    }
+    imgui_open_next_tree();
+    if (channel->mRotationKeys != NULL && ImGui::TreeNode("Rotation Keys", "Rotation Keys (%u)", channel->mNumRotationKeys))
+    {
+        ShowAiQuatKeys("Rotation Keys", channel->mRotationKeys, channel->mNumRotationKeys);
+        ImGui::TreePop();
+    }
+    imgui_open_next_tree();
+    if (channel->mScalingKeys != NULL && ImGui::TreeNode("Scaling Keys", "Scaling Keys (%u)", channel->mNumScalingKeys))
+    {
+        ShowAiVectorKeys("Scaling Keys", channel->mScalingKeys, channel->mNumScalingKeys);
+        ImGui::TreePop();
+    }
+}
+
+// One embedded texture preview. The GL thread uploads it and stores texture; the
+// preview map and a queued upload or delete each hold a reference, the last one
+// deletes the texture.
+typedef struct ai_texture_preview_s
+{
+    GLuint texture;
+    int refs;
+} ai_texture_preview_t;
+
+typedef struct ai_texture_upload_s
+{
+    ai_texture_preview_t *preview;
+    GLsizei width;
+    GLsizei height;
+    int pixels; // offset of the copied BGRA texels in the batch
+} ai_texture_upload_t;
+
+// Preview uploads and deletes requested while a frame was built, run where the
+// frame is rendered: imgui_end_frame, or imgui_submit_frame for published frames.
+typedef struct imgui_ai_texture_batch_s
+{
+    ImVector<ai_texture_upload_t> uploads;
+    ImVector<unsigned char> pixels;
+    ImVector<ai_texture_preview_t *> deletes;
+} imgui_ai_texture_batch_t;
+
+// Previews keyed by aiTexture pointer, and the requests of the frame being built.
+static thread_local ImGuiStorage aiTexturePreviews;
+static thread_local imgui_ai_texture_batch_t aiTexturePending;
+
+static ImGuiID AiTextureKey(const aiTexture *texture)
+{
+    return ImHashData(&texture, sizeof(texture));
+}
+
+static void AiTexturePreviewRelease(ai_texture_preview_t *preview)
+{
+    if (__atomic_sub_fetch(&(preview->refs), 1, __ATOMIC_ACQ_REL) > 0)
+        return;
+    if (preview->texture != 0)
+        glDeleteTextures(1, &(preview->texture));
+    IM_DELETE(preview);
+}
+
+static GLuint UploadAiTexturePreview(GLsizei width, GLsizei height, const void *pixels)
+{
+    GLint lastTexture = 0;
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &lastTexture);
+    GLuint preview = 0;
+    glGenTextures(1, &preview);
+    glBindTexture(GL_TEXTURE_2D, preview);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_BGRA, GL_UNSIGNED_BYTE, pixels);
+    glBindTexture(GL_TEXTURE_2D, (GLuint)lastTexture);
+    return preview;
+}
+
+static imgui_ai_texture_batch_t *AiTextureBatchCreate()
+{
+    return IM_NEW(imgui_ai_texture_batch_t)();
+}
+
+// Drops the batch's requests; needs the GL context when it holds deletes.
+static void AiTextureBatchClear(imgui_ai_texture_batch_t *batch)
+{
+    for (int i = 0; i < batch->uploads.Size; i++)
+        AiTexturePreviewRelease(batch->uploads[i].preview);
+    for (int i = 0; i < batch->deletes.Size; i++)
+        AiTexturePreviewRelease(batch->deletes[i]);
+    batch->uploads.resize(0);
+    batch->pixels.resize(0);
+    batch->deletes.resize(0);
+}
+
+static void AiTextureBatchDestroy(imgui_ai_texture_batch_t *batch)
+{
+    if (batch == NULL)
+        return;
+    AiTextureBatchClear(batch);
+    IM_DELETE(batch);
+}
+
+// Moves the calling thread's requests into batch, appending to the ones it may still hold.
+static void AiTextureBatchTake(imgui_ai_texture_batch_t *batch)
+{
+    int base = batch->pixels.Size;
+    for (int i = 0; i < aiTexturePending.uploads.Size; i++)
+    {
+        ai_texture_upload_t upload = aiTexturePending.uploads[i];
+        upload.pixels += base;
+        batch->uploads.push_back(upload);
+    }
+    if (aiTexturePending.pixels.Size > 0)
+    {
+        batch->pixels.resize(base + aiTexturePending.pixels.Size);
+        memcpy(batch->pixels.Data + base, aiTexturePending.pixels.Data, (size_t)aiTexturePending.pixels.Size);
+    }
+    for (int i = 0; i < aiTexturePending.deletes.Size; i++)
+        batch->deletes.push_back(aiTexturePending.deletes[i]);
+    aiTexturePending.uploads.resize(0);
+    aiTexturePending.pixels.resize(0);
+    aiTexturePending.deletes.resize(0);
+}
+
+// Needs the GL context. Empties batch.
+static void AiTextureBatchRun(imgui_ai_texture_batch_t *batch)
+{
+    for (int i = 0; i < batch->uploads.Size; i++)
+    {
+        const ai_texture_upload_t *upload = &(batch->uploads[i]);
+        GLuint texture = UploadAiTexturePreview(upload->width, upload->height, batch->pixels.Data + upload->pixels);
+        __atomic_store_n(&(upload->preview->texture), texture, __ATOMIC_RELEASE);
+        AiTexturePreviewRelease(upload->preview);
+    }
+    for (int i = 0; i < batch->deletes.Size; i++)
+        AiTexturePreviewRelease(batch->deletes[i]);
+    batch->uploads.resize(0);
+    batch->pixels.resize(0);
+    batch->deletes.resize(0);
+}
+
+void ShowAiTexture(aiTexture *texture)
+{
+    ImGui::Text("Filename: %s", texture->mFilename.data);
+    ImGui::Text("FormatHint: %s", texture->achFormatHint);
+    if (texture->mHeight == 0)
+    {
+        // Compressed payloads (png, jpg, ...) would need an image decoder this library does not link.
+        ImGui::Text("Compressed: %u bytes", texture->mWidth);
+        return;
+    }
+    ImGui::Text("Size: %u x %u", texture->mWidth, texture->mHeight);
+
+    ImGuiID key = AiTextureKey(texture);
+    ai_texture_preview_t *preview = (ai_texture_preview_t *)aiTexturePreviews.GetVoidPtr(key);
+    if (preview == NULL)
+    {
+        if (ImGui::Button("Load Preview"))
+        {
+            // The texels are copied, the scene may be gone by the time the frame is rendered.
+            preview = IM_NEW(ai_texture_preview_t)();
+            preview->texture = 0;
+            preview->refs = 2;
+            ai_texture_upload_t upload;
+            upload.preview = preview;
+            upload.width = (GLsizei)texture->mWidth;
+            upload.height = (GLsizei)texture->mHeight;
+            upload.pixels = aiTexturePending.pixels.Size;
+            size_t bytes = (size_t)texture->mWidth * texture->mHeight * sizeof(aiTexel);
+            aiTexturePending.pixels.resize(upload.pixels + (int)bytes);
+            memcpy(aiTexturePending.pixels.Data + upload.pixels, texture->pcData, bytes);
+            aiTexturePending.uploads.push_back(upload);
+            aiTexturePreviews.SetVoidPtr(key, preview);
+        }
+        return;
+    }
+
+    GLuint uploaded = __atomic_load_n(&(preview->texture), __ATOMIC_ACQUIRE);
+    if (uploaded == 0)
+    {
+        ImGui::TextDisabled("Uploading preview...");
+        return;
+    }
+    // Checked before the image is drawn, so an unloaded texture is never part of this frame.
+    if (ImGui::Button("Unload Preview"))
+    {
+        aiTexturePreviews.SetVoidPtr(key, NULL);
+        aiTexturePending.deletes.push_back(preview);
+        return;
+    }
+    float scale = 256.0f / (float)(texture->mWidth > texture->mHeight ? texture->mWidth : texture->mHeight);
+    scale = scale < 1.0f ? scale : 1.0f;
+    ImGui::Image((ImTextureID)(intptr_t)uploaded, ImVec2(texture->mWidth * scale, texture->mHeight * scale));
+}
+
+void imgui_ai_texture_cleanup()
+{
+    for (int i = 0; i < aiTexturePreviews.Data.Size; i++)
+    {
+        ai_texture_preview_t *preview = (ai_texture_preview_t *)aiTexturePreviews.Data[i].val_p;
+        if (preview != NULL)
+            AiTexturePreviewRelease(preview);
+    }
+    aiTexturePreviews.Clear();
+    AiTextureBatchClear(&aiTexturePending);
+    aiTexturePending.uploads.clear();
+    aiTexturePending.pixels.clear();
+    aiTexturePending.deletes.clear();
+}
+
+void ShowAiLights(aiLight *light)
+{
+    static const char *lightTypes[] = {"UNDEFINED", "DIRECTIONAL", "POINT", "SPOT", "AMBIENT", "AREA"};
+    ImGui::Text("Name: %s", light->mName.data);
+    ImGui::Text("Type: %s", (unsigned int)light->mType < sizeof(lightTypes) / sizeof(lightTypes[0]) ? lightTypes[light->mType] : "?");
+    ShowAiVector3D("Position", light->mPosition);
+    ShowAiVector3D("Direction", light->mDirection);
+    ShowAiVector3D("Up", light->mUp);
+    ImGui::Text("Attenuation: const %f, linear %f, quadratic %f", light->mAttenuationConstant, light->mAttenuationLinear, light->mAttenuationQuadratic);
+    ShowAiColor3D("Diffuse", light->mColorDiffuse);
+    ShowAiColor3D("Specular", light->mColorSpecular);
+    ShowAiColor3D("Ambient", light->mColorAmbient);
+    ImGui::Text("Cone: inner %f, outer %f", light->mAngleInnerCone, light->mAngleOuterCone);
+    ImGui::Text("Size: [%f, %f]", light->mSize.x, light->mSize.y);
+}
+
+void ShowAiCameras(aiCamera *camera)
+{
+    ImGui::Text("Name: %s", camera->mName.data);
+    ShowAiVector3D("Position", camera->mPosition);
+    ShowAiVector3D("Up", camera->mUp);
+    ShowAiVector3D("LookAt", camera->mLookAt);
+    ImGui::Text("HorizontalFOV: %f", camera->mHorizontalFOV);
+    ImGui::Text("Clip: near %f, far %f", camera->mClipPlaneNear, camera->mClipPlaneFar);
+    ImGui::Text("Aspect: %f", camera->mAspect);
+    ImGui::Text("OrthographicWidth: %f", camera->mOrthographicWidth);
+}
+
+static void AiSkeletonBoneLabel(const void *items, unsigned int index, char *buffer, size_t size)
+{
+    const aiSkeletonBone *bone = ((aiSkeletonBone *const *)items)[index];
+    snprintf(buffer, size, "Bone[%u] %s  (parent %d, %u weights)", index, bone->mNode != NULL ? bone->mNode->mName.data : "", bone->mParent, bone->mNumnWeights);
+}
+
+void ShowAiSkeletons(aiSkeleton *skeleton)
+{
+    ImGui::Text("Name: %s", skeleton->mName.data);
+    ImGui::Text("NumBones: %u", skeleton->mNumBones);
+    if (skeleton->mBones == NULL || skeleton->mNumBones == 0)
+        return;
+
+    int selected = ShowAiSelectList("Skeleton Bones", skeleton->mBones, skeleton->mNumBones, AiSkeletonBoneLabel);
+    if (selected < 0)
+        return;
+
+    const aiSkeletonBone *bone = skeleton->mBones[selected];
+    ImGui::SeparatorText(bone->mNode != NULL ? bone->mNode->mName.data : "Bone");
+    ImGui::Text("Mesh: %s", bone->mMeshId != NULL ? bone->mMeshId->mName.data : "None");
+    ShowAiMat4("OffsetMatrix", bone->mOffsetMatrix);
+    ShowAiMat4("LocalMatrix", bone->mLocalMatrix);
+    imgui_open_next_tree();
+    if (bone->mWeights != NULL && ImGui::TreeNode("Weights", "Weights (%u)", bone->mNumnWeights))
+    {
+        if (ImGui::BeginTable("Weights", 2, ImGuiTableFlags_ScrollY | ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersOuter, ImVec2(0.0f, ImGui::GetTextLineHeightWithSpacing() * MESH_TABLE_LINES)))
+        {
+            ImGui::TableSetupScrollFreeze(0, 1);
+            ImGui::TableSetupColumn("VertexId");
+            ImGui::TableSetupColumn("Weight");
+            ImGui::TableHeadersRow();
+            ImGuiListClipper clipper;
+            clipper.Begin((int)bone->mNumnWeights);
+            while (clipper.Step())
+            {
+                for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; row++)
+                {
+                    ImGui::TableNextRow();
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%u", bone->mWeights[row].mVertexId);
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%f", bone->mWeights[row].mWeight);
+                }
+            }
+            ImGui::EndTable();
+        }
+        ImGui::TreePop();
+    }
+}
+
+static void AiMeshLabel(const void *items, unsigned int index, char *buffer, size_t size)
+{
+    const aiMesh *mesh = ((aiMesh *const *)items)[index];
+    snprintf(buffer, size, "Mesh[%u] %s  (%u verts, %u faces, %u bones)", index, mesh->mName.data, mesh->mNumVertices, mesh->mNumFaces, mesh->mNumBones);
+}
+
+static void AiMaterialLabel(const void *items, unsigned int index, char *buffer, size_t size)
+{
+    const aiMaterial *material = ((aiMaterial *const *)items)[index];
+    aiString name;
+    if (aiGetMaterialString(material, AI_MATKEY_NAME, &name) != AI_SUCCESS)
+        name.Set("");
+    snprintf(buffer, size, "Material[%u] %s  (%u properties)", index, name.data, material->mNumProperties);
+}
+
+static void AiAnimationLabel(const void *items, unsigned int index, char *buffer, size_t size)
+{
+    const aiAnimation *animation = ((aiAnimation *const *)items)[index];
+    snprintf(buffer, size, "Animation[%u] %s  (%u channels)", index, animation->mName.data, animation->mNumChannels);
+}
+
+static void AiTextureLabel(const void *items, unsigned int index, char *buffer, size_t size)
+{
+    const aiTexture *texture = ((aiTexture *const *)items)[index];
+    if (texture->mHeight == 0)
+        snprintf(buffer, size, "Texture[%u] %s  (%s, %u bytes)", index, texture->mFilename.data, texture->achFormatHint, texture->mWidth);
+    else
+        snprintf(buffer, size, "Texture[%u] %s  (%u x %u)", index, texture->mFilename.data, texture->mWidth, texture->mHeight);
+}
+
+static void AiLightLabel(const void *items, unsigned int index, char *buffer, size_t size)
+{
+    snprintf(buffer, size, "Light[%u] %s", index, ((aiLight *const *)items)[index]->mName.data);
+}
+
+static void AiCameraLabel(const void *items, unsigned int index, char *buffer, size_t size)
+{
+    snprintf(buffer, size, "Camera[%u] %s", index, ((aiCamera *const *)items)[index]->mName.data);
+}
+
+static void AiSkeletonLabel(const void *items, unsigned int index, char *buffer, size_t size)
+{
+    const aiSkeleton *skeleton = ((aiSkeleton *const *)items)[index];
+    snprintf(buffer, size, "Skeleton[%u] %s  (%u bones)", index, skeleton->mName.data, skeleton->mNumBones);
+}
+
+void ShowAiScene(const aiScene *scene, task_queue_t *tq)
+{
+    imgui_open_next_tree();
+    if (ImGui::TreeNode("SceneFlags"))
+    {
+        bool scene_incomplete = AI_SCENE_FLAGS_INCOMPLETE & scene->mFlags;
+        bool scene_validated = AI_SCENE_FLAGS_VALIDATED & scene->mFlags;
+        bool scene_validationWarning = AI_SCENE_FLAGS_VALIDATION_WARNING & scene->mFlags;
+        bool scene_non_verbode_format = AI_SCENE_FLAGS_NON_VERBOSE_FORMAT & scene->mFlags;
+        bool scene_terrain = AI_SCENE_FLAGS_TERRAIN & scene->mFlags;
+        bool scene_allow_shared = AI_SCENE_FLAGS_ALLOW_SHARED & scene->mFlags;
+        ImGui::BeginDisabled();
+        ImGui::Checkbox("INCOMPLETE", &scene_incomplete);
+        ImGui::Checkbox("VALIDATED", &scene_validated);
+        ImGui::Checkbox("VALIDATON_WARNING", &scene_validationWarning);
+        ImGui::Checkbox("NON_VERBOSE_FORMAT", &scene_non_verbode_format);
+        ImGui::Checkbox("TERRAIN", &scene_terrain);
+        ImGui::Checkbox("ALLOW_SHARED", &scene_allow_shared);
+        ImGui::EndDisabled();
+        ImGui::Separator();
+
+        ImGui::TreePop();
+    }
+    int navKind = SearchNavOwner(scene) ? searchNav.target.kind : -1;
+    SearchNavOpen(navKind == IMGUI_SEARCH_AI_NODE || (navKind == IMGUI_SEARCH_AI_METADATA && searchNav.target.ptr != NULL));
+    if (scene->mRootNode != NULL && ImGui::TreeNode("Scene Nodes"))
+    {
+        ShowAiNodeHierarchy(scene->mRootNode);
+        ImGui::TreePop();
+    }
+    SearchNavOpen(navKind == IMGUI_SEARCH_AI_MESH);
+    if (scene->mMeshes != NULL && ImGui::TreeNode("Scene Meshes", "Scene Meshes (%u)", scene->mNumMeshes))
+    {
+        if (navKind == IMGUI_SEARCH_AI_MESH)
+            SearchNavSelect("Meshes", searchNav.target.a);
+        int selected = ShowAiSelectList("Meshes", scene->mMeshes, scene->mNumMeshes, AiMeshLabel);
+        if (selected >= 0)
+        {
+            ImGui::Separator();
+            ShowAiMesh(scene->mMeshes[selected], tq);
+        }
+        ImGui::TreePop();
+    }
+    SearchNavOpen(navKind == IMGUI_SEARCH_AI_MATERIAL);
+    if (scene->mMaterials != NULL && ImGui::TreeNode("Scene Materials", "Scene Materials (%u)", scene->mNumMaterials))
+    {
+        if (navKind == IMGUI_SEARCH_AI_MATERIAL)
+            SearchNavSelect("Materials", searchNav.target.a);
+        int selected = ShowAiSelectList("Materials", scene->mMaterials, scene->mNumMaterials, AiMaterialLabel);
+        if (selected >= 0)
+        {
+            ImGui::Separator();
+            ShowAiMaterial(scene->mMaterials[selected]);
+        }
+        ImGui::TreePop();
+    }
+    imgui_open_next_tree();
+    if (scene->mAnimations != NULL && ImGui::TreeNode("Scene Animations", "Scene Animations (%u)", scene->mNumAnimations))
+    {
+        int selected = ShowAiSelectList("Animations", scene->mAnimations, scene->mNumAnimations, AiAnimationLabel);
+        if (selected >= 0)
+        {
+            ImGui::Separator();
+            ShowAiAnimation(scene->mAnimations[selected]);
+        }
+        ImGui::TreePop();
+    }
+    SearchNavOpen(navKind == IMGUI_SEARCH_AI_TEXTURE);
+    if (scene->mTextures != NULL && ImGui::TreeNode("Scene Textures", "Scene Textures (%u)", scene->mNumTextures))
+    {
+        if (navKind == IMGUI_SEARCH_AI_TEXTURE)
+            SearchNavSelect("Textures", searchNav.target.a);
+        int selected = ShowAiSelectList("Textures", scene->mTextures, scene->mNumTextures, AiTextureLabel);
+        if (selected >= 0)
+        {
+            ImGui::Separator();
+            ShowAiTexture(scene->mTextures[selected]);
+        }
+        ImGui::TreePop();
+    }
+    imgui_open_next_tree();
+    if (scene->mLights != NULL && ImGui::TreeNode("Scene Lights", "Scene Lights (%u)", scene->mNumLights))
+    {
+        int selected = ShowAiSelectList("Lights", scene->mLights, scene->mNumLights, AiLightLabel);
+        if (selected >= 0)
+        {
+            ImGui::Separator();
+            ShowAiLights(scene->mLights[selected]);
+        }
+        ImGui::TreePop();
+    }
+    imgui_open_next_tree();
+    if (scene->mCameras != NULL && ImGui::TreeNode("Scene Cameras", "Scene Cameras (%u)", scene->mNumCameras))
+    {
+        int selected = ShowAiSelectList("Cameras", scene->mCameras, scene->mNumCameras, AiCameraLabel);
+        if (selected >= 0)
+        {
+            ImGui::Separator();
+            ShowAiCameras(scene->mCameras[selected]);
+        }
+        ImGui::TreePop();
+    }
+    imgui_open_next_tree();
+    if (scene->mSkeletons != NULL && ImGui::TreeNode("Scene Skeletons", "Scene Skeletons (%u)", scene->mNumSkeletons))
+    {
+        int selected = ShowAiSelectList("Skeletons", scene->mSkeletons, scene->mNumSkeletons, AiSkeletonLabel);
+        if (selected >= 0)
+        {
+            ImGui::Separator();
+            ShowAiSkeletons(scene->mSkeletons[selected]);
+        }
+        ImGui::TreePop();
+    }
+    SearchNavOpen(navKind == IMGUI_SEARCH_AI_METADATA && searchNav.target.ptr == NULL);
+    showAiMetadata("Metadata", scene->mMetaData);
+}
+
+void imgui_set_scenes(nonstd_imgui_t *gui, unsigned int numScenes, const struct aiScene **sceneList)
+{
+    gui->numScenes = numScenes;
+    gui->sceneList = sceneList;
+}
+
+void ShowSceneToolWindow(bool *p_open, unsigned int num_scenes, const aiScene **scene, task_queue_t *tq)
+{
+    if (!ImGui::Begin("Scene Tool Window", p_open))
+    {
+        ImGui::End();
+        return;
+    }
+    ImGui::Text("Scene Tool Window");
+    ImGui::Separator();
+    if (scene == NULL || num_scenes == 0)
+    {
+        ImGui::TextDisabled("No scenes, see imgui_set_scenes");
+        ImGui::End();
+        return;
+    }
+    for (unsigned int index = 0; index < num_scenes; index++)
+    {
+        SearchNavOpen(scene[index] != NULL && SearchNavOwner(scene[index]));
+        if (scene[index] != NULL && ImGui::TreeNode((void *)(intptr_t)index, "Scene %u %s", index, scene[index]->mName.data))
+        {
+            ShowAiScene(scene[index], tq);
+            ImGui::TreePop();
+        }
+    }
+    ImGui::End();
+}
+
+#define SEARCH_MAX_RESULTS 4096
+#define SEARCH_RESULT_LINES 20
+
+typedef struct search_window_s
+{
+    char query[256];
+    char lastQuery[256];
+    unsigned long long generation;
+    unsigned int total;
+    ImVector<imgui_search_result_t> results;
+} search_window_t;
+
+static thread_local search_window_t searchWindow;
+
+static const char *SearchKindName(int kind)
+{
+    switch (kind)
+    {
+    case IMGUI_SEARCH_MODEL_TEXTURE:
+        return "Model Texture";
+    case IMGUI_SEARCH_AI_NODE:
+        return "Node";
+    case IMGUI_SEARCH_AI_METADATA:
+        return "Metadata";
+    case IMGUI_SEARCH_AI_MESH:
+        return "Mesh";
+    case IMGUI_SEARCH_AI_MATERIAL:
+        return "Material Texture";
+    case IMGUI_SEARCH_AI_TEXTURE:
+        return "Texture";
+    default:
+        return "?";
+    }
+}
+
+void ShowSearchToolWindow(bool *p_open, imgui_tool_options_t *tool_options)
+{
+    if (!ImGui::Begin("Search Tool Window", p_open))
+    {
+        ImGui::End();
+        return;
+    }
+    const imgui_search_stats_t *stats = imgui_search_get_stats();
+    ImGui::Text("Search Tool Window");
+    ImGui::Separator();
+    ImGui::InputTextWithHint("##Query", "node, mesh, texture or metadata name", searchWindow.query, sizeof(searchWindow.query));
+
+    // Results point into the index, so they are refreshed whenever an index is swapped.
+    if (strcmp(searchWindow.query, searchWindow.lastQuery) != 0 || searchWindow.generation != stats->generation)
+    {
+        memcpy(searchWindow.lastQuery, searchWindow.query, sizeof(searchWindow.query));
+        searchWindow.generation = stats->generation;
+        searchWindow.results.resize(SEARCH_MAX_RESULTS);
+        unsigned int count = imgui_search_query(searchWindow.query, searchWindow.results.Data, SEARCH_MAX_RESULTS, &(searchWindow.total));
+        searchWindow.results.resize((int)count);
+    }
+    ImGui::Text("%u matches  (%.3f ms)", searchWindow.total, stats->querySeconds * 1000.0);
+    ImGui::SameLine();
+    ImGui::TextDisabled("%u names, %u trigrams%s", stats->entries, stats->trigrams, stats->building > 0 ? ", indexing..." : "");
+    if (searchWindow.total > (unsigned int)searchWindow.results.Size)
+        ImGui::TextDisabled("Showing the first %d", searchWindow.results.Size);
+
+    const ImGuiTableFlags tableFlags = ImGuiTableFlags_ScrollY | ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersOuter | ImGuiTableFlags_BordersV | ImGuiTableFlags_Resizable;
+    ImVec2 outerSize = ImVec2(0.0f, ImGui::GetTextLineHeightWithSpacing() * SEARCH_RESULT_LINES);
+    if (ImGui::BeginTable("Search Results", 3, tableFlags, outerSize))
+    {
+        ImGui::TableSetupScrollFreeze(0, 1);
+        ImGui::TableSetupColumn("Source", ImGuiTableColumnFlags_WidthFixed);
+        ImGui::TableSetupColumn("Kind", ImGuiTableColumnFlags_WidthFixed);
+        ImGui::TableSetupColumn("Name", ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableHeadersRow();
+        ImGuiListClipper clipper;
+        clipper.Begin(searchWindow.results.Size);
+        while (clipper.Step())
+        {
+            for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; row++)
+            {
+                const imgui_search_result_t *result = &(searchWindow.results[row]);
+                bool model = result->kind == IMGUI_SEARCH_MODEL_TEXTURE;
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::PushID(row);
+                if (ImGui::Selectable(model ? imgui_frame_printf("Model %u", result->source) : imgui_frame_printf("Scene %u", result->source), false, ImGuiSelectableFlags_SpanAllColumns))
+                {
+                    searchNav.target = *result;
+                    searchNav.frames = SEARCH_NAV_FRAMES;
+                    searchNav.revealed = 0;
+                    if (model)
+                        tool_options->show_model_tool = 1;
+                    else
+                        tool_options->show_scene_tool = 1;
+                    ImGui::SetWindowFocus(model ? "Model Tool Window" : "Scene Tool Window");
+                }
+                ImGui::PopID();
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(SearchKindName(result->kind));
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(result->text);
+            }
+        }
+        ImGui::EndTable();
+    }
+    ImGui::End();
+}
+
+void imgui_search_window_cleanup()
+{
+    searchWindow.results.clear();
+    searchWindow.query[0] = '\0';
+    searchWindow.lastQuery[0] = '\0';
+    searchWindow.total = 0;
+    memset(&searchNav, 0, sizeof(searchNav));
+}
+
+#define MAP_PREVIEW_DRAW_POINTS 65536
+#define MAP_PREVIEW_ERROR_SAMPLES 4096
+#define MAP_PREVIEW_TILE_SAMPLES 64
+#define MAP_PREVIEW_MAX_TILE_LAT 85.0511287798
+
+typedef struct map_preview_line_s
+{
+    unsigned int start;
+    unsigned int count;
+    int tile;
+} map_preview_line_t;
+
+typedef struct map_preview_settings_s
+{
+    imgui_projection_t source;
+    imgui_projection_t target;
+    int graticuleStep;
+    int samplesPerLine;
+    int tileZoom;
+} map_preview_settings_t;
+
+// Reprojected graticule and source tile grid, rebuilt only when the settings change.
+typedef struct map_preview_s
+{
+    int valid;
+    map_preview_settings_t settings;
+    ImVector<float> lon;
+    ImVector<float> lat;
+    ImVector<float> x;
+    ImVector<float> y;
+    ImVector<map_preview_line_t> lines;
+    ImVector<ImVec2> scratch;
+    float minX, minY, maxX, maxY;
+    double kernelTime;
+    double maxError;
+    double rmsError;
+} map_preview_t;
+
+static thread_local map_preview_t mapPreview;
+
+static void MapProjectionFromMap(imgui_projection_t *projection, int type, float a, float b, float p1, float p2, float p3, float p4, float p5)
+{
+    memset(projection, 0, sizeof(imgui_projection_t));
+    projection->type = type;
+    projection->a = a;
+    projection->b = b;
+    projection->lon0 = p1;
+    projection->lat0 = p2;
+    projection->k0 = p3;
+    projection->x0 = p4;
+    projection->y0 = p5;
+}
+
+static void MapPreviewAddLine(map_preview_t *preview, int tile)
+{
+    map_preview_line_t line;
+    line.start = (unsigned int)preview->lon.Size;
+    line.count = 0;
+    line.tile = tile;
+    preview->lines.push_back(line);
+}
+
+static void MapPreviewAddPoint(map_preview_t *preview, double lon, double lat)
+{
+    preview->lon.push_back((float)lon);
+    preview->lat.push_back((float)lat);
+    preview->lines.back().count++;
+}
+
+static void MapPreviewBuild(map_preview_t *preview)
+{
+    const map_preview_settings_t *settings = &(preview->settings);
+    preview->lon.resize(0);
+    preview->lat.resize(0);
+    preview->lines.resize(0);
+
+    // Graticule in geodetic coordinates.
+    int step = settings->graticuleStep;
+    int samples = settings->samplesPerLine;
+    int tiles = 1 << settings->tileZoom;
+    int numPoints = (360 / step + 180 / step + 2) * samples + 2 * (tiles + 1) * MAP_PREVIEW_TILE_SAMPLES;
+    preview->lon.reserve(numPoints);
+    preview->lat.reserve(numPoints);
+    for (int lon = -180; lon <= 180; lon += step)
+    {
+        MapPreviewAddLine(preview, 0);
+        for (int i = 0; i < samples; i++)
+            MapPreviewAddPoint(preview, lon, -90.0 + 180.0 * i / (samples - 1));
+    }
+    for (int lat = -90; lat <= 90; lat += step)
+    {
+        MapPreviewAddLine(preview, 0);
+        for (int i = 0; i < samples; i++)
+            MapPreviewAddPoint(preview, -180.0 + 360.0 * i / (samples - 1), lat);
+    }
+
+    // Tile boundaries are regular in the source projection, map them back to geodetic
+    // once here so the per-point work below is a single forward projection.
+    const imgui_projection_t *source = &(settings->source);
+    double x0, y0, x1, y1;
+    imgui_projection_forward_reference(source, -180.0, -MAP_PREVIEW_MAX_TILE_LAT, &x0, &y0);
+    imgui_projection_forward_reference(source, 180.0, MAP_PREVIEW_MAX_TILE_LAT, &x1, &y1);
+    for (int axis = 0; axis < 2; axis++)
+    {
+        for (int t = 0; t <= tiles; t++)
+        {
+            MapPreviewAddLine(preview, 1);
+            for (int i = 0; i < MAP_PREVIEW_TILE_SAMPLES; i++)
+            {
+                double u = (double)t / tiles;
+                double v = (double)i / (MAP_PREVIEW_TILE_SAMPLES - 1);
+                double px = x0 + (x1 - x0) * (axis == 0 ? u : v);
+                double py = y0 + (y1 - y0) * (axis == 0 ? v : u);
+                double lon, lat;
+                imgui_projection_inverse_reference(source, px, py, &lon, &lat);
+                MapPreviewAddPoint(preview, lon, lat);
+            }
+        }
+    }
+
+    unsigned int n = (unsigned int)preview->lon.Size;
+    preview->x.resize(n);
+    preview->y.resize(n);
+    double start = glfwGetTime();
+    imgui_projection_forward(&(settings->target), preview->lon.Data, preview->lat.Data, preview->x.Data, preview->y.Data, n);
+    preview->kernelTime = glfwGetTime() - start;
+
+    preview->minX = preview->minY = FLT_MAX;
+    preview->maxX = preview->maxY = -FLT_MAX;
+    for (unsigned int i = 0; i < n; i++)
+    {
+        float x = preview->x[i], y = preview->y[i];
+        if (!isfinite(x) || !isfinite(y))
+            continue;
+        preview->minX = x < preview->minX ? x : preview->minX;
+        preview->maxX = x > preview->maxX ? x : preview->maxX;
+        preview->minY = y < preview->minY ? y : preview->minY;
+        preview->maxY = y > preview->maxY ? y : preview->maxY;
+    }
+
+    double sum = 0.0;
+    unsigned int count = 0, stride = n / MAP_PREVIEW_ERROR_SAMPLES + 1;
+    preview->maxError = 0.0;
+    for (unsigned int i = 0; i < n; i += stride)
+    {
+        double rx, ry;
+        imgui_projection_forward_reference(&(settings->target), preview->lon[i], preview->lat[i], &rx, &ry);
+        double dx = rx - preview->x[i], dy = ry - preview->y[i];
+        double error = sqrt(dx * dx + dy * dy);
+        preview->maxError = error > preview->maxError ? error : preview->maxError;
+        sum += error * error;
+        count++;
+    }
+    preview->rmsError = count > 0 ? sqrt(sum / count) : 0.0;
+    preview->valid = 1;
+}
+
+void ShowMapPreview(map_t *map)
+{
+    static thread_local int graticuleStep = 10;
+    static thread_local int samplesPerLine = 256;
+    static thread_local int tileZoom = 2;
+    ImGui::SliderInt("Graticule step", &graticuleStep, 1, 30, "%d deg");
+    ImGui::SliderInt("Samples per line", &samplesPerLine, 16, 4096, "%d", ImGuiSliderFlags_Logarithmic);
+    ImGui::SliderInt("Tile zoom", &tileZoom, 0, 6);
+
+    map_preview_settings_t settings;
+    memset(&settings, 0, sizeof(settings));
+    MapProjectionFromMap(&(settings.source), map->source_projection.type, map->source_Ellipsoid.a, map->source_Ellipsoid.b,
+                         map->source_projection.p1, map->source_projection.p2, map->source_projection.p3, map->source_projection.p4, map->source_projection.p5);
+    MapProjectionFromMap(&(settings.target), map->target_projection.type, map->target_Ellipsoid.a, map->target_Ellipsoid.b,
+                         map->target_projection.p1, map->target_projection.p2, map->target_projection.p3, map->target_projection.p4, map->target_projection.p5);
+    settings.graticuleStep = graticuleStep;
+    settings.samplesPerLine = samplesPerLine;
+    settings.tileZoom = tileZoom;
+
+    map_preview_t *preview = &mapPreview;
+    if (!preview->valid || memcmp(&settings, &(preview->settings), sizeof(settings)) != 0)
+    {
+        preview->settings = settings;
+        MapPreviewBuild(preview);
+    }
+
+    unsigned int n = (unsigned int)preview->lon.Size;
+    ImGui::Text("Points: %u  Kernel (%s): %.3f ms  %.1f Mpts/s", n, imgui_projection_kernel_name(), preview->kernelTime * 1000.0,
+                preview->kernelTime > 0.0 ? n / preview->kernelTime * 1e-6 : 0.0);
+    ImGui::Text("Error vs double: max %.3f m  rms %.3f m", preview->maxError, preview->rmsError);
+
+    ImVec2 origin = ImGui::GetCursorScreenPos();
+    ImVec2 size = ImVec2(480.0f, 320.0f);
+    ImGui::InvisibleButton("Map Preview", size);
+    ImDrawList *drawList = ImGui::GetWindowDrawList();
+    drawList->AddRectFilled(origin, ImVec2(origin.x + size.x, origin.y + size.y), ImGui::GetColorU32(ImGuiCol_FrameBg));
+    float rangeX = preview->maxX - preview->minX, rangeY = preview->maxY - preview->minY;
+    if (!(rangeX > 0.0f) || !(rangeY > 0.0f))
+        return;
+
+    // Fit the projected extent with a uniform scale, y up.
+    const float margin = 8.0f;
+    float scaleX = (size.x - 2.0f * margin) / rangeX, scaleY = (size.y - 2.0f * margin) / rangeY;
+    float scale = scaleX < scaleY ? scaleX : scaleY;
+    ImVec2 center = ImVec2(origin.x + size.x * 0.5f, origin.y + size.y * 0.5f);
+    float midX = (preview->minX + preview->maxX) * 0.5f, midY = (preview->minY + preview->maxY) * 0.5f;
+
+    // All points are projected, only every stride-th one is drawn.
+    unsigned int stride = n / MAP_PREVIEW_DRAW_POINTS + 1;
+    drawList->PushClipRect(origin, ImVec2(origin.x + size.x, origin.y + size.y), true);
+    for (int l = 0; l < preview->lines.Size; l++)
+    {
+        const map_preview_line_t *line = &(preview->lines[l]);
+        unsigned int lineStride = line->tile ? 1 : stride;
+        preview->scratch.resize(0);
+        for (unsigned int i = 0; i < line->count; i += lineStride)
+        {
+            unsigned int index = line->start + (i + lineStride >= line->count ? line->count - 1 : i);
+            preview->scratch.push_back(ImVec2(center.x + (preview->x[index] - midX) * scale, center.y - (preview->y[index] - midY) * scale));
+        }
+        ImU32 color = line->tile ? IM_COL32(255, 160, 64, 200) : IM_COL32(160, 200, 255, 140);
+        drawList->AddPolyline(preview->scratch.Data, preview->scratch.Size, color, ImDrawFlags_None, 1.0f);
+    }
+    drawList->PopClipRect();
+}
+
+void imgui_map_preview_cleanup()
+{
+    mapPreview.lon.clear();
+    mapPreview.lat.clear();
+    mapPreview.x.clear();
+    mapPreview.y.clear();
+    mapPreview.lines.clear();
+    mapPreview.scratch.clear();
+    mapPreview.valid = 0;
+}
+
+typedef struct map_staging_s
+{
+    const map_t *map;
+    map_t shadow;
+    map_t base;       // parameters before the pending edit, for Revert
+    int dirty;
+    int applied;      // a drag-time apply already reached the map
+    double lastEdit;
+    double lastApply;
+    unsigned long long previewApplies;
+    unsigned long long fullApplies;
+} map_staging_t;
+
+static thread_local map_staging_t mapStaging;
+
+static int MapParametersEqual(const map_t *a, const map_t *b)
+{
+    return memcmp(&(a->source_Ellipsoid), &(b->source_Ellipsoid), sizeof(a->source_Ellipsoid)) == 0 &&
+           memcmp(&(a->target_Ellipsoid), &(b->target_Ellipsoid), sizeof(a->target_Ellipsoid)) == 0 &&
+           memcmp(&(a->source_projection), &(b->source_projection), sizeof(a->source_projection)) == 0 &&
+           memcmp(&(a->target_projection), &(b->target_projection), sizeof(a->target_projection)) == 0;
+}
+
+// Writes every staged parameter back in one go and notifies the host once.
+static void MapApply(nonstd_imgui_t *gui, map_t *map, int apply)
+{
+    map_staging_t *staging = &mapStaging;
+    map->source_Ellipsoid = staging->shadow.source_Ellipsoid;
+    map->target_Ellipsoid = staging->shadow.target_Ellipsoid;
+    map->source_projection = staging->shadow.source_projection;
+    map->target_projection = staging->shadow.target_projection;
+    staging->lastApply = glfwGetTime();
+    if (apply == IMGUI_MAP_APPLY_FULL)
+    {
+        staging->dirty = 0;
+        staging->applied = 0;
+        staging->fullApplies++;
+    }
+    else
+    {
+        staging->applied = 1;
+        staging->previewApplies++;
+    }
+    if (gui->map_changed != NULL)
+        gui->map_changed(map, apply, gui->map_changed_user);
+}
+
+static bool MapDragFloat(const char *label, float *v, bool *active)
+{
+    bool changed = ImGui::DragFloat(label, v, 0.005f, -FLT_MAX, FLT_MAX, "%f", ImGuiSliderFlags_None);
+    *active |= ImGui::IsItemActive();
+    return changed;
+}
+
+static bool MapDragInt(const char *label, int *v, bool *active)
+{
+    bool changed = ImGui::DragInt(label, v, 1.0F, 0, 1, "%d", ImGuiSliderFlags_None);
+    *active |= ImGui::IsItemActive();
+    return changed;
+}
+
+void ShowMapToolWindow(bool *p_open, nonstd_imgui_t *gui, map_t *map)
+{
+    if (!ImGui::Begin("Map Tool Window", p_open, ImGuiWindowFlags_AlwaysAutoResize))
+    {
+        ImGui::End();
+        return;
+    }
+
+    // Track the host's map while nothing is staged so external changes show up.
+    map_staging_t *staging = &mapStaging;
+    if (staging->map != map || !staging->dirty)
+    {
+        staging->map = map;
+        staging->shadow = *map;
+        staging->base = *map;
+        staging->dirty = 0;
+        staging->applied = 0;
+    }
+    map_t *shadow = &(staging->shadow);
+
+    bool changed = false;
+    bool active = false;
+    changed |= MapDragFloat("source_Ellipsoid.a", &(shadow->source_Ellipsoid.a), &active);
+    changed |= MapDragFloat("source_Ellipsoid.b", &(shadow->source_Ellipsoid.b), &active);
+    ImGui::Separator();
+    changed |= MapDragFloat("target_Ellipsoid.a", &(shadow->target_Ellipsoid.a), &active);
+    changed |= MapDragFloat("target_Ellipsoid.b", &(shadow->target_Ellipsoid.b), &active);
+    ImGui::Separator();
+
+    changed |= MapDragInt("source_projection.type", &(shadow->source_projection.type), &active);
+    changed |= MapDragFloat("source_projection.p1", &(shadow->source_projection.p1), &active);
+    changed |= MapDragFloat("source_projection.p2", &(shadow->source_projection.p2), &active);
+    changed |= MapDragFloat("source_projection.p3", &(shadow->source_projection.p3), &active);
+    changed |= MapDragFloat("source_projection.p4", &(shadow->source_projection.p4), &active);
+    changed |= MapDragFloat("source_projection.p5", &(shadow->source_projection.p5), &active);
+    changed |= MapDragFloat("source_projection.p6", &(shadow->source_projection.p6), &active);
+    changed |= MapDragFloat("source_projection.p7", &(shadow->source_projection.p7), &active);
+    ImGui::Separator();
+    changed |= MapDragInt("target_projection.type", &(shadow->target_projection.type), &active);
+    changed |= MapDragFloat("target_projection.p1", &(shadow->target_projection.p1), &active);
+    changed |= MapDragFloat("target_projection.p2", &(shadow->target_projection.p2), &active);
+    changed |= MapDragFloat("target_projection.p3", &(shadow->target_projection.p3), &active);
+    changed |= MapDragFloat("target_projection.p4", &(shadow->target_projection.p4), &active);
+    changed |= MapDragFloat("target_projection.p5", &(shadow->target_projection.p5), &active);
+    changed |= MapDragFloat("target_projection.p6", &(shadow->target_projection.p6), &active);
+    changed |= MapDragFloat("target_projection.p7", &(shadow->target_projection.p7), &active);
+    ImGui::Separator();
+
+    double now = glfwGetTime();
+    if (changed)
+    {
+        staging->dirty = 1;
+        staging->lastEdit = now;
+    }
+
+    ImGui::RadioButton("Apply on release", &(gui->map_drag_apply), IMGUI_MAP_APPLY_OFF);
+    ImGui::SameLine();
+    ImGui::RadioButton("Cheap preview", &(gui->map_drag_apply), IMGUI_MAP_APPLY_PREVIEW);
+    ImGui::SameLine();
+    ImGui::RadioButton("Full rebuild", &(gui->map_drag_apply), IMGUI_MAP_APPLY_FULL);
+    float debounceMs = (float)(gui->map_debounce * 1000.0);
+    if (ImGui::SliderFloat("Debounce", &debounceMs, 0.0f, 2000.0f, "%.0f ms"))
+        gui->map_debounce = debounceMs * 0.001;
+
+    ImGui::BeginDisabled(!staging->dirty);
+    bool applyNow = ImGui::Button("Apply");
+    ImGui::SameLine();
+    bool revert = ImGui::Button("Revert");
+    ImGui::EndDisabled();
+    ImGui::SameLine();
+    ImGui::Text("%s  preview %llu, full %llu", staging->dirty ? "Pending" : "Applied", staging->previewApplies, staging->fullApplies);
+
+    if (revert)
+    {
+        staging->shadow = staging->base;
+        if (staging->applied)
+            MapApply(gui, map, IMGUI_MAP_APPLY_FULL);
+        staging->dirty = 0;
+    }
+    else if (staging->dirty && MapParametersEqual(shadow, map) && !staging->applied)
+    {
+        // Dragged back to where it started, nothing to rebuild.
+        staging->dirty = 0;
+    }
+    else if (staging->dirty)
+    {
+        // Released, or held still for the debounce interval: one full rebuild.
+        bool settled = now - staging->lastEdit >= gui->map_debounce && !MapParametersEqual(shadow, map);
+        if (applyNow || !active || settled)
+        {
+            MapApply(gui, map, IMGUI_MAP_APPLY_FULL);
+        }
+        else if (gui->map_drag_apply != IMGUI_MAP_APPLY_OFF && now - staging->lastApply >= gui->map_debounce &&
+                 !MapParametersEqual(shadow, map))
+        {
+            MapApply(gui, map, gui->map_drag_apply);
+        }
+    }
+
+    imgui_open_next_tree();
+    if (ImGui::TreeNode("Preview"))
+    {
+        ShowMapPreview(shadow);
+        ImGui::TreePop();
+    }
+
+    ImGui::End();
+}
+
+#define METRIC_MAX_BUCKETS 2048
+
+// Min/max band with the average on top, one segment per bucket.
+static void ShowMetricPlot(unsigned int index, unsigned int history, float height)
+{
+    static thread_local imgui_metric_bucket_t buckets[METRIC_MAX_BUCKETS];
+    ImVec2 origin = ImGui::GetCursorScreenPos();
+    ImVec2 size = ImVec2(ImGui::GetContentRegionAvail().x, height);
+    size.x = size.x < 200.0f ? 200.0f : size.x;
+    ImGui::InvisibleButton("Plot", size);
+    bool hovered = ImGui::IsItemHovered();
+    ImDrawList *drawList = ImGui::GetWindowDrawList();
+    drawList->AddRectFilled(origin, ImVec2(origin.x + size.x, origin.y + size.y), ImGui::GetColorU32(ImGuiCol_FrameBg));
+
+    unsigned int maxBuckets = (unsigned int)size.x < METRIC_MAX_BUCKETS ? (unsigned int)size.x : METRIC_MAX_BUCKETS;
+    unsigned int numBuckets = imgui_metric_decimate(index, history, buckets, maxBuckets);
+    if (numBuckets == 0)
+        return;
 
-                ImGui::TreePop();
-            }
-        }
-        ImGui::TreePop();
+    float minValue = FLT_MAX, maxValue = -FLT_MAX;
+    double sum = 0.0;
+    for (unsigned int b = 0; b < numBuckets; b++)
+    {
+        minValue = buckets[b].min < minValue ? buckets[b].min : minValue;
+        maxValue = buckets[b].max > maxValue ? buckets[b].max : maxValue;
+        sum += buckets[b].avg;
     }
-    ImGui::Text("NumAnimMeshes: %u", mesh->mNumAnimMeshes);
-    if (mesh->mAnimMeshes != NULL && ImGui::TreeNode("Mesh Animeshes"))
+    float range = maxValue - minValue > 1e-6f ? maxValue - minValue : 1.0f;
+    float stepX = size.x / (float)numBuckets;
+    ImU32 bandColor = ImGui::GetColorU32(ImGuiCol_PlotLines, 0.35f);
+    ImU32 lineColor = ImGui::GetColorU32(ImGuiCol_PlotLines);
+
+    drawList->PushClipRect(origin, ImVec2(origin.x + size.x, origin.y + size.y), true);
+    for (unsigned int b = 0; b < numBuckets; b++)
     {
-        for (unsigned int i = 0; i < mesh->mNumAnimMeshes; i++)
-        {
-            if (mesh->mAnimMeshes[i] != NULL && ImGui::TreeNode((void *)(intptr_t)i, "AnimMesh[%d]", i))
-            {
+        float x = origin.x + (b + 0.5f) * stepX;
+        float y0 = origin.y + size.y - (buckets[b].min - minValue) / range * size.y;
+        float y1 = origin.y + size.y - (buckets[b].max - minValue) / range * size.y;
+        drawList->AddLine(ImVec2(x, y0), ImVec2(x, y1 - 1.0f), bandColor);
+        drawList->PathLineTo(ImVec2(x, origin.y + size.y - (buckets[b].avg - minValue) / range * size.y));
+    }
+    drawList->PathStroke(lineColor, ImDrawFlags_None, 1.0f);
+    drawList->PopClipRect();
 
-                ImGui::TreePop();
-            }
-        }
-        ImGui::TreePop();
+    ImGui::Text("last %.3f  min %.3f  max %.3f  avg %.3f", buckets[numBuckets - 1].avg, minValue, maxValue, sum / numBuckets);
+    if (hovered)
+    {
+        unsigned int b = (unsigned int)((ImGui::GetIO().MousePos.x - origin.x) / stepX);
+        b = b < numBuckets ? b : numBuckets - 1;
+        ImGui::SetTooltip("min %.3f\nmax %.3f\navg %.3f", buckets[b].min, buckets[b].max, buckets[b].avg);
     }
 }
-void ShowAiMaterial(aiMaterial *mesh) {}
-void ShowAiAnimation(aiAnimation *mesh) {}
-void ShowAiTexture(aiTexture *mesh) {}
-void ShowAiLights(aiLight *mesh) {}
-void ShowAiCameras(aiCamera *mesh) {}
-void ShowAiSkeletons(aiSkeleton *mesh) {}
 
-void ShowAiScene(const aiScene *scene)
+void ShowMetricsToolWindow(bool *p_open)
 {
-    if (ImGui::TreeNode("SceneFlags"))
+    if (!ImGui::Begin("Metrics Tool Window", p_open))
     {
-        bool scene_incomplete = AI_SCENE_FLAGS_INCOMPLETE & scene->mFlags;
-        bool scene_validated = AI_SCENE_FLAGS_VALIDATED & scene->mFlags;
-        bool scene_validationWarning = AI_SCENE_FLAGS_VALIDATION_WARNING & scene->mFlags;
-        bool scene_non_verbode_format = AI_SCENE_FLAGS_NON_VERBOSE_FORMAT & scene->mFlags;
-        bool scene_terrain = AI_SCENE_FLAGS_TERRAIN & scene->mFlags;
-        bool scene_allow_shared = AI_SCENE_FLAGS_ALLOW_SHARED & scene->mFlags;
-        ImGui::BeginDisabled();
-        ImGui::Checkbox("INCOMPLETE", &scene_incomplete);
-        ImGui::Checkbox("VALIDATED", &scene_validated);
-        ImGui::Checkbox("VALIDATON_WARNING", &scene_validationWarning);
-        ImGui::Checkbox("NON_VERBOSE_FORMAT", &scene_non_verbode_format);
-        ImGui::Checkbox("TERRAIN", &scene_terrain);
-        ImGui::Checkbox("ALLOW_SHARED", &scene_allow_shared);
-        ImGui::EndDisabled();
-        ImGui::Separator();
-
-        ImGui::TreePop();
+        ImGui::End();
+        return;
     }
-    ShowAiNode(scene->mRootNode);
-    if (scene->mMeshes != NULL && ImGui::TreeNode("Scene Meshes"))
+    static thread_local int history = 10000;
+    static thread_local float height = 80.0f;
+    ImGui::SliderInt("History", &history, 100, IMGUI_METRIC_CAPACITY - IMGUI_METRIC_CAPACITY / 16, "%d samples", ImGuiSliderFlags_Logarithmic);
+    ImGui::SliderFloat("Height", &height, 40.0f, 300.0f, "%.0f px");
+    ImGui::Separator();
+
+    unsigned int count = imgui_metric_count();
+    if (count == 0)
+        ImGui::TextDisabled("No metrics, see imgui_metric_push");
+    for (unsigned int i = 0; i < count; i++)
     {
-        for (unsigned int i = 0; i < scene->mNumMeshes; i++)
+        const char *name = imgui_metric_name(i);
+        ImGui::PushID((int)i);
+        imgui_open_next_tree();
+        if (ImGui::TreeNodeEx(name, ImGuiTreeNodeFlags_DefaultOpen, "%s (%llu)", name, imgui_metric_total(i)))
         {
-            ShowAiMesh(scene->mMeshes[i]);
+            ShowMetricPlot(i, (unsigned int)history, height);
+            ImGui::TreePop();
         }
-        ImGui::TreePop();
+        ImGui::PopID();
     }
-    if (scene->mMaterials != NULL && ImGui::TreeNode("Scene Materials"))
+    ImGui::End();
+}
+
+// Channel toggles, primitive budget and projection camera of the debug draw API.
+void ShowDebugDrawToolWindow(bool *p_open, nonstd_imgui_t *gui, unsigned int numCameras)
+{
+    if (!ImGui::Begin("Debug Draw Tool Window", p_open))
     {
-        for (unsigned int i = 0; i < scene->mNumMaterials; i++)
-        {
-            ShowAiMaterial(scene->mMaterials[i]);
-        }
-        ImGui::TreePop();
+        ImGui::End();
+        return;
     }
-    if (scene->mAnimations != NULL && ImGui::TreeNode("Scene Animations"))
+    if (numCameras == 0)
+        ImGui::TextDisabled("No cameras to project with");
+    else
+        ImGui::SliderInt("Camera", &(gui->debug_camera), -1, (int)numCameras - 1, gui->debug_camera < 0 ? "hidden" : "%d");
+    int budget = (int)imgui_debug_get_budget();
+    if (ImGui::DragInt("Budget", &budget, 64.0f, 0, 1 << 24, "%d primitives", ImGuiSliderFlags_AlwaysClamp))
+        imgui_debug_set_budget((unsigned int)budget);
+
+    const imgui_debug_stats_t *stats = imgui_debug_get_stats();
+    ImGui::Text("Threads: %u  drawn: %u  culled: %u", stats->threads, stats->drawn, stats->culled);
+    ImGui::Text("Over budget: %llu  lost: %llu  unregistered: %llu", stats->overBudget, stats->lost, stats->unregistered);
+    ImGui::Separator();
+
+    bool all = ImGui::Button("All");
+    ImGui::SameLine();
+    bool none = ImGui::Button("None");
+    if (ImGui::BeginTable("Channels", 4, ImGuiTableFlags_SizingStretchSame))
     {
-        for (unsigned int i = 0; i < scene->mNumAnimations; i++)
+        for (unsigned int c = 0; c < IMGUI_DEBUG_CHANNELS; c++)
         {
-            ShowAiAnimation(scene->mAnimations[i]);
+            if (all || none)
+                imgui_debug_enable(c, all);
+            ImGui::TableNextColumn();
+            const char *name = imgui_debug_get_channel_name(c);
+            bool enabled = imgui_debug_enabled(c);
+            ImGui::PushID((int)c);
+            if (ImGui::Checkbox(name != NULL ? name : imgui_frame_printf("Channel %u", c), &enabled))
+                imgui_debug_enable(c, enabled);
+            ImGui::PopID();
         }
-        ImGui::TreePop();
+        ImGui::EndTable();
     }
-    if (scene->mTextures != NULL && ImGui::TreeNode("Scene Textures"))
+    ImGui::End();
+}
+
+static float ProfilerFrameTime(void *data, int idx)
+{
+    unsigned int numFrames = *(unsigned int *)data;
+    const imgui_profiler_frame_t *frame = imgui_profiler_get_frame(numFrames - 1 - idx);
+    return frame == NULL ? 0.0f : (float)((frame->end - frame->start) * 1000.0);
+}
+
+static float ProfilerGpuTime(void *data, int idx)
+{
+    unsigned int numFrames = *(unsigned int *)data;
+    const imgui_profiler_frame_t *frame = imgui_profiler_get_frame(numFrames - 1 - idx);
+    return frame == NULL || frame->gpuTime < 0.0 ? 0.0f : (float)(frame->gpuTime * 1000.0);
+}
+
+void ShowProfilerTimeline(const imgui_profiler_frame_t *frame)
+{
+    const float rowHeight = ImGui::GetTextLineHeightWithSpacing();
+    int maxDepth = 0;
+    for (unsigned int i = 0; i < frame->numScopes; i++)
+        maxDepth = frame->scopes[i].depth > maxDepth ? frame->scopes[i].depth : maxDepth;
+
+    ImVec2 origin = ImGui::GetCursorScreenPos();
+    float width = ImGui::GetContentRegionAvail().x;
+    if (width < 300.0f)
+        width = 300.0f;
+    ImVec2 size = ImVec2(width, rowHeight * (maxDepth + 1));
+    ImGui::InvisibleButton("Timeline", size);
+    bool hovered = ImGui::IsItemHovered();
+    ImVec2 mouse = ImGui::GetIO().MousePos;
+
+    ImDrawList *drawList = ImGui::GetWindowDrawList();
+    drawList->AddRectFilled(origin, ImVec2(origin.x + size.x, origin.y + size.y), ImGui::GetColorU32(ImGuiCol_FrameBg));
+
+    double duration = frame->end - frame->start;
+    if (duration <= 0.0)
+        return;
+    float scale = (float)(size.x / duration);
+    for (unsigned int i = 0; i < frame->numScopes; i++)
     {
-        for (unsigned int i = 0; i < scene->mNumTextures; i++)
-        {
-            ShowAiTexture(scene->mTextures[i]);
-        }
-        ImGui::TreePop();
+        const imgui_profiler_scope_t *scope = &(frame->scopes[i]);
+        ImVec2 p0 = ImVec2(origin.x + (float)(scope->start - frame->start) * scale, origin.y + scope->depth * rowHeight);
+        ImVec2 p1 = ImVec2(origin.x + (float)(scope->end - frame->start) * scale, p0.y + rowHeight - 1.0f);
+        if (p1.x - p0.x < 1.0f)
+            p1.x = p0.x + 1.0f;
+        ImU32 color = ImColor::HSV((float)(i % 8) / 8.0f, 0.5f, 0.7f);
+        drawList->AddRectFilled(p0, p1, color);
+        drawList->PushClipRect(p0, p1, true);
+        drawList->AddText(ImVec2(p0.x + 2.0f, p0.y), IM_COL32_WHITE, scope->name);
+        drawList->PopClipRect();
+
+        if (hovered && mouse.x >= p0.x && mouse.x < p1.x && mouse.y >= p0.y && mouse.y < p1.y)
+            ImGui::SetTooltip("%s: %.3f ms", scope->name, (scope->end - scope->start) * 1000.0);
     }
-    if (scene->mLights != NULL && ImGui::TreeNode("Scene Lights"))
+}
+
+#define REPLAY_PATH_MAX 256
+
+static void ShowInputReplay(imgui_tool_options_t *tool_options)
+{
+    static thread_local char logPath[REPLAY_PATH_MAX] = "imgui_input.log";
+    static thread_local char reportPath[REPLAY_PATH_MAX] = "imgui_replay.csv";
+    static thread_local int lastError = 0;
+
+    bool idle = !imgui_recording() && !imgui_replay_active();
+    ImGui::BeginDisabled(!idle);
+    ImGui::InputText("Log", logPath, sizeof(logPath));
+    ImGui::EndDisabled();
+    if (imgui_recording())
     {
-        for (unsigned int i = 0; i < scene->mNumLights; i++)
-        {
-            ShowAiLights(scene->mLights[i]);
-        }
-        ImGui::TreePop();
+        ImGui::Text("Recording: %u frames", imgui_record_frames());
+        ImGui::SameLine();
+        if (ImGui::Button("Stop"))
+            lastError = imgui_record_end();
     }
-    if (scene->mCameras != NULL && ImGui::TreeNode("Scene Cameras"))
+    else if (imgui_replay_active())
     {
-        for (unsigned int i = 0; i < scene->mNumCameras; i++)
-        {
-            ShowAiCameras(scene->mCameras[i]);
-        }
-        ImGui::TreePop();
+        unsigned int total = 0;
+        unsigned int done = imgui_replay_progress(&total);
+        ImGui::ProgressBar(total > 0 ? (float)done / (float)total : 0.0f, ImVec2(-FLT_MIN, 0), imgui_frame_printf("Replaying frame %u", imgui_replay_num_frames()));
+        if (ImGui::Button("Stop"))
+            imgui_replay_end();
     }
-    if (scene->mSkeletons != NULL && ImGui::TreeNode("Scene Skeletons"))
+    else
     {
-        for (unsigned int i = 0; i < scene->mNumSkeletons; i++)
-        {
-            ShowAiSkeletons(scene->mSkeletons[i]);
-        }
-        ImGui::TreePop();
+        if (ImGui::Button("Record"))
+            lastError = imgui_record_begin(logPath, tool_options);
+        ImGui::SameLine();
+        if (ImGui::Button("Replay"))
+            lastError = imgui_replay_begin(logPath, tool_options);
     }
-    showAiMetadata("Metadata", scene->mMetaData);
+    if (lastError)
+        ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "Could not open or read %s", logPath);
+
+    imgui_replay_summary_t summary;
+    imgui_replay_summarize(&summary);
+    if (summary.frames == 0)
+        return;
+    ImGui::Text("%u frames  CPU ms mean %.3f  p50 %.3f  p95 %.3f  max %.3f", summary.frames, summary.cpuMean, summary.cpuP50, summary.cpuP95, summary.cpuMax);
+    if (summary.gpuMean >= 0.0f)
+        ImGui::Text("GPU ms mean %.3f", summary.gpuMean);
+    ImGui::Text("Draw calls mean %.1f  max %u", summary.drawCallsMean, summary.drawCallsMax);
+    ImGui::InputText("Report", reportPath, sizeof(reportPath));
+    ImGui::SameLine();
+    if (ImGui::Button("Write"))
+        lastError = imgui_replay_write_report(reportPath);
 }
 
-void ShowMapToolWindow(bool *p_open, map_t *map)
+void ShowProfilerToolWindow(bool *p_open, imgui_tool_options_t *tool_options)
 {
-    if (!ImGui::Begin("Map Tool Window", p_open, ImGuiWindowFlags_AlwaysAutoResize))
+    if (!ImGui::Begin("Profiler Tool Window", p_open))
     {
         ImGui::End();
         return;
     }
-    static ImGuiSliderFlags flags = ImGuiSliderFlags_None;
+    static thread_local int selectedFrame = 0;
 
-    ImGui::DragFloat("source_Ellipsoid.a", &(map->source_Ellipsoid.a), 0.005f, -FLT_MAX, FLT_MAX, "%f", flags);
-    ImGui::DragFloat("source_Ellipsoid.b", &(map->source_Ellipsoid.b), 0.005f, -FLT_MAX, FLT_MAX, "%f", flags);
-    ImGui::Separator();
-    ImGui::DragFloat("target_Ellipsoid.a", &(map->target_Ellipsoid.a), 0.005f, -FLT_MAX, FLT_MAX, "%f", flags);
-    ImGui::DragFloat("target_Ellipsoid.b", &(map->target_Ellipsoid.b), 0.005f, -FLT_MAX, FLT_MAX, "%f", flags);
-    ImGui::Separator();
+    unsigned int numFrames = imgui_profiler_num_frames();
+    const imgui_profiler_frame_t *last = imgui_profiler_get_frame(0);
+    if (last == NULL)
+    {
+        ImGui::Text("No frames recorded");
+        ImGui::End();
+        return;
+    }
 
-    ImGui::DragInt("source_projection.type", &(map->source_projection.type), 1.0F, 0, 1, "%d", flags);
-    ImGui::DragFloat("source_projection.p1", &(map->source_projection.p1), 0.005f, -FLT_MAX, FLT_MAX, "%f", flags);
-    ImGui::DragFloat("source_projection.p2", &(map->source_projection.p2), 0.005f, -FLT_MAX, FLT_MAX, "%f", flags);
-    ImGui::DragFloat("source_projection.p3", &(map->source_projection.p3), 0.005f, -FLT_MAX, FLT_MAX, "%f", flags);
-    ImGui::DragFloat("source_projection.p4", &(map->source_projection.p4), 0.005f, -FLT_MAX, FLT_MAX, "%f", flags);
-    ImGui::DragFloat("source_projection.p5", &(map->source_projection.p5), 0.005f, -FLT_MAX, FLT_MAX, "%f", flags);
-    ImGui::DragFloat("source_projection.p6", &(map->source_projection.p6), 0.005f, -FLT_MAX, FLT_MAX, "%f", flags);
-    ImGui::DragFloat("source_projection.p7", &(map->source_projection.p7), 0.005f, -FLT_MAX, FLT_MAX, "%f", flags);
+    ImGui::Text("CPU: %.3f ms", (last->end - last->start) * 1000.0);
+    ImGui::SameLine();
+    if (last->gpuTime >= 0.0)
+        ImGui::Text("GPU: %.3f ms", last->gpuTime * 1000.0);
+    else
+        ImGui::Text("GPU: pending");
+    ImGui::PlotLines("CPU ms", ProfilerFrameTime, &numFrames, (int)numFrames, 0, NULL, 0.0f, FLT_MAX, ImVec2(0, 60));
+    ImGui::PlotLines("GPU ms", ProfilerGpuTime, &numFrames, (int)numFrames, 0, NULL, 0.0f, FLT_MAX, ImVec2(0, 60));
+    const imgui_renderer_stats_t *rendererStats = imgui_renderer_get_stats();
+    ImGui::Text("Renderer: %s", rendererStats->streaming ? "persistent ring" : "stock OpenGL3");
+    if (rendererStats->streaming)
+        ImGui::Text("Uploaded: %llu bytes, %u draw calls, %u stalls, %u resizes", rendererStats->bytes, rendererStats->drawCalls, rendererStats->stalls, rendererStats->resizes);
+    const imgui_alloc_stats_t *allocStats = imgui_alloc_get_stats();
+    ImGui::Text("Allocations: %u per frame, %u from the heap", allocStats->frameAllocs, allocStats->frameHeapAllocs);
+    ImGui::Text("Pool: %.1f KiB in use, %.1f KiB peak, %.1f KiB reserved", allocStats->bytesInUse / 1024.0, allocStats->peakBytes / 1024.0, allocStats->reservedBytes / 1024.0);
+    ImGui::Text("String arena: %.1f KiB peak of %.1f KiB", allocStats->arenaPeak / 1024.0, allocStats->arenaCapacity / 1024.0);
+    const imgui_font_cache_stats_t *fontStats = imgui_font_cache_get_stats();
+    ImGui::Text("Font atlas: %s in %.1f ms", !fontStats->enabled ? "baked, no cache" : (fontStats->hit ? "mapped from cache" : "baked and cached"), fontStats->seconds * 1000.0);
+    imgui_open_next_tree();
+    if (ImGui::TreeNode("Input Replay"))
+    {
+        ShowInputReplay(tool_options);
+        ImGui::TreePop();
+    }
     ImGui::Separator();
-    ImGui::DragInt("target_projection.type", &(map->target_projection.type), 1.0F, 0, 1, "%d", flags);
-    ImGui::DragFloat("target_projection.p1", &(map->target_projection.p1), 0.005f, -FLT_MAX, FLT_MAX, "%f", flags);
-    ImGui::DragFloat("target_projection.p2", &(map->target_projection.p2), 0.005f, -FLT_MAX, FLT_MAX, "%f", flags);
-    ImGui::DragFloat("target_projection.p3", &(map->target_projection.p3), 0.005f, -FLT_MAX, FLT_MAX, "%f", flags);
-    ImGui::DragFloat("target_projection.p4", &(map->target_projection.p4), 0.005f, -FLT_MAX, FLT_MAX, "%f", flags);
-    ImGui::DragFloat("target_projection.p5", &(map->target_projection.p5), 0.005f, -FLT_MAX, FLT_MAX, "%f", flags);
-    ImGui::DragFloat("target_projection.p6", &(map->target_projection.p6), 0.005f, -FLT_MAX, FLT_MAX, "%f", flags);
-    ImGui::DragFloat("target_projection.p7", &(map->target_projection.p7), 0.005f, -FLT_MAX, FLT_MAX, "%f", flags);
+
+    ImGui::SliderInt("Frames Ago", &selectedFrame, 0, (int)numFrames - 1);
+    const imgui_profiler_frame_t *frame = imgui_profiler_get_frame((unsigned int)selectedFrame);
+    if (frame != NULL)
+        ShowProfilerTimeline(frame);
     ImGui::Separator();
 
+    // Averages over the whole ring, keyed by the scope name pointer (names are string literals).
+    const char *names[IMGUI_PROFILER_MAX_SCOPES];
+    double totals[IMGUI_PROFILER_MAX_SCOPES];
+    double peaks[IMGUI_PROFILER_MAX_SCOPES];
+    int depths[IMGUI_PROFILER_MAX_SCOPES];
+    unsigned int numNames = 0;
+    for (unsigned int f = 0; f < numFrames; f++)
+    {
+        const imgui_profiler_frame_t *fr = imgui_profiler_get_frame(f);
+        for (unsigned int i = 0; i < fr->numScopes; i++)
+        {
+            const imgui_profiler_scope_t *scope = &(fr->scopes[i]);
+            unsigned int n = 0;
+            while (n < numNames && names[n] != scope->name)
+                n++;
+            if (n == numNames)
+            {
+                if (numNames == IMGUI_PROFILER_MAX_SCOPES)
+                    continue;
+                names[n] = scope->name;
+                totals[n] = 0.0;
+                peaks[n] = 0.0;
+                depths[n] = scope->depth;
+                numNames++;
+            }
+            double t = scope->end - scope->start;
+            totals[n] += t;
+            peaks[n] = t > peaks[n] ? t : peaks[n];
+        }
+    }
+
+    if (ImGui::BeginTable("Profiler Scopes", 3, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersOuter | ImGuiTableFlags_BordersV))
+    {
+        ImGui::TableSetupColumn("Scope");
+        ImGui::TableSetupColumn("Avg ms");
+        ImGui::TableSetupColumn("Max ms");
+        ImGui::TableHeadersRow();
+        for (unsigned int n = 0; n < numNames; n++)
+        {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Indent(depths[n] * ImGui::GetStyle().IndentSpacing + 1.0f);
+            ImGui::TextUnformatted(names[n]);
+            ImGui::Unindent(depths[n] * ImGui::GetStyle().IndentSpacing + 1.0f);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", totals[n] * 1000.0 / numFrames);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", peaks[n] * 1000.0);
+        }
+        ImGui::EndTable();
+    }
+
     ImGui::End();
 }
 
@@ -666,6 +3092,8 @@ void ShowMainMenu(imgui_main_menu_options_t *menu_options)
         ShowClosePopUp(&(menu_options->file_options));
     if (menu_options->tool_options.show_tool_metrics)
         ImGui::ShowMetricsWindow((bool *)&(menu_options->tool_options.show_tool_metrics));
+    if (menu_options->tool_options.show_tool_profiler)
+        ShowProfilerToolWindow((bool *)&(menu_options->tool_options.show_tool_profiler), &(menu_options->tool_options));
     if (menu_options->tool_options.show_tool_debug_log)
         ImGui::ShowDebugLogWindow((bool *)&(menu_options->tool_options.show_tool_debug_log));
     if (menu_options->tool_options.show_tool_id_stack_tool)
@@ -740,8 +3168,8 @@ void ShowFileMenu(imgui_file_options_t *file_options)
         for (int i = 0; i < 10; i++)
             ImGui::Text("Scrolling Text %d", i);
         ImGui::EndChild();
-        static float f = 0.5f;
-        static int n = 0;
+        static thread_local float f = 0.5f;
+        static thread_local int n = 0;
         ImGui::SliderFloat("Value", &f, 0.0f, 1.0f);
         ImGui::InputFloat("Input", &f, 0.1f);
         ImGui::Combo("Combo", &n, "Yes\0No\0Maybe\0\0");
@@ -768,7 +3196,7 @@ void ShowFileMenu(imgui_file_options_t *file_options)
     // In a real code-base using it would make senses to use this feature from very different code locations.
     if (ImGui::BeginMenu("Options")) // <-- Append!
     {
-        static bool b = true;
+        static thread_local bool b = true;
         ImGui::Checkbox("SomeOption", &b);
         ImGui::EndMenu();
     }
@@ -793,6 +3221,7 @@ void ShowTools(imgui_tool_options_t *tool_options)
     {
         const bool has_debug_tools = true;
         ImGui::MenuItem("Metrics/Debugger", NULL, (bool *)&(tool_options->show_tool_metrics), has_debug_tools);
+        ImGui::MenuItem("Profiler", NULL, (bool *)&(tool_options->show_tool_profiler), has_debug_tools);
         ImGui::MenuItem("Debug Log", NULL, (bool *)&(tool_options->show_tool_debug_log), has_debug_tools);
         ImGui::MenuItem("ID Stack Tool", NULL, (bool *)&(tool_options->show_tool_id_stack_tool), has_debug_tools);
         ImGui::MenuItem("Style Editor", NULL, (bool *)&(tool_options->show_tool_style_editor));
@@ -804,6 +3233,10 @@ void ShowTools(imgui_tool_options_t *tool_options)
         ImGui::MenuItem("Camera_tool", NULL, (bool *)&(tool_options->show_camera_tool), has_debug_tools);
         ImGui::MenuItem("Task_Queue_tool", NULL, (bool *)&(tool_options->show_task_queue_tool), has_debug_tools);
         ImGui::MenuItem("Map_tool", NULL, (bool *)&(tool_options->show_map_tool), has_debug_tools);
+        ImGui::MenuItem("Scene_tool", NULL, (bool *)&(tool_options->show_scene_tool), has_debug_tools);
+        ImGui::MenuItem("Metrics_tool", NULL, (bool *)&(tool_options->show_metrics_tool), has_debug_tools);
+        ImGui::MenuItem("Search_tool", NULL, (bool *)&(tool_options->show_search_tool), has_debug_tools);
+        ImGui::MenuItem("Debug_draw_tool", NULL, (bool *)&(tool_options->show_debug_draw_tool), has_debug_tools);
 
         ImGui::EndMenu();
     }
@@ -856,7 +3289,37 @@ void ShowClosePopUp(imgui_file_options_t *file_options)
     }
 }
 
-int imgui_draw(
+int imgui_start_frame()
+{
+    imgui_profiler_begin_frame();
+    imgui_alloc_begin_frame();
+    imgui_thumbnail_begin_frame();
+
+    // Start the Dear ImGui frame
+    imgui_profiler_push("NewFrame");
+    nonstd_imgui_t *gui = currentGui;
+    ImGui_ImplOpenGL3_NewFrame();
+    if (gui == NULL || !gui->threaded)
+        ImGui_ImplGlfw_NewFrame();
+    // The main thread queues events and, for threaded GUIs, runs the GLFW half of
+    // the frame under the same lock.
+    imgui_input_lock(gui);
+    if (gui != NULL && gui->threaded)
+    {
+        double now = glfwGetTime();
+        float dt = gui->frame_time > 0.0 ? (float)(now - gui->frame_time) : 1.0f / 60.0f;
+        ImGui::GetIO().DeltaTime = dt > 0.0f ? dt : 1e-5f;
+        gui->frame_time = now;
+    }
+    imgui_replay_new_frame();
+    ImGui::NewFrame();
+    imgui_input_unlock(gui);
+    imgui_profiler_pop();
+
+    return 0;
+}
+
+int imgui_build_frame(
     nonstd_imgui_t *gui,
     task_queue_t *tq,
     unsigned int numCameras,
@@ -865,51 +3328,410 @@ int imgui_draw(
     model_t *modelList,
     map_t *map)
 {
-
-    ImGuiIO &io = ImGui::GetIO();
-
-    // Start the Dear ImGui frame
-    ImGui_ImplOpenGL3_NewFrame();
-    ImGui_ImplGlfw_NewFrame();
-    ImGui::NewFrame();
+    if (tq != NULL)
+        imgui_metric_push("task_queue.depth", (float)imgui_tq_depth(tq));
+    imgui_task_reap(glfwGetTime());
 
     // imgui draw calls
+    imgui_profiler_push("Windows");
     if (gui->paused)
     {
+        imgui_profiler_push("ShowMainMenu");
         ShowMainMenu(&gui->options);
+        imgui_profiler_pop();
     }
 
     if (gui->options.tool_options.show_task_queue_tool)
+    {
+        imgui_profiler_push("ShowTQToolWindow");
         ShowTQToolWindow((bool *)&(gui->options.tool_options.show_task_queue_tool), tq);
+        imgui_profiler_pop();
+    }
     if (gui->options.tool_options.show_camera_tool)
+    {
+        imgui_profiler_push("ShowCameraToolWindow");
         ShowCameraToolWindow((bool *)&(gui->options.tool_options.show_camera_tool), numCameras, cameraList);
+        imgui_profiler_pop();
+    }
     if (gui->options.tool_options.show_model_tool)
+    {
+        imgui_profiler_push("ShowModelToolWindow");
         ShowModelToolWindow((bool *)&(gui->options.tool_options.show_model_tool), numModels, modelList);
+        imgui_profiler_pop();
+    }
     if (gui->options.tool_options.show_map_tool)
-        ShowMapToolWindow((bool *)&(gui->options.tool_options.show_map_tool), map);
+    {
+        imgui_profiler_push("ShowMapToolWindow");
+        ShowMapToolWindow((bool *)&(gui->options.tool_options.show_map_tool), gui, map);
+        imgui_profiler_pop();
+    }
+    if (gui->options.tool_options.show_scene_tool)
+    {
+        imgui_profiler_push("ShowSceneToolWindow");
+        ShowSceneToolWindow((bool *)&(gui->options.tool_options.show_scene_tool), gui->numScenes, gui->sceneList, tq);
+        imgui_profiler_pop();
+    }
+    if (gui->options.tool_options.show_metrics_tool)
+    {
+        imgui_profiler_push("ShowMetricsToolWindow");
+        ShowMetricsToolWindow((bool *)&(gui->options.tool_options.show_metrics_tool));
+        imgui_profiler_pop();
+    }
+    if (gui->options.tool_options.show_search_tool)
+    {
+        imgui_profiler_push("ShowSearchToolWindow");
+        imgui_search_update(tq, numModels, modelList, gui->numScenes, gui->sceneList);
+        ShowSearchToolWindow((bool *)&(gui->options.tool_options.show_search_tool), &(gui->options.tool_options));
+        imgui_profiler_pop();
+    }
+    if (gui->options.tool_options.show_debug_draw_tool)
+    {
+        imgui_profiler_push("ShowDebugDrawToolWindow");
+        ShowDebugDrawToolWindow((bool *)&(gui->options.tool_options.show_debug_draw_tool), gui, numCameras);
+        imgui_profiler_pop();
+    }
+    searchNav.frames -= searchNav.frames > 0;
+    imgui_profiler_pop();
+
+    if (gui->debug_camera >= 0 && (unsigned int)gui->debug_camera < numCameras)
+    {
+        imgui_profiler_push("DebugDraw");
+        imgui_debug_render(&(cameraList[gui->debug_camera]));
+        imgui_profiler_pop();
+    }
+
+    // Anything still animating keeps the next frames from being skipped.
+    ImGuiIO &io = ImGui::GetIO();
+    gui->idle_busy = ImGui::IsAnyItemActive() || io.WantTextInput || gui->options.tool_options.show_tool_profiler || gui->options.tool_options.show_tool_metrics ||
+                     gui->options.tool_options.show_task_queue_tool || gui->options.tool_options.show_metrics_tool || imgui_search_get_stats()->building > 0 ||
+                     imgui_bone_analysis_pending() > 0;
 
     // Rendering
+    imgui_profiler_push("Render");
     ImGui::Render();
-    ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+    imgui_profiler_pop();
+
+    return 0;
+}
+
+int imgui_end_frame()
+{
+    ImGuiIO &io = ImGui::GetIO();
+
+    imgui_profiler_push("InstanceFlush");
+    imgui_instance_flush();
+    imgui_profiler_pop();
+
+    imgui_profiler_push("TextureFlush");
+    imgui_thumbnail_flush();
+    AiTextureBatchRun(&aiTexturePending);
+    imgui_profiler_pop();
+
+    imgui_profiler_push("RenderDrawData");
+    imgui_profiler_gpu_begin();
+    imgui_renderer_render(ImGui::GetDrawData());
+    imgui_profiler_gpu_end();
+    imgui_profiler_pop();
     if (io.ConfigFlags & ImGuiConfigFlags_ViewportsEnable)
     {
+        imgui_profiler_push("PlatformWindows");
         GLFWwindow *backup_current_context = glfwGetCurrentContext();
         ImGui::UpdatePlatformWindows();
         ImGui::RenderPlatformWindowsDefault();
         glfwMakeContextCurrent(backup_current_context);
+        imgui_profiler_pop();
     }
 
+    imgui_profiler_end_frame();
+    imgui_replay_end_frame();
+    const imgui_profiler_frame_t *frame = imgui_profiler_get_frame(0);
+    if (frame != NULL)
+        imgui_metric_push("imgui.frame_ms", (float)((frame->end - frame->start) * 1000.0));
     return 0;
 }
 
-int imgui_capture_key()
+// Owned copy of a frame's ImDrawData. The draw lists are kept between frames
+// so their buffers only grow and steady state copies do not allocate. The instance
+// uploads and thumbnail work are only emptied by the renderer, so a frame that was
+// replaced before it was drawn hands them on to the next one published into its slot.
+typedef struct imgui_frame_snapshot_s
 {
-    ImGuiIO &io = ImGui::GetIO();
-    return io.WantCaptureKeyboard;
+    ImDrawData drawData;
+    ImVector<ImDrawList *> lists;
+    struct imgui_instance_batch_s *instances;
+    struct imgui_thumbnail_batch_s *thumbnails;
+    struct imgui_ai_texture_batch_s *aiTextures;
+} imgui_frame_snapshot_t;
+
+// Triple buffer, one per GUI: the UI thread fills snapshots[backIndex] and swaps it
+// with the shared slot, the render thread swaps its snapshots[frontIndex] for the
+// shared slot when a new frame is flagged. Bits 0-1 of sharedState hold the shared
+// index, bit 2 is set while that slot holds a frame the renderer has not taken.
+#define IMGUI_SNAPSHOT_FRESH 4
+
+typedef struct imgui_frame_exchange_s
+{
+    imgui_frame_snapshot_t snapshots[3];
+    int sharedState;
+    int backIndex;
+    int frontIndex;
+    int hasFront;
+} imgui_frame_exchange_t;
+
+static imgui_frame_exchange_t *imgui_exchange_create()
+{
+    imgui_frame_exchange_t *exchange = IM_NEW(imgui_frame_exchange_t)();
+    exchange->sharedState = 1;
+    exchange->backIndex = 0;
+    exchange->frontIndex = 2;
+    exchange->hasFront = 0;
+    for (int s = 0; s < 3; s++)
+    {
+        exchange->snapshots[s].instances = imgui_instance_batch_create();
+        exchange->snapshots[s].thumbnails = imgui_thumbnail_batch_create();
+        exchange->snapshots[s].aiTextures = AiTextureBatchCreate();
+    }
+    return exchange;
+}
+
+static void imgui_exchange_destroy(imgui_frame_exchange_t *exchange)
+{
+    if (exchange == NULL)
+        return;
+    for (int s = 0; s < 3; s++)
+    {
+        for (int i = 0; i < exchange->snapshots[s].lists.Size; i++)
+            IM_DELETE(exchange->snapshots[s].lists[i]);
+        exchange->snapshots[s].lists.clear();
+        exchange->snapshots[s].drawData.CmdLists.clear();
+        imgui_instance_batch_destroy(exchange->snapshots[s].instances);
+        imgui_thumbnail_batch_destroy(exchange->snapshots[s].thumbnails);
+        AiTextureBatchDestroy(exchange->snapshots[s].aiTextures);
+    }
+    IM_DELETE(exchange);
+}
+
+template <typename T>
+static void CopyImVector(ImVector<T> &dst, const ImVector<T> &src)
+{
+    dst.resize(src.Size);
+    if (src.Size > 0)
+        memcpy(dst.Data, src.Data, (size_t)src.size_in_bytes());
+}
+
+int imgui_publish_frame()
+{
+    imgui_frame_exchange_t *exchange = currentGui != NULL ? currentGui->exchange : NULL;
+    ImDrawData *src = ImGui::GetDrawData();
+    if (exchange == NULL || src == NULL || !src->Valid)
+    {
+        imgui_profiler_end_frame();
+        imgui_replay_end_frame();
+        return 1;
+    }
+
+    imgui_profiler_push("PublishFrame");
+    imgui_frame_snapshot_t *snapshot = &(exchange->snapshots[exchange->backIndex]);
+    while (snapshot->lists.Size < src->CmdListsCount)
+        snapshot->lists.push_back(IM_NEW(ImDrawList)(ImGui::GetDrawListSharedData()));
+
+    snapshot->drawData.CmdLists.resize(src->CmdListsCount);
+    for (int i = 0; i < src->CmdListsCount; i++)
+    {
+        const ImDrawList *srcList = src->CmdLists[i];
+        ImDrawList *dstList = snapshot->lists[i];
+        CopyImVector(dstList->CmdBuffer, srcList->CmdBuffer);
+        CopyImVector(dstList->IdxBuffer, srcList->IdxBuffer);
+        CopyImVector(dstList->VtxBuffer, srcList->VtxBuffer);
+        dstList->Flags = srcList->Flags;
+        snapshot->drawData.CmdLists[i] = dstList;
+    }
+    snapshot->drawData.Valid = true;
+    snapshot->drawData.CmdListsCount = src->CmdListsCount;
+    snapshot->drawData.TotalIdxCount = src->TotalIdxCount;
+    snapshot->drawData.TotalVtxCount = src->TotalVtxCount;
+    snapshot->drawData.DisplayPos = src->DisplayPos;
+    snapshot->drawData.DisplaySize = src->DisplaySize;
+    snapshot->drawData.FramebufferScale = src->FramebufferScale;
+    snapshot->drawData.OwnerViewport = src->OwnerViewport;
+    imgui_instance_take(snapshot->instances);
+    imgui_thumbnail_take(snapshot->thumbnails);
+    AiTextureBatchTake(snapshot->aiTextures);
+
+    int prev = __atomic_exchange_n(&(exchange->sharedState), exchange->backIndex | IMGUI_SNAPSHOT_FRESH, __ATOMIC_ACQ_REL);
+    exchange->backIndex = prev & 3;
+    imgui_profiler_pop();
+
+    imgui_profiler_end_frame();
+    imgui_replay_end_frame();
+    return 0;
+}
+
+int imgui_submit_frame()
+{
+    imgui_frame_exchange_t *exchange = currentGui != NULL ? currentGui->exchange : NULL;
+    if (exchange == NULL)
+        return 1;
+    if (__atomic_load_n(&(exchange->sharedState), __ATOMIC_ACQUIRE) & IMGUI_SNAPSHOT_FRESH)
+    {
+        int prev = __atomic_exchange_n(&(exchange->sharedState), exchange->frontIndex, __ATOMIC_ACQ_REL);
+        exchange->frontIndex = prev & 3;
+        exchange->hasFront = 1;
+        imgui_instance_upload(exchange->snapshots[exchange->frontIndex].instances);
+        imgui_thumbnail_run(exchange->snapshots[exchange->frontIndex].thumbnails);
+        AiTextureBatchRun(exchange->snapshots[exchange->frontIndex].aiTextures);
+    }
+    if (!exchange->hasFront)
+        return 1;
+
+    imgui_renderer_render(&(exchange->snapshots[exchange->frontIndex].drawData));
+    return 0;
+}
+
+// Seconds the GUI keeps rebuilding after the last input or data change, so
+// hover delays, popups and nav highlights get to settle.
+#define IMGUI_IDLE_WAKE_SECONDS 0.5
+
+// Also used by the camera table.
+unsigned long long imgui_hash_bytes(unsigned long long hash, const void *data, size_t size)
+{
+    // FNV-1a
+    const unsigned char *bytes = (const unsigned char *)data;
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+static unsigned long long HashWatchedData(
+    task_queue_t *tq,
+    unsigned int numCameras,
+    camera_t *cameraList,
+    unsigned int numModels,
+    model_t *modelList,
+    map_t *map)
+{
+    unsigned long long hash = 14695981039346656037ULL;
+    if (tq != NULL)
+    {
+        void *head = __atomic_load_n(&(tq->queue.head), __ATOMIC_RELAXED);
+        void *tail = __atomic_load_n(&(tq->queue.tail), __ATOMIC_RELAXED);
+        hash = imgui_hash_bytes(hash, &head, sizeof(head));
+        hash = imgui_hash_bytes(hash, &tail, sizeof(tail));
+    }
+    hash = imgui_hash_bytes(hash, &numCameras, sizeof(numCameras));
+    for (unsigned int i = 0; i < numCameras; i++)
+    {
+        hash = imgui_hash_bytes(hash, cameraList[i].mView, sizeof(mat4));
+        hash = imgui_hash_bytes(hash, cameraList[i].mProjection, sizeof(mat4));
+    }
+    hash = imgui_hash_bytes(hash, &numModels, sizeof(numModels));
+    hash = imgui_hash_bytes(hash, &modelList, sizeof(modelList));
+    if (map != NULL)
+    {
+        hash = imgui_hash_bytes(hash, &(map->source_Ellipsoid), sizeof(map->source_Ellipsoid));
+        hash = imgui_hash_bytes(hash, &(map->target_Ellipsoid), sizeof(map->target_Ellipsoid));
+        hash = imgui_hash_bytes(hash, &(map->source_projection), sizeof(map->source_projection));
+        hash = imgui_hash_bytes(hash, &(map->target_projection), sizeof(map->target_projection));
+    }
+    return hash;
+}
+
+void imgui_request_redraw(nonstd_imgui_t *gui)
+{
+    gui->idle_wake_until = glfwGetTime() + IMGUI_IDLE_WAKE_SECONDS;
 }
 
-int imgui_capture_mouse()
+// Returns 1 when nothing could have changed the GUI since the last built frame:
+// no queued input events, no resize, nothing animating and the watched data
+// (camera matrices, queue head/tail, map parameters) hashes the same.
+int imgui_frame_idle(
+    nonstd_imgui_t *gui,
+    task_queue_t *tq,
+    unsigned int numCameras,
+    camera_t *cameraList,
+    unsigned int numModels,
+    model_t *modelList,
+    map_t *map)
 {
+    ImGuiContext &g = *ImGui::GetCurrentContext();
     ImGuiIO &io = ImGui::GetIO();
-    return io.WantCaptureMouse;
-}
\ No newline at end of file
+    double now = glfwGetTime();
+    int active = 0;
+
+    imgui_input_lock(gui);
+    if (gui->idle_busy || g.InputEventsQueue.Size > 0 || imgui_replay_active())
+        active = 1;
+    if (gui->debug_camera >= 0 && (unsigned int)gui->debug_camera < numCameras && imgui_debug_pending())
+        active = 1;
+
+    if (gui->threaded)
+    {
+        // GLFW can only be asked from the main thread; imgui_platform_new_frame
+        // already stored the new size in io.
+        ImVec2 size = ImGui::GetMainViewport()->Size;
+        if (size.x != io.DisplaySize.x || size.y != io.DisplaySize.y)
+            active = 1;
+    }
+    else if (gui->window != NULL)
+    {
+        int w, h;
+        glfwGetWindowSize(gui->window, &w, &h);
+        if ((float)w != io.DisplaySize.x || (float)h != io.DisplaySize.y)
+            active = 1;
+    }
+    imgui_input_unlock(gui);
+
+    unsigned long long hash = HashWatchedData(tq, numCameras, cameraList, numModels, modelList, map);
+    if (hash != gui->watch_hash)
+    {
+        gui->watch_hash = hash;
+        active = 1;
+    }
+
+    if (active)
+        gui->idle_wake_until = now + IMGUI_IDLE_WAKE_SECONDS;
+    return now >= gui->idle_wake_until;
+}
+
+int imgui_draw(
+    nonstd_imgui_t *gui,
+    task_queue_t *tq,
+    unsigned int numCameras,
+    camera_t *cameraList,
+    unsigned int numModels,
+    model_t *modelList,
+    map_t *map)
+{
+    imgui_make_current(gui);
+    if (gui->idle_mode != IMGUI_IDLE_OFF && imgui_frame_idle(gui, tq, numCameras, cameraList, numModels, modelList, map))
+    {
+        ImDrawData *drawData = ImGui::GetDrawData();
+        if (gui->idle_mode == IMGUI_IDLE_REUSE && drawData != NULL && drawData->Valid)
+            imgui_renderer_render(drawData);
+        return 1;
+    }
+
+    imgui_start_frame();
+    imgui_build_frame(gui, tq, numCameras, cameraList, numModels, modelList, map);
+    imgui_end_frame();
+    return 0;
+}
+
+int imgui_capture_key(nonstd_imgui_t *gui)
+{
+    imgui_input_lock(gui);
+    int capture = gui->context->IO.WantCaptureKeyboard;
+    imgui_input_unlock(gui);
+    return capture;
+}
+
+int imgui_capture_mouse(nonstd_imgui_t *gui)
+{
+    imgui_input_lock(gui);
+    int capture = gui->context->IO.WantCaptureMouse;
+    imgui_input_unlock(gui);
+    return capture;
+}
@@ -0,0 +1,316 @@
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <imgui.h>
+
+#include <nonstd.h>
+#include <nonstd_glfw_opengl.h>
+#include <tile_map.h>
+#include "nonstd_imgui.h"
+
+// Size classes are 16 << n bytes including the block header, n < ALLOC_NUM_CLASSES.
+#define ALLOC_HEADER 16
+#define ALLOC_MIN_SHIFT 4
+#define ALLOC_NUM_CLASSES 13
+#define ALLOC_LARGE ALLOC_NUM_CLASSES
+#define ALLOC_SLAB_SIZE (1024 * 1024)
+// Arena blocks plus their headers fit the largest size class.
+#define ALLOC_ARENA_BLOCK (64 * 1024 - 64)
+
+typedef struct alloc_header_s
+{
+    uint32_t sizeClass;
+    uint32_t pad;
+    uint64_t size; // block size including the header
+} alloc_header_t;
+
+typedef struct alloc_free_s
+{
+    struct alloc_free_s *next;
+} alloc_free_t;
+
+typedef struct alloc_slab_s
+{
+    struct alloc_slab_s *next;
+    size_t size;
+} alloc_slab_t;
+
+typedef struct arena_block_s
+{
+    struct arena_block_s *next;
+    size_t capacity;
+    size_t used;
+    size_t pad; // keeps the data that follows 16 byte aligned
+} arena_block_t;
+
+// Each thread building frames has its own string arena.
+typedef struct frame_arena_s
+{
+    arena_block_t *first;   // blocks are kept across frames
+    arena_block_t *current; // block strings are currently taken from
+    unsigned long long bytes;
+    unsigned long long peak;
+    unsigned long long capacity;
+} frame_arena_t;
+
+typedef struct imgui_allocator_s
+{
+    int installed; // number of GUIs using the allocator
+    unsigned char lock;
+    alloc_free_t *freeLists[ALLOC_NUM_CLASSES];
+    alloc_slab_t *slabs;
+    char *slabCursor;
+    char *slabEnd;
+
+    unsigned int frameAllocs;
+    unsigned int frameHeapAllocs;
+    imgui_alloc_stats_t stats;
+
+    ImGuiMemAllocFunc previousAlloc;
+    ImGuiMemFreeFunc previousFree;
+    void *previousUser;
+} imgui_allocator_t;
+
+static imgui_allocator_t allocator;
+static thread_local frame_arena_t frameArena;
+static thread_local imgui_alloc_stats_t threadStats;
+
+// ImGui may allocate from the render thread while the UI thread builds a frame,
+// and every GUI's thread allocates from the same pool.
+static void alloc_lock()
+{
+    while (__atomic_test_and_set(&(allocator.lock), __ATOMIC_ACQUIRE))
+        ;
+}
+
+static void alloc_unlock()
+{
+    __atomic_clear(&(allocator.lock), __ATOMIC_RELEASE);
+}
+
+static void *alloc_heap(size_t size)
+{
+    allocator.frameHeapAllocs++;
+    allocator.stats.totalHeapAllocs++;
+    allocator.stats.reservedBytes += size;
+    return malloc(size);
+}
+
+static unsigned int alloc_size_class(size_t size)
+{
+    unsigned int sizeClass = 0;
+    while (sizeClass < ALLOC_NUM_CLASSES && ((size_t)1 << (sizeClass + ALLOC_MIN_SHIFT)) < size)
+        sizeClass++;
+    return sizeClass;
+}
+
+// Carves a block of the given class from the current slab, starting a new slab when full.
+static void *alloc_carve(size_t blockSize)
+{
+    if (allocator.slabCursor == NULL || (size_t)(allocator.slabEnd - allocator.slabCursor) < blockSize)
+    {
+        alloc_slab_t *slab = (alloc_slab_t *)alloc_heap(ALLOC_SLAB_SIZE);
+        if (slab == NULL)
+            return NULL;
+        slab->next = allocator.slabs;
+        slab->size = ALLOC_SLAB_SIZE;
+        allocator.slabs = slab;
+        allocator.slabCursor = (char *)slab + ALLOC_HEADER;
+        allocator.slabEnd = (char *)slab + ALLOC_SLAB_SIZE;
+    }
+    void *block = allocator.slabCursor;
+    allocator.slabCursor += blockSize;
+    return block;
+}
+
+static void *imgui_pool_alloc(size_t size, void *user_data)
+{
+    (void)user_data;
+    size_t needed = size + ALLOC_HEADER;
+    unsigned int sizeClass = alloc_size_class(needed);
+
+    alloc_lock();
+    allocator.frameAllocs++;
+    allocator.stats.totalAllocs++;
+    alloc_header_t *header = NULL;
+    size_t blockSize = 0;
+    if (sizeClass >= ALLOC_NUM_CLASSES)
+    {
+        blockSize = needed;
+        header = (alloc_header_t *)alloc_heap(blockSize);
+        sizeClass = ALLOC_LARGE;
+    }
+    else
+    {
+        blockSize = (size_t)1 << (sizeClass + ALLOC_MIN_SHIFT);
+        if (allocator.freeLists[sizeClass] != NULL)
+        {
+            header = (alloc_header_t *)allocator.freeLists[sizeClass];
+            allocator.freeLists[sizeClass] = allocator.freeLists[sizeClass]->next;
+        }
+        else
+        {
+            header = (alloc_header_t *)alloc_carve(blockSize);
+        }
+    }
+    if (header != NULL)
+    {
+        header->sizeClass = sizeClass;
+        header->size = blockSize;
+        allocator.stats.bytesInUse += blockSize;
+        if (allocator.stats.bytesInUse > allocator.stats.peakBytes)
+            allocator.stats.peakBytes = allocator.stats.bytesInUse;
+    }
+    alloc_unlock();
+    return header != NULL ? (char *)header + ALLOC_HEADER : NULL;
+}
+
+static void imgui_pool_free(void *ptr, void *user_data)
+{
+    (void)user_data;
+    if (ptr == NULL)
+        return;
+    alloc_header_t *header = (alloc_header_t *)((char *)ptr - ALLOC_HEADER);
+
+    alloc_lock();
+    allocator.stats.bytesInUse -= header->size;
+    if (header->sizeClass == ALLOC_LARGE)
+    {
+        allocator.stats.reservedBytes -= header->size;
+        free(header);
+    }
+    else
+    {
+        alloc_free_t *node = (alloc_free_t *)header;
+        node->next = allocator.freeLists[header->sizeClass];
+        allocator.freeLists[header->sizeClass] = node;
+    }
+    alloc_unlock();
+}
+
+// GUIs are created and destroyed on the GLFW main thread, so the count needs no lock.
+int imgui_alloc_install()
+{
+    if (allocator.installed++ > 0)
+        return 0;
+    memset(&allocator, 0, sizeof(allocator));
+    ImGui::GetAllocatorFunctions(&(allocator.previousAlloc), &(allocator.previousFree), &(allocator.previousUser));
+    ImGui::SetAllocatorFunctions(imgui_pool_alloc, imgui_pool_free, NULL);
+    allocator.installed = 1;
+    return 0;
+}
+
+// Frees the calling thread's string arena; each thread that built frames calls it
+// before the last imgui_alloc_cleanup.
+void imgui_alloc_thread_cleanup()
+{
+    arena_block_t *block = frameArena.first;
+    while (block != NULL)
+    {
+        arena_block_t *next = block->next;
+        IM_FREE(block);
+        block = next;
+    }
+    memset(&frameArena, 0, sizeof(frameArena));
+}
+
+// The last call must run after ImGui::DestroyContext of every GUI and after every
+// ImVector owned by this library has been cleared, slabs are returned to the heap here.
+int imgui_alloc_cleanup()
+{
+    if (allocator.installed == 0 || --allocator.installed > 0)
+        return 0;
+    imgui_alloc_thread_cleanup();
+    ImGui::SetAllocatorFunctions(allocator.previousAlloc, allocator.previousFree, allocator.previousUser);
+
+    alloc_slab_t *slab = allocator.slabs;
+    while (slab != NULL)
+    {
+        alloc_slab_t *next = slab->next;
+        free(slab);
+        slab = next;
+    }
+    memset(&allocator, 0, sizeof(allocator));
+    return 0;
+}
+
+void imgui_alloc_begin_frame()
+{
+    alloc_lock();
+    allocator.stats.frameAllocs = allocator.frameAllocs;
+    allocator.stats.frameHeapAllocs = allocator.frameHeapAllocs;
+    allocator.frameAllocs = 0;
+    allocator.frameHeapAllocs = 0;
+    allocator.stats.frames++;
+    alloc_unlock();
+
+    // Rewind the string arena, its blocks are reused by the next frame.
+    for (arena_block_t *block = frameArena.first; block != NULL; block = block->next)
+        block->used = 0;
+    frameArena.current = frameArena.first;
+    frameArena.bytes = 0;
+}
+
+char *imgui_frame_alloc(size_t size)
+{
+    size = (size + 15) & ~(size_t)15;
+    arena_block_t *block = frameArena.current;
+    while (block != NULL && block->capacity - block->used < size)
+        block = block->next;
+    if (block == NULL)
+    {
+        size_t capacity = size > ALLOC_ARENA_BLOCK ? size : ALLOC_ARENA_BLOCK;
+        block = (arena_block_t *)IM_ALLOC(sizeof(arena_block_t) + capacity);
+        if (block == NULL)
+            return NULL;
+        block->capacity = capacity;
+        block->used = 0;
+        // Append so earlier, partly used blocks keep their position in the chain.
+        block->next = NULL;
+        arena_block_t **link = &(frameArena.first);
+        while (*link != NULL)
+            link = &((*link)->next);
+        *link = block;
+        frameArena.capacity += capacity;
+    }
+    frameArena.current = block;
+    char *ptr = (char *)(block + 1) + block->used;
+    block->used += size;
+    frameArena.bytes += size;
+    if (frameArena.bytes > frameArena.peak)
+        frameArena.peak = frameArena.bytes;
+    return ptr;
+}
+
+const char *imgui_frame_printf(const char *fmt, ...)
+{
+    va_list args;
+    va_start(args, fmt);
+    int len = vsnprintf(NULL, 0, fmt, args);
+    va_end(args);
+    if (len < 0)
+        return "";
+
+    char *buffer = imgui_frame_alloc((size_t)len + 1);
+    if (buffer == NULL)
+        return "";
+    va_start(args, fmt);
+    vsnprintf(buffer, (size_t)len + 1, fmt, args);
+    va_end(args);
+    return buffer;
+}
+
+// Pool counters are shared by every GUI, the arena ones are the calling thread's.
+const imgui_alloc_stats_t *imgui_alloc_get_stats()
+{
+    alloc_lock();
+    threadStats = allocator.stats;
+    alloc_unlock();
+    threadStats.arenaBytes = frameArena.bytes;
+    threadStats.arenaPeak = frameArena.peak;
+    threadStats.arenaCapacity = frameArena.capacity;
+    return &(threadStats);
+}
@@ -0,0 +1,327 @@
+#include <float.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include <imgui.h>
+
+#include <nonstd.h>
+#include <nonstd_glfw_opengl.h>
+#include <tile_map.h>
+#include "nonstd_imgui.h"
+
+// Weight sums are accumulated in 16.16 fixed point so workers can add them atomically.
+#define BONE_WEIGHT_ONE 65536.0f
+#define BONE_NORMALIZED_EPSILON 0.01f
+
+typedef struct bone_job_s bone_job_t;
+
+typedef struct bone_chunk_s
+{
+    bone_job_t *job;
+    unsigned int firstBone;
+    unsigned int lastBone;
+} bone_chunk_t;
+
+// One allocation per analysed mesh. refs counts the cache plus every task still
+// queued, whoever drops the last reference frees the job, so imgui_cleanup never
+// has to wait for the workers.
+struct bone_job_s
+{
+    imgui_bone_analysis_t analysis;
+    const aiMesh *mesh;
+    unsigned long long key;
+    int refs;
+    int pending;
+    imgui_task_status_t *status;
+    unsigned int *weightSums;
+    bone_chunk_t chunks[IMGUI_BONE_TASKS];
+};
+
+static thread_local ImVector<bone_job_t *> boneJobs;
+// Analyses of every thread not finished yet, so idle GUIs keep redrawing their progress.
+static unsigned int bonePending = 0;
+static thread_local ImGuiStorage boneLookup; // mesh pointer -> index into boneJobs + 1
+
+static unsigned long long BoneKey(const aiMesh *mesh)
+{
+    unsigned long long key = 14695981039346656037ULL;
+    uintptr_t values[] = {(uintptr_t)mesh->mBones, (uintptr_t)mesh->mNumBones, (uintptr_t)mesh->mNumVertices};
+    for (unsigned int i = 0; i < sizeof(values) / sizeof(values[0]); i++)
+    {
+        key ^= (unsigned long long)values[i];
+        key *= 1099511628211ULL;
+    }
+    return key;
+}
+
+static void BoneJobFree(bone_job_t *job)
+{
+    free(job->analysis.bones);
+    free(job->analysis.order);
+    free(job->analysis.influences);
+    free(job->weightSums);
+    free(job);
+}
+
+static void BoneJobRelease(bone_job_t *job)
+{
+    if (__atomic_sub_fetch(&(job->refs), 1, __ATOMIC_ACQ_REL) == 0)
+        BoneJobFree(job);
+}
+
+// Per vertex pass, run by whichever bone task finishes last.
+static void BoneJobFinish(bone_job_t *job)
+{
+    imgui_bone_analysis_t *analysis = &(job->analysis);
+    unsigned int numVertices = analysis->numVertices;
+    unsigned int offsets[IMGUI_BONE_MAX_INFLUENCES + 1];
+    if (imgui_task_cancelled(job->status))
+    {
+        free(job->weightSums);
+        job->weightSums = NULL;
+        __atomic_store_n(&(analysis->state), IMGUI_BONE_ANALYSIS_CANCELLED, __ATOMIC_RELEASE);
+        imgui_task_end(job->status, IMGUI_TASK_CANCELLED);
+        __atomic_sub_fetch(&bonePending, 1, __ATOMIC_RELEASE);
+        return;
+    }
+    imgui_task_stage(job->status, "Vertices");
+
+    for (unsigned int v = 0; v < numVertices; v++)
+    {
+        unsigned int count = analysis->influences[v];
+        unsigned int bucket = count < IMGUI_BONE_MAX_INFLUENCES ? count : IMGUI_BONE_MAX_INFLUENCES;
+        analysis->influenceCount[bucket]++;
+        if (count > analysis->maxInfluences)
+            analysis->maxInfluences = count;
+        if (count > 0 && fabsf((float)job->weightSums[v] / BONE_WEIGHT_ONE - 1.0f) > BONE_NORMALIZED_EPSILON)
+            analysis->unnormalized++;
+    }
+
+    // Counting sort, most influences first.
+    unsigned int offset = 0;
+    for (int k = IMGUI_BONE_MAX_INFLUENCES; k >= 0; k--)
+    {
+        offsets[k] = offset;
+        offset += analysis->influenceCount[k];
+    }
+    for (unsigned int v = 0; v < numVertices; v++)
+    {
+        unsigned int count = analysis->influences[v];
+        unsigned int bucket = count < IMGUI_BONE_MAX_INFLUENCES ? count : IMGUI_BONE_MAX_INFLUENCES;
+        analysis->order[offsets[bucket]++] = v;
+    }
+
+    free(job->weightSums);
+    job->weightSums = NULL;
+    __atomic_store_n(&(analysis->state), IMGUI_BONE_ANALYSIS_DONE, __ATOMIC_RELEASE);
+    imgui_task_end(job->status, IMGUI_TASK_DONE);
+    __atomic_sub_fetch(&bonePending, 1, __ATOMIC_RELEASE);
+}
+
+static void *BoneAnalysisTask(void *args)
+{
+    bone_chunk_t *chunk = (bone_chunk_t *)args;
+    bone_job_t *job = chunk->job;
+    imgui_bone_analysis_t *analysis = &(job->analysis);
+    const aiMesh *mesh = job->mesh;
+    unsigned int outOfRange = 0;
+    double start = glfwGetTime();
+    imgui_task_begin(job->status);
+
+    for (unsigned int b = chunk->firstBone; b < chunk->lastBone && !imgui_task_cancelled(job->status); b++)
+    {
+        const aiBone *bone = mesh->mBones[b];
+        imgui_bone_stats_t *stats = &(analysis->bones[b]);
+        if (bone == NULL || bone->mWeights == NULL)
+            continue;
+
+        double sum = 0.0;
+        stats->numWeights = bone->mNumWeights;
+        stats->minWeight = FLT_MAX;
+        stats->maxWeight = -FLT_MAX;
+        for (unsigned int w = 0; w < bone->mNumWeights; w++)
+        {
+            unsigned int vertex = bone->mWeights[w].mVertexId;
+            float weight = bone->mWeights[w].mWeight;
+            stats->minWeight = weight < stats->minWeight ? weight : stats->minWeight;
+            stats->maxWeight = weight > stats->maxWeight ? weight : stats->maxWeight;
+            stats->zeroWeights += weight == 0.0f;
+            sum += weight;
+
+            float clamped = weight < 0.0f ? 0.0f : (weight > 1.0f ? 1.0f : weight);
+            int bucket = (int)(clamped * IMGUI_BONE_WEIGHT_BUCKETS);
+            stats->histogram[bucket < IMGUI_BONE_WEIGHT_BUCKETS ? bucket : IMGUI_BONE_WEIGHT_BUCKETS - 1]++;
+            if (weight != clamped || vertex >= analysis->numVertices)
+            {
+                outOfRange++;
+                if (vertex >= analysis->numVertices)
+                    continue;
+            }
+
+            // Zero weights do not influence the vertex.
+            if (weight != 0.0f)
+            {
+                unsigned char count = __atomic_load_n(&(analysis->influences[vertex]), __ATOMIC_RELAXED);
+                while (count < 255 && !__atomic_compare_exchange_n(&(analysis->influences[vertex]), &count, (unsigned char)(count + 1), true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                    ;
+                __atomic_fetch_add(&(job->weightSums[vertex]), (unsigned int)(clamped * BONE_WEIGHT_ONE + 0.5f), __ATOMIC_RELAXED);
+            }
+        }
+        stats->avgWeight = bone->mNumWeights > 0 ? (float)(sum / bone->mNumWeights) : 0.0f;
+        if (bone->mNumWeights == 0)
+            stats->minWeight = stats->maxWeight = 0.0f;
+        __atomic_fetch_add(&(analysis->processed), (unsigned long long)bone->mNumWeights, __ATOMIC_RELAXED);
+        imgui_task_advance(job->status, bone->mNumWeights, (unsigned long long)bone->mNumWeights * sizeof(aiVertexWeight));
+    }
+    __atomic_fetch_add(&(analysis->outOfRange), outOfRange, __ATOMIC_RELAXED);
+
+    // The acq_rel decrement makes every other chunk's writes visible to the last one.
+    if (__atomic_sub_fetch(&(job->pending), 1, __ATOMIC_ACQ_REL) == 0)
+        BoneJobFinish(job);
+    BoneJobRelease(job);
+    imgui_tq_record("imgui_bone_analysis", glfwGetTime() - start);
+    return NULL;
+}
+
+// Splits the bones into up to IMGUI_BONE_TASKS ranges with about the same number of weights.
+static unsigned int BoneJobSplit(bone_job_t *job)
+{
+    const aiMesh *mesh = job->mesh;
+    unsigned long long perChunk = job->analysis.numWeights / IMGUI_BONE_TASKS + 1;
+    unsigned int numChunks = 0;
+    unsigned long long weights = 0;
+    unsigned int first = 0;
+    for (unsigned int b = 0; b < job->analysis.numBones; b++)
+    {
+        weights += mesh->mBones[b] != NULL ? mesh->mBones[b]->mNumWeights : 0;
+        bool last = b + 1 == job->analysis.numBones;
+        if (last || (weights >= perChunk && numChunks < IMGUI_BONE_TASKS - 1))
+        {
+            job->chunks[numChunks].job = job;
+            job->chunks[numChunks].firstBone = first;
+            job->chunks[numChunks].lastBone = b + 1;
+            numChunks++;
+            first = b + 1;
+            weights = 0;
+        }
+    }
+    return numChunks;
+}
+
+static bone_job_t *BoneJobCreate(const aiMesh *mesh, unsigned long long key)
+{
+    bone_job_t *job = (bone_job_t *)calloc(1, sizeof(bone_job_t));
+    if (job == NULL)
+        return NULL;
+    job->mesh = mesh;
+    job->key = key;
+    job->status = imgui_task_claim("Bone analysis");
+    imgui_bone_analysis_t *analysis = &(job->analysis);
+    analysis->state = IMGUI_BONE_ANALYSIS_QUEUED;
+    analysis->numBones = mesh->mBones != NULL ? mesh->mNumBones : 0;
+    analysis->numVertices = mesh->mNumVertices;
+    for (unsigned int b = 0; b < analysis->numBones; b++)
+        analysis->numWeights += mesh->mBones[b] != NULL ? mesh->mBones[b]->mNumWeights : 0;
+
+    analysis->bones = (imgui_bone_stats_t *)calloc(analysis->numBones + 1, sizeof(imgui_bone_stats_t));
+    analysis->order = (unsigned int *)calloc(analysis->numVertices + 1, sizeof(unsigned int));
+    analysis->influences = (unsigned char *)calloc(analysis->numVertices + 1, sizeof(unsigned char));
+    job->weightSums = (unsigned int *)calloc(analysis->numVertices + 1, sizeof(unsigned int));
+    if (analysis->bones == NULL || analysis->order == NULL || analysis->influences == NULL || job->weightSums == NULL)
+    {
+        imgui_task_end(job->status, IMGUI_TASK_FAILED);
+        BoneJobFree(job);
+        return NULL;
+    }
+    imgui_task_progress(job->status, 0, analysis->numWeights, 0);
+    imgui_task_stage(job->status, "Weights");
+    return job;
+}
+
+const imgui_bone_analysis_t *imgui_bone_analysis_get(const struct aiMesh *mesh, task_queue_t *tq)
+{
+    if (mesh == NULL)
+        return NULL;
+    unsigned long long key = BoneKey(mesh);
+    ImGuiID id = (ImGuiID)(uintptr_t)mesh ^ (ImGuiID)((uintptr_t)mesh >> 32);
+    int index = boneLookup.GetInt(id, 0) - 1;
+    if (index >= 0 && boneJobs[index] != NULL && boneJobs[index]->mesh == mesh)
+    {
+        if (boneJobs[index]->key == key)
+            return &(boneJobs[index]->analysis);
+        // The mesh was edited or reloaded at the same address, start over.
+        BoneJobRelease(boneJobs[index]);
+        boneJobs[index] = NULL;
+    }
+
+    bone_job_t *job = BoneJobCreate(mesh, key);
+    if (job == NULL)
+        return NULL;
+    __atomic_add_fetch(&bonePending, 1, __ATOMIC_RELAXED);
+    if (index < 0 || boneJobs[index] != NULL)
+    {
+        index = boneJobs.Size;
+        boneJobs.push_back(NULL);
+        boneLookup.SetInt(id, index + 1);
+    }
+    boneJobs[index] = job;
+
+    unsigned int numChunks = BoneJobSplit(job);
+    if (numChunks == 0)
+    {
+        BoneJobFinish(job);
+        job->refs = 1;
+        return &(job->analysis);
+    }
+    job->pending = (int)numChunks;
+    job->refs = (int)numChunks + 1;
+    for (unsigned int c = 0; c < numChunks; c++)
+    {
+        if (tq == NULL)
+        {
+            BoneAnalysisTask(&(job->chunks[c]));
+            continue;
+        }
+        async_task_t task = {0};
+        task.funcName = "imgui_bone_analysis";
+        task.func = BoneAnalysisTask;
+        task.args = &(job->chunks[c]);
+        QUEUE_PUSH(tq->queue, task, 1);
+    }
+    return &(job->analysis);
+}
+
+unsigned int imgui_bone_analysis_pending()
+{
+    return __atomic_load_n(&bonePending, __ATOMIC_ACQUIRE);
+}
+
+void imgui_bone_analysis_forget(const struct aiMesh *mesh)
+{
+    ImGuiID id = (ImGuiID)(uintptr_t)mesh ^ (ImGuiID)((uintptr_t)mesh >> 32);
+    int index = boneLookup.GetInt(id, 0) - 1;
+    if (index < 0 || boneJobs[index] == NULL || boneJobs[index]->mesh != mesh)
+        return;
+    // Queued chunks still hold references, cancel them so they return quickly. A
+    // finished job no longer owns its status slot.
+    if (__atomic_load_n(&(boneJobs[index]->analysis.state), __ATOMIC_ACQUIRE) == IMGUI_BONE_ANALYSIS_QUEUED)
+        imgui_task_cancel(boneJobs[index]->status);
+    BoneJobRelease(boneJobs[index]);
+    boneJobs[index] = NULL;
+}
+
+void imgui_bone_analysis_cleanup()
+{
+    for (int i = 0; i < boneJobs.Size; i++)
+    {
+        if (boneJobs[i] != NULL)
+            BoneJobRelease(boneJobs[i]);
+    }
+    boneJobs.clear();
+    boneLookup.Clear();
+}
@@ -0,0 +1,357 @@
+#include <float.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include <imgui.h>
+
+#include <nonstd.h>
+#include <nonstd_glfw_opengl.h>
+#include <tile_map.h>
+#include "nonstd_imgui.h"
+
+#define CAMERA_TABLE_LINES 16
+#define CAMERA_MATRIX_TEXT 64
+
+unsigned long long imgui_hash_bytes(unsigned long long hash, const void *data, size_t size);
+
+// Formatted view/projection rows, rebuilt only when the matrices hash differently.
+typedef struct camera_cache_s
+{
+    unsigned long long hash;
+    char view[4][CAMERA_MATRIX_TEXT];
+    char projection[4][CAMERA_MATRIX_TEXT];
+} camera_cache_t;
+
+typedef struct camera_table_s
+{
+    const camera_t *cameras;
+    unsigned int numCameras;
+    ImVector<camera_cache_t> cache;
+    ImVector<unsigned int> order;
+    unsigned long long sortHash;
+    int selected;
+    unsigned long long formats;
+} camera_table_t;
+
+static thread_local camera_table_t cameraTable = {NULL, 0, {}, {}, 0, -1, 0};
+static thread_local const ImGuiTableSortSpecs *cameraSortSpecs = NULL;
+
+static void FormatMat4Rows(char rows[4][CAMERA_MATRIX_TEXT], mat4 matrix)
+{
+    for (int r = 0; r < 4; r++)
+        snprintf(rows[r], CAMERA_MATRIX_TEXT, "[%.3f,%.3f,%.3f,%.3f]", matrix[0][r], matrix[1][r], matrix[2][r], matrix[3][r]);
+}
+
+static camera_cache_t *GetCameraCache(camera_t *camera, unsigned int index)
+{
+    camera_cache_t *cache = &(cameraTable.cache[index]);
+    unsigned long long hash = imgui_hash_bytes(14695981039346656037ULL, camera->mView, sizeof(mat4));
+    hash = imgui_hash_bytes(hash, camera->mProjection, sizeof(mat4));
+    if (hash != cache->hash)
+    {
+        FormatMat4Rows(cache->view, camera->mView);
+        FormatMat4Rows(cache->projection, camera->mProjection);
+        cache->hash = hash;
+        cameraTable.formats++;
+    }
+    return cache;
+}
+
+static void ShowMat4Rows(const char *name, char rows[4][CAMERA_MATRIX_TEXT])
+{
+    ImGui::TextUnformatted(name);
+    for (int r = 0; r < 4; r++)
+        ImGui::TextUnformatted(rows[r]);
+}
+
+void ShowCamera(camera_t *camera, camera_cache_t *cache)
+{
+    static thread_local ImGuiSliderFlags flags = ImGuiSliderFlags_None;
+
+    ImGui::DragFloat("Sensitivity", &(camera->mMouseSensitivity), 0.005f, -FLT_MAX, FLT_MAX, "%f", flags);
+    ImGui::Separator();
+    ImGui::DragFloat("Pos X", &(camera->mPosition[0]), 0.005f, -FLT_MAX, FLT_MAX, "%.3f", flags);
+    ImGui::DragFloat("Pos Y", &(camera->mPosition[1]), 0.005f, -FLT_MAX, FLT_MAX, "%.3f", flags);
+    ImGui::DragFloat("Pos Z", &(camera->mPosition[2]), 0.005f, -FLT_MAX, FLT_MAX, "%.3f", flags);
+
+    ImGui::DragFloat("Pitch X", &(camera->mPitch), 0.05f, -180.0f, 180.0f, "%.3f", flags);
+    ImGui::DragFloat("Roll X", &(camera->mRoll), 0.05f, -180.0f, 180.0f, "%.3f", flags);
+    ImGui::DragFloat("Yaw X", &(camera->mYaw), 0.05f, -180.0f, 180.0f, "%.3f", flags);
+
+    ImGui::DragFloat("FOV", &(camera->mFOV), 0.05f, 0.0f, 180.0f, "%.3f", flags);
+    ImGui::Separator();
+
+    ImGui::Text("Front:  [%.3f,%.3f,%.3f]", camera->front[0], camera->front[1], camera->front[2]);
+    ImGui::Text("Woldup: [%.3f,%.3f,%.3f]", camera->mWorldUp[0], camera->mWorldUp[1], camera->mWorldUp[2]);
+    ImGui::Text("up:     [%.3f,%.3f,%.3f]", camera->up[0], camera->up[1], camera->up[2]);
+    ImGui::Separator();
+    ShowMat4Rows("View:", cache->view);
+    ImGui::Separator();
+    ShowMat4Rows("projection:", cache->projection);
+}
+
+static float CameraSortValue(const camera_t *camera, unsigned int index, int column)
+{
+    switch (column)
+    {
+    case 1:
+        return camera->mPosition[0];
+    case 2:
+        return camera->mPosition[1];
+    case 3:
+        return camera->mPosition[2];
+    case 4:
+        return camera->mYaw;
+    case 5:
+        return camera->mPitch;
+    case 6:
+        return camera->mFOV;
+    default:
+        return (float)index;
+    }
+}
+
+static int CompareCameras(const void *lhs, const void *rhs)
+{
+    unsigned int a = *(const unsigned int *)lhs;
+    unsigned int b = *(const unsigned int *)rhs;
+    for (int n = 0; n < cameraSortSpecs->SpecsCount; n++)
+    {
+        const ImGuiTableColumnSortSpecs *spec = &(cameraSortSpecs->Specs[n]);
+        float va = CameraSortValue(&(cameraTable.cameras[a]), a, spec->ColumnIndex);
+        float vb = CameraSortValue(&(cameraTable.cameras[b]), b, spec->ColumnIndex);
+        if (va != vb)
+        {
+            int result = va < vb ? -1 : 1;
+            return spec->SortDirection == ImGuiSortDirection_Descending ? -result : result;
+        }
+    }
+    return a < b ? -1 : (a > b ? 1 : 0);
+}
+
+// Hash of the sortable fields only, so moving cameras re-sort but nothing else does.
+static unsigned long long CameraSortHash(const camera_t *cameras, unsigned int numCameras)
+{
+    unsigned long long hash = 14695981039346656037ULL;
+    for (unsigned int i = 0; i < numCameras; i++)
+    {
+        hash = imgui_hash_bytes(hash, cameras[i].mPosition, sizeof(float) * 3);
+        hash = imgui_hash_bytes(hash, &(cameras[i].mYaw), sizeof(cameras[i].mYaw));
+        hash = imgui_hash_bytes(hash, &(cameras[i].mPitch), sizeof(cameras[i].mPitch));
+        hash = imgui_hash_bytes(hash, &(cameras[i].mFOV), sizeof(cameras[i].mFOV));
+    }
+    return hash;
+}
+
+static void SyncCameraTable(unsigned int numCameras, camera_t *cameras)
+{
+    camera_table_t *table = &cameraTable;
+    if (table->cameras == cameras && table->numCameras == numCameras)
+        return;
+    table->cameras = cameras;
+    table->numCameras = numCameras;
+    table->cache.resize((int)numCameras);
+    for (unsigned int i = 0; i < numCameras; i++)
+        table->cache[i].hash = 0;
+    table->order.resize((int)numCameras);
+    for (unsigned int i = 0; i < numCameras; i++)
+        table->order[i] = i;
+    table->sortHash = 0;
+    if (table->selected >= (int)numCameras)
+        table->selected = -1;
+}
+
+void ShowCameraTable(unsigned int numCameras, camera_t *cameras)
+{
+    camera_table_t *table = &cameraTable;
+    const ImGuiTableFlags tableFlags = ImGuiTableFlags_ScrollY | ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersOuter | ImGuiTableFlags_BordersV |
+                                       ImGuiTableFlags_Resizable | ImGuiTableFlags_Sortable | ImGuiTableFlags_SortMulti;
+    int lines = numCameras < CAMERA_TABLE_LINES ? (int)numCameras + 1 : CAMERA_TABLE_LINES;
+    if (!ImGui::BeginTable("Cameras", 7, tableFlags, ImVec2(0.0f, ImGui::GetTextLineHeightWithSpacing() * (lines + 1))))
+        return;
+    ImGui::TableSetupScrollFreeze(0, 1);
+    ImGui::TableSetupColumn("#", ImGuiTableColumnFlags_DefaultSort | ImGuiTableColumnFlags_WidthFixed);
+    ImGui::TableSetupColumn("X");
+    ImGui::TableSetupColumn("Y");
+    ImGui::TableSetupColumn("Z");
+    ImGui::TableSetupColumn("Yaw");
+    ImGui::TableSetupColumn("Pitch");
+    ImGui::TableSetupColumn("FOV");
+    ImGui::TableHeadersRow();
+
+    ImGuiTableSortSpecs *specs = ImGui::TableGetSortSpecs();
+    if (specs != NULL)
+    {
+        bool byIndex = specs->SpecsCount == 1 && specs->Specs[0].ColumnIndex == 0 && specs->Specs[0].SortDirection == ImGuiSortDirection_Ascending;
+        unsigned long long hash = byIndex ? 0 : CameraSortHash(cameras, numCameras);
+        if (specs->SpecsDirty || hash != table->sortHash)
+        {
+            for (unsigned int i = 0; i < numCameras; i++)
+                table->order[i] = i;
+            if (!byIndex && numCameras > 1)
+            {
+                cameraSortSpecs = specs;
+                qsort(table->order.Data, numCameras, sizeof(unsigned int), CompareCameras);
+                cameraSortSpecs = NULL;
+            }
+            table->sortHash = hash;
+            specs->SpecsDirty = false;
+        }
+    }
+
+    ImGuiListClipper clipper;
+    clipper.Begin((int)numCameras);
+    while (clipper.Step())
+    {
+        for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; row++)
+        {
+            unsigned int index = table->order[row];
+            const camera_t *camera = &(cameras[index]);
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            if (ImGui::Selectable(imgui_frame_printf("%u", index), table->selected == (int)index, ImGuiSelectableFlags_SpanAllColumns))
+                table->selected = table->selected == (int)index ? -1 : (int)index;
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", camera->mPosition[0]);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", camera->mPosition[1]);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", camera->mPosition[2]);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.2f", camera->mYaw);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.2f", camera->mPitch);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.2f", camera->mFOV);
+        }
+    }
+    ImGui::EndTable();
+}
+
+// Top-down (XZ) view of every camera as one stroked path: position, left and right FOV edges.
+void ShowCameraFrustums(unsigned int numCameras, camera_t *cameras)
+{
+    camera_table_t *table = &cameraTable;
+    ImVec2 origin = ImGui::GetCursorScreenPos();
+    ImVec2 size = ImVec2(ImGui::GetContentRegionAvail().x, 240.0f);
+    size.x = size.x < 240.0f ? 240.0f : size.x;
+    ImGui::InvisibleButton("Frustums", size);
+    bool clicked = ImGui::IsItemClicked();
+    ImDrawList *drawList = ImGui::GetWindowDrawList();
+    drawList->AddRectFilled(origin, ImVec2(origin.x + size.x, origin.y + size.y), ImGui::GetColorU32(ImGuiCol_FrameBg));
+    if (numCameras == 0)
+        return;
+
+    float minX = FLT_MAX, minZ = FLT_MAX, maxX = -FLT_MAX, maxZ = -FLT_MAX;
+    for (unsigned int i = 0; i < numCameras; i++)
+    {
+        minX = cameras[i].mPosition[0] < minX ? cameras[i].mPosition[0] : minX;
+        maxX = cameras[i].mPosition[0] > maxX ? cameras[i].mPosition[0] : maxX;
+        minZ = cameras[i].mPosition[2] < minZ ? cameras[i].mPosition[2] : minZ;
+        maxZ = cameras[i].mPosition[2] > maxZ ? cameras[i].mPosition[2] : maxZ;
+    }
+    float extent = maxX - minX > maxZ - minZ ? maxX - minX : maxZ - minZ;
+    extent = extent > 1e-3f ? extent : 1.0f;
+    // Frustum length relative to the rig so both single cameras and large rigs stay readable.
+    float length = extent * (numCameras > 1 ? 0.15f : 0.5f);
+    float margin = length + extent * 0.05f;
+    float scaleX = size.x / (extent + 2.0f * margin), scaleY = size.y / (extent + 2.0f * margin);
+    float scale = scaleX < scaleY ? scaleX : scaleY;
+    ImVec2 center = ImVec2(origin.x + size.x * 0.5f, origin.y + size.y * 0.5f);
+    float midX = (minX + maxX) * 0.5f, midZ = (minZ + maxZ) * 0.5f;
+
+    ImVec2 mouse = ImGui::GetIO().MousePos;
+    float bestDistance = FLT_MAX;
+    int best = -1;
+    drawList->PushClipRect(origin, ImVec2(origin.x + size.x, origin.y + size.y), true);
+    for (unsigned int i = 0; i < numCameras; i++)
+    {
+        const camera_t *camera = &(cameras[i]);
+        ImVec2 p = ImVec2(center.x + (camera->mPosition[0] - midX) * scale, center.y + (camera->mPosition[2] - midZ) * scale);
+        float fx = camera->front[0], fz = camera->front[2];
+        float norm = sqrtf(fx * fx + fz * fz);
+        if (norm > 1e-6f)
+        {
+            fx /= norm;
+            fz /= norm;
+        }
+        else
+        {
+            fx = 0.0f;
+            fz = -1.0f;
+        }
+        float half = camera->mFOV * 0.5f * (float)(M_PI / 180.0);
+        float c = cosf(half), s = sinf(half);
+        float reach = length * scale / (c > 0.1f ? c : 0.1f);
+        ImVec2 left = ImVec2(p.x + (fx * c - fz * s) * reach, p.y + (fx * s + fz * c) * reach);
+        ImVec2 right = ImVec2(p.x + (fx * c + fz * s) * reach, p.y + (-fx * s + fz * c) * reach);
+
+        ImU32 color = (int)i == table->selected ? IM_COL32(255, 200, 64, 255) : IM_COL32(160, 200, 255, 160);
+        drawList->PathLineTo(p);
+        drawList->PathLineTo(left);
+        drawList->PathLineTo(right);
+        drawList->PathStroke(color, ImDrawFlags_Closed, 1.0f);
+
+        float dx = mouse.x - p.x, dy = mouse.y - p.y;
+        float distance = dx * dx + dy * dy;
+        if (distance < bestDistance)
+        {
+            bestDistance = distance;
+            best = (int)i;
+        }
+    }
+    drawList->PopClipRect();
+
+    if (best >= 0 && bestDistance < 64.0f && ImGui::IsItemHovered())
+    {
+        ImGui::SetTooltip("Camera %d", best);
+        if (clicked)
+            cameraTable.selected = best;
+    }
+}
+
+void imgui_camera_table_cleanup()
+{
+    cameraTable.cache.clear();
+    cameraTable.order.clear();
+    cameraTable.cameras = NULL;
+    cameraTable.numCameras = 0;
+    cameraTable.selected = -1;
+}
+
+void ShowCameraToolWindow(bool *p_open, unsigned int numCameras, camera_t *camera)
+{
+    if (!ImGui::Begin("Camera Tool Window", p_open))
+    {
+        ImGui::End();
+        return;
+    }
+    ImGui::Text("Camera Tool Window");
+    ImGui::Separator();
+    SyncCameraTable(numCameras, camera);
+    ImGui::Text("Cameras: %u  Matrix reformats: %llu", numCameras, cameraTable.formats);
+    ShowCameraTable(numCameras, camera);
+    imgui_open_next_tree();
+    if (ImGui::TreeNode("Frustums"))
+    {
+        ShowCameraFrustums(numCameras, camera);
+        ImGui::TreePop();
+    }
+
+    int selected = cameraTable.selected;
+    if (selected >= 0 && selected < (int)numCameras)
+    {
+        ImGui::SeparatorText("Selected Camera");
+        ImGui::PushID(selected);
+        ShowCamera(&(camera[selected]), GetCameraCache(&(camera[selected]), (unsigned int)selected));
+        ImGui::PopID();
+    }
+
+    ImGui::End();
+}
@@ -0,0 +1,216 @@
+#include <string.h>
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include <imgui.h>
+#include <imgui_internal.h>
+#include <imgui_impl_glfw.h>
+
+#include <nonstd.h>
+#include <nonstd_glfw_opengl.h>
+#include <tile_map.h>
+#include "nonstd_imgui.h"
+
+// ImGui reads its current context through GImGui, which nonstd_imconfig.h maps here.
+thread_local ImGuiContext *NonstdImGuiTLS = NULL;
+
+// Routes the events of one GLFW window to the GUI that owns it. The host's own
+// callbacks, installed before imgui_init, still run first.
+typedef struct imgui_window_s
+{
+    GLFWwindow *window;
+    nonstd_imgui_t *gui;
+    GLFWwindowfocusfun focus;
+    GLFWcursorenterfun cursorEnter;
+    GLFWcursorposfun cursorPos;
+    GLFWmousebuttonfun mouseButton;
+    GLFWscrollfun scroll;
+    GLFWkeyfun key;
+    GLFWcharfun character;
+} imgui_window_t;
+
+// Only touched on the GLFW main thread: imgui_init, imgui_cleanup and the callbacks.
+static imgui_window_t windows[IMGUI_MAX_WINDOWS];
+static unsigned int numWindows = 0;
+
+void imgui_input_lock(nonstd_imgui_t *gui)
+{
+    if (gui == NULL)
+        return;
+    while (__atomic_exchange_n(&(gui->input_lock), 1, __ATOMIC_ACQUIRE))
+        ;
+}
+
+void imgui_input_unlock(nonstd_imgui_t *gui)
+{
+    if (gui != NULL)
+        __atomic_store_n(&(gui->input_lock), 0, __ATOMIC_RELEASE);
+}
+
+static imgui_window_t *FindWindow(GLFWwindow *window)
+{
+    for (unsigned int i = 0; i < numWindows; i++)
+    {
+        if (windows[i].window == window)
+            return &(windows[i]);
+    }
+    return NULL;
+}
+
+// Events are queued into the owning GUI's context, whichever context the main
+// thread currently has, and under the input lock since its render thread may be
+// inside ImGui::NewFrame.
+static ImGuiContext *WindowInputBegin(nonstd_imgui_t *gui)
+{
+    ImGuiContext *previous = ImGui::GetCurrentContext();
+    imgui_input_lock(gui);
+    ImGui::SetCurrentContext(gui->context);
+    return previous;
+}
+
+static void WindowInputEnd(nonstd_imgui_t *gui, ImGuiContext *previous)
+{
+    ImGui::SetCurrentContext(previous);
+    imgui_input_unlock(gui);
+}
+
+static void WindowFocusCallback(GLFWwindow *window, int focused)
+{
+    imgui_window_t *entry = FindWindow(window);
+    if (entry == NULL)
+        return;
+    if (entry->focus != NULL)
+        entry->focus(window, focused);
+    ImGuiContext *previous = WindowInputBegin(entry->gui);
+    ImGui_ImplGlfw_WindowFocusCallback(window, focused);
+    WindowInputEnd(entry->gui, previous);
+}
+
+static void CursorEnterCallback(GLFWwindow *window, int entered)
+{
+    imgui_window_t *entry = FindWindow(window);
+    if (entry == NULL)
+        return;
+    if (entry->cursorEnter != NULL)
+        entry->cursorEnter(window, entered);
+    ImGuiContext *previous = WindowInputBegin(entry->gui);
+    ImGui_ImplGlfw_CursorEnterCallback(window, entered);
+    WindowInputEnd(entry->gui, previous);
+}
+
+static void CursorPosCallback(GLFWwindow *window, double x, double y)
+{
+    imgui_window_t *entry = FindWindow(window);
+    if (entry == NULL)
+        return;
+    if (entry->cursorPos != NULL)
+        entry->cursorPos(window, x, y);
+    ImGuiContext *previous = WindowInputBegin(entry->gui);
+    ImGui_ImplGlfw_CursorPosCallback(window, x, y);
+    WindowInputEnd(entry->gui, previous);
+}
+
+static void MouseButtonCallback(GLFWwindow *window, int button, int action, int mods)
+{
+    imgui_window_t *entry = FindWindow(window);
+    if (entry == NULL)
+        return;
+    if (entry->mouseButton != NULL)
+        entry->mouseButton(window, button, action, mods);
+    ImGuiContext *previous = WindowInputBegin(entry->gui);
+    ImGui_ImplGlfw_MouseButtonCallback(window, button, action, mods);
+    WindowInputEnd(entry->gui, previous);
+}
+
+static void ScrollCallback(GLFWwindow *window, double xoffset, double yoffset)
+{
+    imgui_window_t *entry = FindWindow(window);
+    if (entry == NULL)
+        return;
+    if (entry->scroll != NULL)
+        entry->scroll(window, xoffset, yoffset);
+    ImGuiContext *previous = WindowInputBegin(entry->gui);
+    ImGui_ImplGlfw_ScrollCallback(window, xoffset, yoffset);
+    WindowInputEnd(entry->gui, previous);
+}
+
+static void KeyCallback(GLFWwindow *window, int key, int scancode, int action, int mods)
+{
+    imgui_window_t *entry = FindWindow(window);
+    if (entry == NULL)
+        return;
+    if (entry->key != NULL)
+        entry->key(window, key, scancode, action, mods);
+    ImGuiContext *previous = WindowInputBegin(entry->gui);
+    ImGui_ImplGlfw_KeyCallback(window, key, scancode, action, mods);
+    WindowInputEnd(entry->gui, previous);
+}
+
+static void CharCallback(GLFWwindow *window, unsigned int c)
+{
+    imgui_window_t *entry = FindWindow(window);
+    if (entry == NULL)
+        return;
+    if (entry->character != NULL)
+        entry->character(window, c);
+    ImGuiContext *previous = WindowInputBegin(entry->gui);
+    ImGui_ImplGlfw_CharCallback(window, c);
+    WindowInputEnd(entry->gui, previous);
+}
+
+// Called by imgui_init after ImGui_ImplGlfw_InitForOpenGL(window, false).
+int imgui_window_install(nonstd_imgui_t *gui, GLFWwindow *window)
+{
+    if (numWindows >= IMGUI_MAX_WINDOWS)
+        return 1;
+    imgui_window_t *entry = &(windows[numWindows++]);
+    memset(entry, 0, sizeof(imgui_window_t));
+    entry->window = window;
+    entry->gui = gui;
+    entry->focus = glfwSetWindowFocusCallback(window, WindowFocusCallback);
+    entry->cursorEnter = glfwSetCursorEnterCallback(window, CursorEnterCallback);
+    entry->cursorPos = glfwSetCursorPosCallback(window, CursorPosCallback);
+    entry->mouseButton = glfwSetMouseButtonCallback(window, MouseButtonCallback);
+    entry->scroll = glfwSetScrollCallback(window, ScrollCallback);
+    entry->key = glfwSetKeyCallback(window, KeyCallback);
+    entry->character = glfwSetCharCallback(window, CharCallback);
+    return 0;
+}
+
+// Puts the host's callbacks back, called by imgui_cleanup.
+void imgui_window_uninstall(GLFWwindow *window)
+{
+    imgui_window_t *entry = FindWindow(window);
+    if (entry == NULL)
+        return;
+    glfwSetWindowFocusCallback(window, entry->focus);
+    glfwSetCursorEnterCallback(window, entry->cursorEnter);
+    glfwSetCursorPosCallback(window, entry->cursorPos);
+    glfwSetMouseButtonCallback(window, entry->mouseButton);
+    glfwSetScrollCallback(window, entry->scroll);
+    glfwSetKeyCallback(window, entry->key);
+    glfwSetCharCallback(window, entry->character);
+    *entry = windows[--numWindows];
+}
+
+void imgui_set_threaded(nonstd_imgui_t *gui, int threaded)
+{
+    gui->threaded = threaded;
+    if (!threaded)
+        return;
+    // Platform windows are created and drawn by the backend on the main thread.
+    gui->context->IO.ConfigFlags &= ~ImGuiConfigFlags_ViewportsEnable;
+    // The drawing thread's first NewFrame needs a display size.
+    imgui_platform_new_frame(gui);
+}
+
+// The GLFW half of a frame for a threaded GUI: display size, framebuffer scale,
+// mouse position and cursor and gamepads, all of which GLFW only allows on the
+// main thread. The drawing thread's imgui_start_frame sets the delta time.
+void imgui_platform_new_frame(nonstd_imgui_t *gui)
+{
+    ImGuiContext *previous = WindowInputBegin(gui);
+    ImGui_ImplGlfw_NewFrame();
+    WindowInputEnd(gui, previous);
+}
@@ -0,0 +1,486 @@
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include <imgui.h>
+
+#include <nonstd.h>
+#include <nonstd_glfw_opengl.h>
+#include <tile_map.h>
+#include "nonstd_imgui.h"
+
+#define DEBUG_PRIM_MASK (IMGUI_DEBUG_PRIMITIVES - 1)
+#define DEBUG_TEXT_MASK (IMGUI_DEBUG_TEXTS - 1)
+#define DEBUG_NEAR_W 1e-4f
+
+enum
+{
+    DEBUG_LINE = 0,
+    DEBUG_BOX,
+    DEBUG_POINT
+};
+
+// seq is the submission index + 1 once the entry is complete and 0 while the
+// producer writes it, so a reader that raced a wrap-around can tell.
+typedef struct debug_prim_s
+{
+    unsigned long long seq;
+    unsigned char type;
+    unsigned char channel;
+    unsigned short pad;
+    unsigned int color;
+    float a[3];
+    float b[3]; // b[0] is the radius of a point
+} debug_prim_t;
+
+typedef struct debug_text_s
+{
+    unsigned long long seq;
+    unsigned int channel;
+    unsigned int color;
+    float p[3];
+    char text[IMGUI_DEBUG_TEXT_MAX];
+} debug_text_t;
+
+// One per submitting thread. The owner is the only writer, so appending is a
+// handful of plain stores and two release stores. Readers never hold the owner
+// back: a full ring overwrites its oldest entries, and every GUI keeps its own read
+// position in its imgui_debug_reader_t.
+typedef struct debug_buffer_s
+{
+    int owned;
+    unsigned long long primHead;
+    unsigned long long textHead;
+    debug_prim_t prims[IMGUI_DEBUG_PRIMITIVES];
+    debug_text_t texts[IMGUI_DEBUG_TEXTS];
+} debug_buffer_t;
+
+typedef struct debug_draw_s
+{
+    unsigned int enabled; // channel bits
+    unsigned int budget;
+    unsigned int generation;
+    unsigned int numBuffers;
+    debug_buffer_t *buffers[IMGUI_DEBUG_MAX_THREADS];
+    const char *names[IMGUI_DEBUG_CHANNELS];
+    unsigned long long unregistered; // submissions dropped because every buffer was taken
+} debug_draw_t;
+
+static debug_draw_t debugDraw = {0xFFFFFFFFu, IMGUI_DEBUG_DEFAULT_BUDGET, 1, 0, {NULL}, {NULL}, 0};
+
+// Gives the buffer back for reuse when its thread exits.
+typedef struct debug_thread_s
+{
+    debug_buffer_t *buffer;
+    unsigned int generation;
+    ~debug_thread_s()
+    {
+        if (buffer != NULL && generation == __atomic_load_n(&(debugDraw.generation), __ATOMIC_ACQUIRE))
+            __atomic_store_n(&(buffer->owned), 0, __ATOMIC_RELEASE);
+    }
+} debug_thread_t;
+
+// One per GUI, so GUIs drawn by the same thread each see every primitive; bound
+// by imgui_debug_reader_bind, threads without a GUI use the default.
+typedef struct imgui_debug_reader_s
+{
+    unsigned int generation;
+    unsigned long long primTail[IMGUI_DEBUG_MAX_THREADS];
+    unsigned long long textTail[IMGUI_DEBUG_MAX_THREADS];
+    imgui_debug_stats_t stats;
+} imgui_debug_reader_t;
+
+static thread_local debug_thread_t debugThread;
+static imgui_debug_reader_t defaultReader;
+static thread_local imgui_debug_reader_t *reader = &defaultReader;
+
+// Takes over a buffer left by an exited thread, or adds one. Never blocks.
+static debug_buffer_t *DebugRegister()
+{
+    unsigned int generation = __atomic_load_n(&(debugDraw.generation), __ATOMIC_ACQUIRE);
+    unsigned int count = __atomic_load_n(&(debugDraw.numBuffers), __ATOMIC_ACQUIRE);
+    count = count < IMGUI_DEBUG_MAX_THREADS ? count : IMGUI_DEBUG_MAX_THREADS;
+    debug_buffer_t *buffer = NULL;
+    for (unsigned int i = 0; i < count && buffer == NULL; i++)
+    {
+        debug_buffer_t *candidate = __atomic_load_n(&(debugDraw.buffers[i]), __ATOMIC_ACQUIRE);
+        int expected = 0;
+        if (candidate != NULL && __atomic_compare_exchange_n(&(candidate->owned), &expected, 1, false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED))
+            buffer = candidate;
+    }
+    if (buffer == NULL)
+    {
+        unsigned int index = __atomic_fetch_add(&(debugDraw.numBuffers), 1, __ATOMIC_ACQ_REL);
+        if (index >= IMGUI_DEBUG_MAX_THREADS)
+            return NULL;
+        // Not the ImGui allocator: workers may submit before imgui_init or after imgui_cleanup.
+        buffer = (debug_buffer_t *)calloc(1, sizeof(debug_buffer_t));
+        if (buffer == NULL)
+            return NULL;
+        buffer->owned = 1;
+        __atomic_store_n(&(debugDraw.buffers[index]), buffer, __ATOMIC_RELEASE);
+    }
+    debugThread.buffer = buffer;
+    debugThread.generation = generation;
+    return buffer;
+}
+
+static debug_buffer_t *DebugBuffer(unsigned int channel)
+{
+    if (channel >= IMGUI_DEBUG_CHANNELS || !(__atomic_load_n(&(debugDraw.enabled), __ATOMIC_RELAXED) & (1u << channel)))
+        return NULL;
+    if (debugThread.buffer != NULL && debugThread.generation == __atomic_load_n(&(debugDraw.generation), __ATOMIC_RELAXED))
+        return debugThread.buffer;
+    debug_buffer_t *buffer = DebugRegister();
+    if (buffer == NULL)
+        __atomic_fetch_add(&(debugDraw.unregistered), 1, __ATOMIC_RELAXED);
+    return buffer;
+}
+
+static void DebugPush(unsigned int channel, int type, unsigned int color, const float *a, const float *b)
+{
+    debug_buffer_t *buffer = DebugBuffer(channel);
+    if (buffer == NULL)
+        return;
+    unsigned long long index = buffer->primHead;
+    debug_prim_t *prim = &(buffer->prims[index & DEBUG_PRIM_MASK]);
+    __atomic_store_n(&(prim->seq), 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    prim->type = (unsigned char)type;
+    prim->channel = (unsigned char)channel;
+    prim->color = color;
+    memcpy(prim->a, a, sizeof(prim->a));
+    memcpy(prim->b, b, sizeof(prim->b));
+    __atomic_store_n(&(prim->seq), index + 1, __ATOMIC_RELEASE);
+    __atomic_store_n(&(buffer->primHead), index + 1, __ATOMIC_RELEASE);
+}
+
+void imgui_debug_line(unsigned int channel, const float a[3], const float b[3], unsigned int color)
+{
+    DebugPush(channel, DEBUG_LINE, color, a, b);
+}
+
+void imgui_debug_box(unsigned int channel, const float min[3], const float max[3], unsigned int color)
+{
+    DebugPush(channel, DEBUG_BOX, color, min, max);
+}
+
+void imgui_debug_point(unsigned int channel, const float p[3], float radius, unsigned int color)
+{
+    float b[3] = {radius, 0.0f, 0.0f};
+    DebugPush(channel, DEBUG_POINT, color, p, b);
+}
+
+void imgui_debug_text(unsigned int channel, const float p[3], unsigned int color, const char *fmt, ...)
+{
+    debug_buffer_t *buffer = DebugBuffer(channel);
+    if (buffer == NULL)
+        return;
+    unsigned long long index = buffer->textHead;
+    debug_text_t *text = &(buffer->texts[index & DEBUG_TEXT_MASK]);
+    __atomic_store_n(&(text->seq), 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    text->channel = channel;
+    text->color = color;
+    memcpy(text->p, p, sizeof(text->p));
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(text->text, sizeof(text->text), fmt, args);
+    va_end(args);
+    __atomic_store_n(&(text->seq), index + 1, __ATOMIC_RELEASE);
+    __atomic_store_n(&(buffer->textHead), index + 1, __ATOMIC_RELEASE);
+}
+
+void imgui_debug_enable(unsigned int channel, int enabled)
+{
+    if (channel >= IMGUI_DEBUG_CHANNELS)
+        return;
+    if (enabled)
+        __atomic_fetch_or(&(debugDraw.enabled), 1u << channel, __ATOMIC_RELAXED);
+    else
+        __atomic_fetch_and(&(debugDraw.enabled), ~(1u << channel), __ATOMIC_RELAXED);
+}
+
+int imgui_debug_enabled(unsigned int channel)
+{
+    return channel < IMGUI_DEBUG_CHANNELS && (__atomic_load_n(&(debugDraw.enabled), __ATOMIC_RELAXED) & (1u << channel)) != 0;
+}
+
+void imgui_debug_channel_name(unsigned int channel, const char *name)
+{
+    if (channel < IMGUI_DEBUG_CHANNELS)
+        __atomic_store_n(&(debugDraw.names[channel]), name, __ATOMIC_RELEASE);
+}
+
+const char *imgui_debug_get_channel_name(unsigned int channel)
+{
+    return channel < IMGUI_DEBUG_CHANNELS ? __atomic_load_n(&(debugDraw.names[channel]), __ATOMIC_ACQUIRE) : NULL;
+}
+
+void imgui_debug_set_budget(unsigned int primitives)
+{
+    __atomic_store_n(&(debugDraw.budget), primitives, __ATOMIC_RELAXED);
+}
+
+unsigned int imgui_debug_get_budget()
+{
+    return __atomic_load_n(&(debugDraw.budget), __ATOMIC_RELAXED);
+}
+
+imgui_debug_reader_t *imgui_debug_reader_init()
+{
+    reader = IM_NEW(imgui_debug_reader_t)();
+    memset(reader, 0, sizeof(imgui_debug_reader_t));
+    return reader;
+}
+
+int imgui_debug_reader_cleanup()
+{
+    if (reader != &defaultReader)
+        IM_DELETE(reader);
+    reader = &defaultReader;
+    return 0;
+}
+
+void imgui_debug_reader_bind(imgui_debug_reader_t *bound)
+{
+    reader = bound != NULL ? bound : &defaultReader;
+}
+
+static void DebugReaderSync()
+{
+    unsigned int generation = __atomic_load_n(&(debugDraw.generation), __ATOMIC_ACQUIRE);
+    if (reader->generation != generation)
+    {
+        memset(reader, 0, sizeof(imgui_debug_reader_t));
+        reader->generation = generation;
+    }
+}
+
+static unsigned int DebugNumBuffers()
+{
+    unsigned int count = __atomic_load_n(&(debugDraw.numBuffers), __ATOMIC_ACQUIRE);
+    return count < IMGUI_DEBUG_MAX_THREADS ? count : IMGUI_DEBUG_MAX_THREADS;
+}
+
+// Any submission the current GUI has not drawn yet, for imgui_frame_idle.
+int imgui_debug_pending()
+{
+    DebugReaderSync();
+    unsigned int count = DebugNumBuffers();
+    for (unsigned int i = 0; i < count; i++)
+    {
+        debug_buffer_t *buffer = __atomic_load_n(&(debugDraw.buffers[i]), __ATOMIC_ACQUIRE);
+        if (buffer == NULL)
+            continue;
+        if (__atomic_load_n(&(buffer->primHead), __ATOMIC_ACQUIRE) != reader->primTail[i] ||
+            __atomic_load_n(&(buffer->textHead), __ATOMIC_ACQUIRE) != reader->textTail[i])
+            return 1;
+    }
+    return 0;
+}
+
+typedef struct debug_view_s
+{
+    float m[4][4]; // projection * view, column major like mat4
+    ImVec2 origin;
+    ImVec2 size;
+} debug_view_t;
+
+static void DebugTransform(const debug_view_t *view, const float p[3], float clip[4])
+{
+    for (int r = 0; r < 4; r++)
+        clip[r] = view->m[0][r] * p[0] + view->m[1][r] * p[1] + view->m[2][r] * p[2] + view->m[3][r];
+}
+
+static ImVec2 DebugScreen(const debug_view_t *view, const float clip[4])
+{
+    float x = clip[0] / clip[3], y = clip[1] / clip[3];
+    return ImVec2(view->origin.x + (x * 0.5f + 0.5f) * view->size.x, view->origin.y + (0.5f - y * 0.5f) * view->size.y);
+}
+
+// Clips the segment against the near plane (w > DEBUG_NEAR_W); returns false when
+// it is entirely behind the camera.
+static bool DebugLine(ImDrawList *drawList, const debug_view_t *view, const float a[3], const float b[3], ImU32 color)
+{
+    float ca[4], cb[4];
+    DebugTransform(view, a, ca);
+    DebugTransform(view, b, cb);
+    if (ca[3] <= DEBUG_NEAR_W && cb[3] <= DEBUG_NEAR_W)
+        return false;
+    if (ca[3] <= DEBUG_NEAR_W || cb[3] <= DEBUG_NEAR_W)
+    {
+        float *behind = ca[3] <= DEBUG_NEAR_W ? ca : cb;
+        const float *front = ca[3] <= DEBUG_NEAR_W ? cb : ca;
+        float t = (DEBUG_NEAR_W - behind[3]) / (front[3] - behind[3]);
+        for (int r = 0; r < 4; r++)
+            behind[r] += (front[r] - behind[r]) * t;
+    }
+    drawList->AddLine(DebugScreen(view, ca), DebugScreen(view, cb), color);
+    return true;
+}
+
+static bool DebugBox(ImDrawList *drawList, const debug_view_t *view, const float *min, const float *max, ImU32 color)
+{
+    float corners[8][3];
+    for (int i = 0; i < 8; i++)
+    {
+        corners[i][0] = (i & 1) ? max[0] : min[0];
+        corners[i][1] = (i & 2) ? max[1] : min[1];
+        corners[i][2] = (i & 4) ? max[2] : min[2];
+    }
+    static const unsigned char edges[12][2] = {{0, 1}, {2, 3}, {4, 5}, {6, 7}, {0, 2}, {1, 3}, {4, 6}, {5, 7}, {0, 4}, {1, 5}, {2, 6}, {3, 7}};
+    bool drawn = false;
+    for (int e = 0; e < 12; e++)
+        drawn |= DebugLine(drawList, view, corners[edges[e][0]], corners[edges[e][1]], color);
+    return drawn;
+}
+
+// Draws everything submitted since the current GUI's previous call into the background
+// draw list of the current ImGui context, projected through camera onto the main
+// viewport. Entries that were overwritten before they could be read are counted as
+// lost, the ones beyond the budget as over budget; both are skipped.
+void imgui_debug_render(const camera_t *camera)
+{
+    DebugReaderSync();
+    imgui_debug_stats_t stats;
+    memset(&stats, 0, sizeof(stats));
+    stats.unregistered = __atomic_load_n(&(debugDraw.unregistered), __ATOMIC_RELAXED);
+
+    debug_view_t view;
+    for (int c = 0; c < 4; c++)
+        for (int r = 0; r < 4; r++)
+            view.m[c][r] = camera->mProjection[0][r] * camera->mView[c][0] + camera->mProjection[1][r] * camera->mView[c][1] +
+                           camera->mProjection[2][r] * camera->mView[c][2] + camera->mProjection[3][r] * camera->mView[c][3];
+    ImGuiViewport *viewport = ImGui::GetMainViewport();
+    view.origin = viewport->Pos;
+    view.size = viewport->Size;
+    ImDrawList *drawList = ImGui::GetBackgroundDrawList();
+
+    unsigned int budget = __atomic_load_n(&(debugDraw.budget), __ATOMIC_RELAXED);
+    unsigned int enabled = __atomic_load_n(&(debugDraw.enabled), __ATOMIC_RELAXED);
+    unsigned int count = DebugNumBuffers();
+    for (unsigned int i = 0; i < count; i++)
+    {
+        debug_buffer_t *buffer = __atomic_load_n(&(debugDraw.buffers[i]), __ATOMIC_ACQUIRE);
+        if (buffer == NULL)
+            continue;
+        stats.threads += __atomic_load_n(&(buffer->owned), __ATOMIC_RELAXED) != 0;
+
+        unsigned long long head = __atomic_load_n(&(buffer->primHead), __ATOMIC_ACQUIRE);
+        unsigned long long tail = reader->primTail[i];
+        if (head - tail > IMGUI_DEBUG_PRIMITIVES)
+        {
+            stats.lost += head - tail - IMGUI_DEBUG_PRIMITIVES;
+            tail = head - IMGUI_DEBUG_PRIMITIVES;
+        }
+        for (; tail < head; tail++)
+        {
+            const debug_prim_t *entry = &(buffer->prims[tail & DEBUG_PRIM_MASK]);
+            if (__atomic_load_n(&(entry->seq), __ATOMIC_ACQUIRE) != tail + 1)
+            {
+                stats.lost++;
+                continue;
+            }
+            debug_prim_t prim = *entry;
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+            if (__atomic_load_n(&(entry->seq), __ATOMIC_RELAXED) != tail + 1)
+            {
+                stats.lost++;
+                continue;
+            }
+            if (!(enabled & (1u << prim.channel)))
+                continue;
+            if (stats.drawn >= budget)
+            {
+                stats.overBudget++;
+                continue;
+            }
+            bool drawn = false;
+            if (prim.type == DEBUG_LINE)
+                drawn = DebugLine(drawList, &view, prim.a, prim.b, prim.color);
+            else if (prim.type == DEBUG_BOX)
+                drawn = DebugBox(drawList, &view, prim.a, prim.b, prim.color);
+            else
+            {
+                float clip[4];
+                DebugTransform(&view, prim.a, clip);
+                drawn = clip[3] > DEBUG_NEAR_W;
+                if (drawn)
+                    drawList->AddCircleFilled(DebugScreen(&view, clip), prim.b[0], prim.color);
+            }
+            stats.drawn += drawn;
+            stats.culled += !drawn;
+        }
+        reader->primTail[i] = head;
+
+        head = __atomic_load_n(&(buffer->textHead), __ATOMIC_ACQUIRE);
+        tail = reader->textTail[i];
+        if (head - tail > IMGUI_DEBUG_TEXTS)
+        {
+            stats.lost += head - tail - IMGUI_DEBUG_TEXTS;
+            tail = head - IMGUI_DEBUG_TEXTS;
+        }
+        for (; tail < head; tail++)
+        {
+            const debug_text_t *entry = &(buffer->texts[tail & DEBUG_TEXT_MASK]);
+            if (__atomic_load_n(&(entry->seq), __ATOMIC_ACQUIRE) != tail + 1)
+            {
+                stats.lost++;
+                continue;
+            }
+            debug_text_t text = *entry;
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+            if (__atomic_load_n(&(entry->seq), __ATOMIC_RELAXED) != tail + 1)
+            {
+                stats.lost++;
+                continue;
+            }
+            if (!(enabled & (1u << text.channel)))
+                continue;
+            if (stats.drawn >= budget)
+            {
+                stats.overBudget++;
+                continue;
+            }
+            float clip[4];
+            DebugTransform(&view, text.p, clip);
+            if (clip[3] <= DEBUG_NEAR_W)
+            {
+                stats.culled++;
+                continue;
+            }
+            text.text[IMGUI_DEBUG_TEXT_MAX - 1] = '\0';
+            drawList->AddText(DebugScreen(&view, clip), text.color, text.text);
+            stats.drawn++;
+        }
+        reader->textTail[i] = head;
+    }
+    reader->stats = stats;
+}
+
+// Stats of the current GUI's last imgui_debug_render.
+const imgui_debug_stats_t *imgui_debug_get_stats()
+{
+    return &(reader->stats);
+}
+
+// Only safe once every producer has stopped submitting; threads that submit again
+// afterwards register a new buffer.
+void imgui_debug_cleanup()
+{
+    unsigned int count = DebugNumBuffers();
+    for (unsigned int i = 0; i < count; i++)
+    {
+        free(debugDraw.buffers[i]);
+        debugDraw.buffers[i] = NULL;
+    }
+    debugDraw.numBuffers = 0;
+    debugDraw.unregistered = 0;
+    debugThread.buffer = NULL;
+    __atomic_add_fetch(&(debugDraw.generation), 1, __ATOMIC_RELEASE);
+}
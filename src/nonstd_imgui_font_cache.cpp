@@ -0,0 +1,452 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include <imgui.h>
+#include <imgui_internal.h>
+
+#include <nonstd.h>
+#include <nonstd_glfw_opengl.h>
+#include <tile_map.h>
+#include "nonstd_imgui.h"
+
+#define FONT_CACHE_MAGIC "NIFC"
+#define FONT_CACHE_VERSION 1
+#define FONT_CACHE_ALIGN 64
+
+// The cached layout mirrors the static atlas of ImGui before 1.92; newer versions
+// build glyphs on demand and always bake.
+#if IMGUI_VERSION_NUM < 19200
+#define FONT_CACHE_SUPPORTED 1
+#else
+#define FONT_CACHE_SUPPORTED 0
+#endif
+
+typedef struct font_spec_s
+{
+    char *file;
+    float size;
+    ImWchar *ranges;
+} font_spec_t;
+
+typedef struct font_cache_header_s
+{
+    char magic[4];
+    uint32_t version;
+    uint64_t key;
+    uint64_t size;
+    uint64_t pixelsOffset;
+    int32_t texWidth;
+    int32_t texHeight;
+    int32_t bytesPerPixel; // 1 for alpha8, 4 when the atlas has colored glyphs
+    int32_t numFonts;
+    int32_t numRects;
+    int32_t numLines;
+    int32_t packIdMouseCursor;
+    int32_t packIdLines;
+    float uvScale[2];
+    float uvWhitePixel[2];
+} font_cache_header_t;
+
+typedef struct font_cache_font_s
+{
+    float fontSize;
+    float ascent;
+    float descent;
+    float scale;
+    float ellipsisWidth;
+    float ellipsisCharStep;
+    uint32_t fallbackChar;
+    uint32_t ellipsisChar;
+    int32_t ellipsisCharCount;
+    int32_t metricsTotalSurface;
+    int32_t numGlyphs;
+    int32_t pad;
+} font_cache_font_t;
+
+// Registration happens before imgui_init installs the pooled allocator, so specs use malloc.
+typedef struct font_cache_s
+{
+    font_spec_t fonts[IMGUI_FONT_MAX];
+    unsigned int numFonts;
+    char *path;
+
+    void *mapping;
+    size_t mappingSize;
+    double start;
+    imgui_font_cache_stats_t stats;
+} font_cache_t;
+
+static font_cache_t fontCache;
+
+static unsigned long long FontHash(unsigned long long hash, const void *data, size_t size)
+{
+    const unsigned char *bytes = (const unsigned char *)data;
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+int imgui_font_add(const char *file, float size, const unsigned int *ranges)
+{
+    if (file == NULL || size <= 0.0f || fontCache.numFonts >= IMGUI_FONT_MAX)
+        return 1;
+    font_spec_t *spec = &(fontCache.fonts[fontCache.numFonts]);
+    spec->file = strdup(file);
+    spec->size = size;
+    spec->ranges = NULL;
+    if (ranges != NULL)
+    {
+        unsigned int count = 0;
+        while (ranges[count] != 0)
+            count++;
+        spec->ranges = (ImWchar *)malloc((count + 1) * sizeof(ImWchar));
+        for (unsigned int i = 0; i < count; i++)
+            spec->ranges[i] = (ImWchar)ranges[i];
+        spec->ranges[count] = 0;
+    }
+    fontCache.numFonts++;
+    return 0;
+}
+
+void imgui_font_cache_path(const char *path)
+{
+    free(fontCache.path);
+    fontCache.path = path != NULL ? strdup(path) : NULL;
+}
+
+// File contents are not read: size and mtime change with any replacement of the file,
+// and hashing a large CJK font would cost more than mapping the cache.
+static unsigned long long FontCacheKey(const ImFontAtlas *atlas)
+{
+    unsigned long long key = 14695981039346656037ULL;
+    int layout[] = {IMGUI_VERSION_NUM, FONT_CACHE_VERSION, (int)sizeof(ImFontGlyph), (int)sizeof(ImFontAtlasCustomRect), (int)sizeof(ImWchar),
+                    atlas->Flags, atlas->TexDesiredWidth, atlas->TexGlyphPadding, (int)atlas->FontBuilderFlags, (int)fontCache.numFonts};
+    key = FontHash(key, layout, sizeof(layout));
+    for (unsigned int i = 0; i < fontCache.numFonts; i++)
+    {
+        const font_spec_t *spec = &(fontCache.fonts[i]);
+        struct stat info;
+        if (stat(spec->file, &info) != 0)
+            return 0;
+        long long fileInfo[] = {(long long)info.st_size, (long long)info.st_mtim.tv_sec, (long long)info.st_mtim.tv_nsec};
+        key = FontHash(key, spec->file, strlen(spec->file) + 1);
+        key = FontHash(key, fileInfo, sizeof(fileInfo));
+        key = FontHash(key, &(spec->size), sizeof(spec->size));
+        for (const ImWchar *range = spec->ranges; range != NULL && *range != 0; range++)
+            key = FontHash(key, range, sizeof(ImWchar));
+    }
+    return key;
+}
+
+static void FontCacheAddFonts(ImFontAtlas *atlas)
+{
+    for (unsigned int i = 0; i < fontCache.numFonts; i++)
+    {
+        const font_spec_t *spec = &(fontCache.fonts[i]);
+        if (atlas->AddFontFromFileTTF(spec->file, spec->size, NULL, spec->ranges) == NULL)
+            fprintf(stderr, "imgui_font_cache: could not load %s\n", spec->file);
+    }
+}
+
+#if FONT_CACHE_SUPPORTED
+// Bounds checked cursor over the mapped file.
+static const void *FontCacheRead(const char *base, size_t size, size_t *offset, size_t bytes)
+{
+    if (*offset + bytes > size)
+        return NULL;
+    const void *ptr = base + *offset;
+    *offset += bytes;
+    return ptr;
+}
+
+static int FontCacheMap(ImFontAtlas *atlas, unsigned long long key)
+{
+    int fd = open(fontCache.path, O_RDONLY);
+    if (fd < 0)
+        return 1;
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size < (off_t)sizeof(font_cache_header_t))
+    {
+        close(fd);
+        return 1;
+    }
+    size_t size = (size_t)info.st_size;
+    void *mapping = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED)
+        return 1;
+
+    const char *base = (const char *)mapping;
+    const font_cache_header_t *header = (const font_cache_header_t *)base;
+    size_t pixelBytes = (size_t)header->texWidth * (size_t)header->texHeight * (size_t)header->bytesPerPixel;
+    if (memcmp(header->magic, FONT_CACHE_MAGIC, 4) != 0 || header->version != FONT_CACHE_VERSION || header->key != key ||
+        header->size != size || header->numFonts <= 0 || header->numLines > IM_DRAWLIST_TEX_LINES_WIDTH_MAX + 1 ||
+        (header->bytesPerPixel != 1 && header->bytesPerPixel != 4) || header->pixelsOffset + pixelBytes > size)
+    {
+        munmap(mapping, size);
+        return 1;
+    }
+
+    // Validate every table before touching the atlas so a truncated file falls back cleanly.
+    size_t offset = sizeof(font_cache_header_t);
+    for (int i = 0; i < header->numFonts; i++)
+    {
+        const font_cache_font_t *record = (const font_cache_font_t *)FontCacheRead(base, size, &offset, sizeof(font_cache_font_t));
+        if (record == NULL || record->numGlyphs < 0 || FontCacheRead(base, size, &offset, (size_t)record->numGlyphs * sizeof(ImFontGlyph)) == NULL)
+        {
+            munmap(mapping, size);
+            return 1;
+        }
+    }
+    if (FontCacheRead(base, size, &offset, (size_t)header->numLines * sizeof(ImVec4)) == NULL ||
+        FontCacheRead(base, size, &offset, (size_t)header->numRects * (sizeof(ImFontAtlasCustomRect) + sizeof(int32_t))) == NULL)
+    {
+        munmap(mapping, size);
+        return 1;
+    }
+
+    offset = sizeof(font_cache_header_t);
+    for (int i = 0; i < header->numFonts; i++)
+    {
+        const font_cache_font_t *record = (const font_cache_font_t *)FontCacheRead(base, size, &offset, sizeof(font_cache_font_t));
+        const ImFontGlyph *glyphs = (const ImFontGlyph *)FontCacheRead(base, size, &offset, (size_t)record->numGlyphs * sizeof(ImFontGlyph));
+        ImFont *font = IM_NEW(ImFont)();
+        font->ContainerAtlas = atlas;
+        font->FontSize = record->fontSize;
+        font->Ascent = record->ascent;
+        font->Descent = record->descent;
+        font->Scale = record->scale;
+        font->FallbackChar = (ImWchar)record->fallbackChar;
+        font->EllipsisChar = (ImWchar)record->ellipsisChar;
+        font->EllipsisCharCount = (short)record->ellipsisCharCount;
+        font->EllipsisWidth = record->ellipsisWidth;
+        font->EllipsisCharStep = record->ellipsisCharStep;
+        font->MetricsTotalSurface = record->metricsTotalSurface;
+        font->Glyphs.resize(record->numGlyphs);
+        if (record->numGlyphs > 0)
+            memcpy(font->Glyphs.Data, glyphs, (size_t)record->numGlyphs * sizeof(ImFontGlyph));
+        font->BuildLookupTable();
+        atlas->Fonts.push_back(font);
+    }
+
+    const ImVec4 *lines = (const ImVec4 *)FontCacheRead(base, size, &offset, (size_t)header->numLines * sizeof(ImVec4));
+    for (int i = 0; i < header->numLines; i++)
+        atlas->TexUvLines[i] = lines[i];
+    const ImFontAtlasCustomRect *rects = (const ImFontAtlasCustomRect *)FontCacheRead(base, size, &offset, (size_t)header->numRects * sizeof(ImFontAtlasCustomRect));
+    const int32_t *rectFonts = (const int32_t *)FontCacheRead(base, size, &offset, (size_t)header->numRects * sizeof(int32_t));
+    atlas->CustomRects.resize(header->numRects);
+    for (int i = 0; i < header->numRects; i++)
+    {
+        atlas->CustomRects[i] = rects[i];
+        atlas->CustomRects[i].Font = rectFonts[i] >= 0 && rectFonts[i] < atlas->Fonts.Size ? atlas->Fonts[rectFonts[i]] : NULL;
+    }
+
+    atlas->TexWidth = header->texWidth;
+    atlas->TexHeight = header->texHeight;
+    atlas->TexUvScale = ImVec2(header->uvScale[0], header->uvScale[1]);
+    atlas->TexUvWhitePixel = ImVec2(header->uvWhitePixel[0], header->uvWhitePixel[1]);
+    atlas->PackIdMouseCursor = header->packIdMouseCursor;
+    atlas->PackIdLines = header->packIdLines;
+    atlas->TexPixelsUseColors = header->bytesPerPixel == 4;
+    // The backend uploads straight from the mapping; imgui_font_cache_finish detaches it.
+    if (header->bytesPerPixel == 1)
+        atlas->TexPixelsAlpha8 = (unsigned char *)(base + header->pixelsOffset);
+    else
+        atlas->TexPixelsRGBA32 = (unsigned int *)(base + header->pixelsOffset);
+    atlas->TexReady = true;
+
+    fontCache.mapping = mapping;
+    fontCache.mappingSize = size;
+    fontCache.stats.bytes = size;
+    return 0;
+}
+
+static void FontCacheWritePad(FILE *file, size_t *offset, size_t align)
+{
+    static const char zeros[FONT_CACHE_ALIGN] = {0};
+    size_t pad = (align - *offset % align) % align;
+    fwrite(zeros, 1, pad, file);
+    *offset += pad;
+}
+
+static int FontCacheStore(const ImFontAtlas *atlas, unsigned long long key)
+{
+    if (atlas->TexPixelsAlpha8 == NULL && atlas->TexPixelsRGBA32 == NULL)
+        return 1;
+    char *tmpPath = (char *)malloc(strlen(fontCache.path) + 8);
+    sprintf(tmpPath, "%s.tmp", fontCache.path);
+    FILE *file = fopen(tmpPath, "wb");
+    if (file == NULL)
+    {
+        free(tmpPath);
+        return 1;
+    }
+
+    font_cache_header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, FONT_CACHE_MAGIC, 4);
+    header.version = FONT_CACHE_VERSION;
+    header.key = key;
+    header.texWidth = atlas->TexWidth;
+    header.texHeight = atlas->TexHeight;
+    header.bytesPerPixel = atlas->TexPixelsAlpha8 != NULL && !atlas->TexPixelsUseColors ? 1 : 4;
+    header.numFonts = atlas->Fonts.Size;
+    header.numRects = atlas->CustomRects.Size;
+    header.numLines = IM_DRAWLIST_TEX_LINES_WIDTH_MAX + 1;
+    header.packIdMouseCursor = atlas->PackIdMouseCursor;
+    header.packIdLines = atlas->PackIdLines;
+    header.uvScale[0] = atlas->TexUvScale.x;
+    header.uvScale[1] = atlas->TexUvScale.y;
+    header.uvWhitePixel[0] = atlas->TexUvWhitePixel.x;
+    header.uvWhitePixel[1] = atlas->TexUvWhitePixel.y;
+    if (header.bytesPerPixel == 4 && atlas->TexPixelsRGBA32 == NULL)
+    {
+        fclose(file);
+        remove(tmpPath);
+        free(tmpPath);
+        return 1;
+    }
+    // The header is rewritten once the offsets are known.
+    fwrite(&header, sizeof(header), 1, file);
+    size_t offset = sizeof(header);
+
+    for (int i = 0; i < atlas->Fonts.Size; i++)
+    {
+        const ImFont *font = atlas->Fonts[i];
+        font_cache_font_t record;
+        memset(&record, 0, sizeof(record));
+        record.fontSize = font->FontSize;
+        record.ascent = font->Ascent;
+        record.descent = font->Descent;
+        record.scale = font->Scale;
+        record.ellipsisWidth = font->EllipsisWidth;
+        record.ellipsisCharStep = font->EllipsisCharStep;
+        record.fallbackChar = font->FallbackChar;
+        record.ellipsisChar = font->EllipsisChar;
+        record.ellipsisCharCount = font->EllipsisCharCount;
+        record.metricsTotalSurface = font->MetricsTotalSurface;
+        record.numGlyphs = font->Glyphs.Size;
+        fwrite(&record, sizeof(record), 1, file);
+        fwrite(font->Glyphs.Data, sizeof(ImFontGlyph), (size_t)font->Glyphs.Size, file);
+        offset += sizeof(record) + (size_t)font->Glyphs.Size * sizeof(ImFontGlyph);
+    }
+    fwrite(atlas->TexUvLines, sizeof(ImVec4), (size_t)header.numLines, file);
+    offset += (size_t)header.numLines * sizeof(ImVec4);
+    fwrite(atlas->CustomRects.Data, sizeof(ImFontAtlasCustomRect), (size_t)atlas->CustomRects.Size, file);
+    for (int i = 0; i < atlas->CustomRects.Size; i++)
+    {
+        int32_t fontIndex = atlas->CustomRects[i].Font != NULL ? atlas->Fonts.index_from_ptr(atlas->Fonts.find(atlas->CustomRects[i].Font)) : -1;
+        fwrite(&fontIndex, sizeof(fontIndex), 1, file);
+    }
+    offset += (size_t)atlas->CustomRects.Size * (sizeof(ImFontAtlasCustomRect) + sizeof(int32_t));
+
+    FontCacheWritePad(file, &offset, FONT_CACHE_ALIGN);
+    header.pixelsOffset = offset;
+    size_t pixelBytes = (size_t)atlas->TexWidth * (size_t)atlas->TexHeight * (size_t)header.bytesPerPixel;
+    fwrite(header.bytesPerPixel == 1 ? (const void *)atlas->TexPixelsAlpha8 : (const void *)atlas->TexPixelsRGBA32, 1, pixelBytes, file);
+    offset += pixelBytes;
+    header.size = offset;
+
+    fseek(file, 0, SEEK_SET);
+    fwrite(&header, sizeof(header), 1, file);
+    int failed = ferror(file);
+    failed |= fclose(file);
+    // Rename last so a concurrent viewer never maps a half written file.
+    if (failed != 0 || rename(tmpPath, fontCache.path) != 0)
+    {
+        remove(tmpPath);
+        free(tmpPath);
+        return 1;
+    }
+    free(tmpPath);
+    fontCache.stats.bytes = offset;
+    return 0;
+}
+#endif
+
+// Called by imgui_init right after the context is created. On a hit the atlas is
+// populated from the mapped cache, otherwise the registered fonts are added and
+// the backend bakes them as usual.
+int imgui_font_cache_load()
+{
+    ImFontAtlas *atlas = ImGui::GetIO().Fonts;
+    fontCache.start = glfwGetTime();
+    fontCache.stats.enabled = fontCache.path != NULL && FONT_CACHE_SUPPORTED;
+    fontCache.stats.hit = 0;
+    fontCache.stats.key = 0;
+    fontCache.stats.bytes = 0;
+#if FONT_CACHE_SUPPORTED
+    if (fontCache.stats.enabled)
+    {
+        // Cache the default font too, so the key never depends on what the backend falls back to.
+        fontCache.stats.key = FontCacheKey(atlas);
+        if (fontCache.stats.key != 0 && FontCacheMap(atlas, fontCache.stats.key) == 0)
+        {
+            fontCache.stats.hit = 1;
+            return 0;
+        }
+    }
+#endif
+    FontCacheAddFonts(atlas);
+    if (fontCache.stats.enabled && atlas->Fonts.Size == 0)
+        atlas->AddFontDefault();
+    return 0;
+}
+
+// Called by imgui_init once the backend has uploaded the atlas texture.
+int imgui_font_cache_finish()
+{
+    ImFontAtlas *atlas = ImGui::GetIO().Fonts;
+#if FONT_CACHE_SUPPORTED
+    if (fontCache.mapping != NULL)
+    {
+        // The RGBA copy made for the upload is owned by the atlas; the mapped pixels are not.
+        const char *base = (const char *)fontCache.mapping;
+        if ((const char *)atlas->TexPixelsAlpha8 >= base && (const char *)atlas->TexPixelsAlpha8 < base + fontCache.mappingSize)
+            atlas->TexPixelsAlpha8 = NULL;
+        if ((const char *)atlas->TexPixelsRGBA32 >= base && (const char *)atlas->TexPixelsRGBA32 < base + fontCache.mappingSize)
+            atlas->TexPixelsRGBA32 = NULL;
+        munmap(fontCache.mapping, fontCache.mappingSize);
+        fontCache.mapping = NULL;
+        fontCache.mappingSize = 0;
+    }
+    else if (fontCache.stats.enabled && fontCache.stats.key != 0)
+    {
+        if (FontCacheStore(atlas, fontCache.stats.key) != 0)
+            fprintf(stderr, "imgui_font_cache: could not write %s\n", fontCache.path);
+    }
+#else
+    (void)atlas;
+#endif
+    fontCache.stats.seconds = glfwGetTime() - fontCache.start;
+    return 0;
+}
+
+void imgui_font_cache_cleanup()
+{
+    for (unsigned int i = 0; i < fontCache.numFonts; i++)
+    {
+        free(fontCache.fonts[i].file);
+        free(fontCache.fonts[i].ranges);
+    }
+    free(fontCache.path);
+    memset(&fontCache, 0, sizeof(fontCache));
+}
+
+const imgui_font_cache_stats_t *imgui_font_cache_get_stats()
+{
+    return &(fontCache.stats);
+}
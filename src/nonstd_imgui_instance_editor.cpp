@@ -0,0 +1,257 @@
+#include <float.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include <imgui.h>
+
+#include <nonstd.h>
+#include <nonstd_glfw_opengl.h>
+#include <tile_map.h>
+#include "nonstd_imgui.h"
+
+#define INSTANCE_TABLE_LINES 16
+#define INSTANCE_DEG_PER_RAD 57.29577951308232f
+
+// Selection of one mesh's instances; one byte per instance so 50k props stay cheap.
+typedef struct instance_editor_s
+{
+    const mesh_t *mesh;
+    ImVector<unsigned char> selected;
+    unsigned int numSelected;
+    int anchor;  // last clicked row, start of shift ranges
+    int primary; // instance whose values the fields show
+} instance_editor_t;
+
+static thread_local ImVector<instance_editor_t *> instanceEditors;
+
+static instance_editor_t *GetInstanceEditor(const mesh_t *mesh)
+{
+    instance_editor_t *editor = NULL;
+    for (int i = 0; i < instanceEditors.Size; i++)
+    {
+        if (instanceEditors[i]->mesh == mesh)
+        {
+            editor = instanceEditors[i];
+            break;
+        }
+    }
+    if (editor == NULL)
+    {
+        editor = IM_NEW(instance_editor_t)();
+        editor->mesh = mesh;
+        instanceEditors.push_back(editor);
+    }
+    if (editor->selected.Size != (int)mesh->mNumInstances)
+    {
+        editor->selected.resize((int)mesh->mNumInstances);
+        if (mesh->mNumInstances > 0)
+            memset(editor->selected.Data, 0, mesh->mNumInstances);
+        editor->numSelected = 0;
+        editor->anchor = -1;
+        editor->primary = -1;
+    }
+    return editor;
+}
+
+void imgui_instance_editor_cleanup()
+{
+    for (int i = 0; i < instanceEditors.Size; i++)
+        IM_DELETE(instanceEditors[i]);
+    instanceEditors.clear();
+}
+
+// Splits a column-major affine matrix into translation, XYZ euler angles in
+// degrees (R = Rz * Ry * Rx) and per-axis scale.
+static void DecomposeInstance(const mat4 m, float t[3], float r[3], float s[3])
+{
+    for (int c = 0; c < 3; c++)
+    {
+        t[c] = m[3][c];
+        s[c] = sqrtf(m[c][0] * m[c][0] + m[c][1] * m[c][1] + m[c][2] * m[c][2]);
+    }
+    float inv[3];
+    for (int c = 0; c < 3; c++)
+        inv[c] = s[c] > 0.0f ? 1.0f / s[c] : 0.0f;
+    float r00 = m[0][0] * inv[0], r10 = m[0][1] * inv[0], r20 = m[0][2] * inv[0];
+    float r11 = m[1][1] * inv[1], r21 = m[1][2] * inv[1];
+    float r12 = m[2][1] * inv[2], r22 = m[2][2] * inv[2];
+    r20 = r20 > 1.0f ? 1.0f : (r20 < -1.0f ? -1.0f : r20);
+    r[1] = asinf(-r20);
+    if (fabsf(r20) < 0.9999f)
+    {
+        r[0] = atan2f(r21, r22);
+        r[2] = atan2f(r10, r00);
+    }
+    else
+    {
+        // Gimbal lock, fold the whole rotation into X.
+        r[0] = atan2f(-r12, r11);
+        r[2] = 0.0f;
+    }
+    for (int c = 0; c < 3; c++)
+        r[c] *= INSTANCE_DEG_PER_RAD;
+}
+
+static void ComposeInstance(mat4 m, const float t[3], const float r[3], const float s[3])
+{
+    float cx = cosf(r[0] / INSTANCE_DEG_PER_RAD), sx = sinf(r[0] / INSTANCE_DEG_PER_RAD);
+    float cy = cosf(r[1] / INSTANCE_DEG_PER_RAD), sy = sinf(r[1] / INSTANCE_DEG_PER_RAD);
+    float cz = cosf(r[2] / INSTANCE_DEG_PER_RAD), sz = sinf(r[2] / INSTANCE_DEG_PER_RAD);
+    float rot[3][3] = {
+        {cy * cz, sx * sy * cz - cx * sz, cx * sy * cz + sx * sz},
+        {cy * sz, sx * sy * sz + cx * cz, cx * sy * sz - sx * cz},
+        {-sy, sx * cy, cx * cy},
+    };
+    for (int c = 0; c < 3; c++)
+    {
+        for (int row = 0; row < 3; row++)
+            m[c][row] = rot[row][c] * s[c];
+        m[c][3] = 0.0f;
+    }
+    m[3][0] = t[0];
+    m[3][1] = t[1];
+    m[3][2] = t[2];
+    m[3][3] = 1.0f;
+}
+
+static void SelectInstance(instance_editor_t *editor, int index, bool value)
+{
+    if ((editor->selected[index] != 0) != value)
+    {
+        editor->selected[index] = value;
+        editor->numSelected += value ? 1 : -1;
+    }
+}
+
+static void SelectInstanceRange(instance_editor_t *editor, int first, int last, bool value)
+{
+    if (first > last)
+    {
+        int tmp = first;
+        first = last;
+        last = tmp;
+    }
+    for (int i = first; i <= last; i++)
+        SelectInstance(editor, i, value);
+}
+
+// Applies the change of the primary instance's fields to every selected instance:
+// translation and rotation are added, scale is multiplied.
+static void ApplyInstanceEdit(mesh_t *mesh, instance_editor_t *editor, const float before[3][3], const float after[3][3])
+{
+    float scale[3];
+    for (int c = 0; c < 3; c++)
+        scale[c] = before[2][c] != 0.0f ? after[2][c] / before[2][c] : 1.0f;
+    for (unsigned int i = 0; i < mesh->mNumInstances; i++)
+    {
+        if (!editor->selected[i])
+            continue;
+        float trs[3][3];
+        DecomposeInstance(mesh->mTransformation[i], trs[0], trs[1], trs[2]);
+        for (int c = 0; c < 3; c++)
+        {
+            trs[0][c] += after[0][c] - before[0][c];
+            trs[1][c] += after[1][c] - before[1][c];
+            trs[2][c] *= scale[c];
+        }
+        ComposeInstance(mesh->mTransformation[i], trs[0], trs[1], trs[2]);
+        imgui_instance_mark(mesh, i, 1);
+    }
+}
+
+void ShowMesh(mesh_t *mesh)
+{
+    if (mesh->mTransformation == NULL || mesh->mNumInstances == 0)
+    {
+        ImGui::TextDisabled("No instances");
+        return;
+    }
+    instance_editor_t *editor = GetInstanceEditor(mesh);
+    ImGui::Text("Instances: %u, selected: %u", mesh->mNumInstances, editor->numSelected);
+    ImGui::SameLine();
+    if (ImGui::SmallButton("All"))
+        SelectInstanceRange(editor, 0, (int)mesh->mNumInstances - 1, true);
+    ImGui::SameLine();
+    if (ImGui::SmallButton("None"))
+        SelectInstanceRange(editor, 0, (int)mesh->mNumInstances - 1, false);
+
+    const ImGuiTableFlags tableFlags = ImGuiTableFlags_ScrollY | ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersOuter | ImGuiTableFlags_BordersV | ImGuiTableFlags_Resizable;
+    ImVec2 outerSize = ImVec2(0.0f, ImGui::GetTextLineHeightWithSpacing() * INSTANCE_TABLE_LINES);
+    if (ImGui::BeginTable("Instance Table", 4, tableFlags, outerSize))
+    {
+        ImGui::TableSetupScrollFreeze(0, 1);
+        ImGui::TableSetupColumn("Instance", ImGuiTableColumnFlags_WidthFixed);
+        ImGui::TableSetupColumn("Translate", ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableSetupColumn("Rotate", ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableSetupColumn("Scale", ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableHeadersRow();
+        ImGuiListClipper clipper;
+        clipper.Begin((int)mesh->mNumInstances);
+        while (clipper.Step())
+        {
+            for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; row++)
+            {
+                float trs[3][3];
+                DecomposeInstance(mesh->mTransformation[row], trs[0], trs[1], trs[2]);
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::PushID(row);
+                // Click selects one, ctrl toggles, shift extends from the last click.
+                if (ImGui::Selectable(imgui_frame_printf("%d", row), editor->selected[row] != 0, ImGuiSelectableFlags_SpanAllColumns))
+                {
+                    ImGuiIO &io = ImGui::GetIO();
+                    if (io.KeyShift && editor->anchor >= 0)
+                    {
+                        SelectInstanceRange(editor, editor->anchor, row, true);
+                    }
+                    else if (io.KeyCtrl)
+                    {
+                        SelectInstance(editor, row, editor->selected[row] == 0);
+                        editor->anchor = row;
+                    }
+                    else
+                    {
+                        SelectInstanceRange(editor, 0, (int)mesh->mNumInstances - 1, false);
+                        SelectInstance(editor, row, true);
+                        editor->anchor = row;
+                    }
+                    editor->primary = editor->selected[row] ? row : -1;
+                }
+                ImGui::PopID();
+                for (int k = 0; k < 3; k++)
+                {
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%.3f, %.3f, %.3f", trs[k][0], trs[k][1], trs[k][2]);
+                }
+            }
+        }
+        ImGui::EndTable();
+    }
+
+    if (editor->primary < 0 || !editor->selected[editor->primary])
+    {
+        ImGui::TextDisabled("Select an instance to edit");
+        return;
+    }
+    float before[3][3];
+    DecomposeInstance(mesh->mTransformation[editor->primary], before[0], before[1], before[2]);
+    float after[3][3];
+    memcpy(after, before, sizeof(after));
+    ImGui::SeparatorText(editor->numSelected > 1 ? imgui_frame_printf("Instance %d and %u more", editor->primary, editor->numSelected - 1)
+                                                 : imgui_frame_printf("Instance %d", editor->primary));
+    bool changed = false;
+    changed |= ImGui::DragFloat3("Translate", after[0], 0.01f, -FLT_MAX, FLT_MAX, "%.3f");
+    changed |= ImGui::DragFloat3("Rotate", after[1], 0.5f, -360.0f, 360.0f, "%.1f deg");
+    changed |= ImGui::DragFloat3("Scale", after[2], 0.005f, 0.0001f, FLT_MAX, "%.3f");
+    if (changed)
+        ApplyInstanceEdit(mesh, editor, before, after);
+
+    const imgui_instance_stats_t *stats = imgui_instance_get_stats();
+    ImGui::TextDisabled("Last upload: %u ranges, %u calls, %.1f KiB", stats->ranges, stats->calls, stats->bytes / 1024.0);
+}
@@ -0,0 +1,276 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include <imgui.h>
+
+#include <nonstd.h>
+#include <nonstd_glfw_opengl.h>
+#include <tile_map.h>
+#include "nonstd_imgui.h"
+
+typedef struct instance_range_s
+{
+    unsigned int first;
+    unsigned int count;
+} instance_range_t;
+
+typedef struct instance_buffer_s
+{
+    const mesh_t *mesh;
+    GLuint buffer;
+    size_t offset;
+    size_t stride;
+    ImVector<instance_range_t> dirty;
+} instance_buffer_t;
+
+// Each GUI has its own registrations and dirty ranges since its editor marks them
+// on the thread building its frames; bound by imgui_instance_bind.
+typedef struct imgui_instance_state_s
+{
+    ImVector<instance_buffer_t *> buffers;
+    imgui_instance_stats_t stats;
+    struct imgui_instance_batch_s *batch; // used by imgui_instance_flush
+} imgui_instance_state_t;
+
+// One upload of count matrices, stored contiguously in the batch from matrix.
+typedef struct instance_upload_s
+{
+    GLuint buffer;
+    size_t offset;
+    size_t stride;
+    unsigned int matrix;
+    unsigned int count;
+} instance_upload_t;
+
+// Uploads taken from the dirty ranges together with a copy of the edited
+// matrices, so they can be sent by another thread while the next frame edits on.
+typedef struct imgui_instance_batch_s
+{
+    ImVector<instance_upload_t> uploads;
+    ImVector<float> matrices;
+} imgui_instance_batch_t;
+
+static imgui_instance_state_t defaultState;
+static thread_local imgui_instance_state_t *state = &defaultState;
+
+imgui_instance_state_t *imgui_instance_init()
+{
+    state = IM_NEW(imgui_instance_state_t)();
+    state->batch = imgui_instance_batch_create();
+    return state;
+}
+
+void imgui_instance_cleanup()
+{
+    for (int i = 0; i < state->buffers.Size; i++)
+        IM_DELETE(state->buffers[i]);
+    state->buffers.clear();
+    memset(&(state->stats), 0, sizeof(state->stats));
+    imgui_instance_batch_destroy(state->batch);
+    state->batch = NULL;
+    if (state != &defaultState)
+        IM_DELETE(state);
+    state = &defaultState;
+}
+
+void imgui_instance_bind(imgui_instance_state_t *bound)
+{
+    state = bound != NULL ? bound : &defaultState;
+}
+
+imgui_instance_batch_t *imgui_instance_batch_create()
+{
+    return IM_NEW(imgui_instance_batch_t)();
+}
+
+void imgui_instance_batch_destroy(imgui_instance_batch_t *batch)
+{
+    if (batch != NULL)
+        IM_DELETE(batch);
+}
+
+static instance_buffer_t *FindInstanceBuffer(const mesh_t *mesh, bool create)
+{
+    for (int i = 0; i < state->buffers.Size; i++)
+    {
+        if (state->buffers[i]->mesh == mesh)
+            return state->buffers[i];
+    }
+    if (!create)
+        return NULL;
+    instance_buffer_t *entry = IM_NEW(instance_buffer_t)();
+    entry->mesh = mesh;
+    entry->buffer = 0;
+    entry->offset = 0;
+    entry->stride = sizeof(mat4);
+    state->buffers.push_back(entry);
+    return entry;
+}
+
+void imgui_instance_buffer(const mesh_t *mesh, unsigned int buffer, size_t offset, size_t stride)
+{
+    instance_buffer_t *entry = FindInstanceBuffer(mesh, true);
+    entry->buffer = buffer;
+    entry->offset = offset;
+    entry->stride = stride != 0 ? stride : sizeof(mat4);
+}
+
+// Appends are merged with the previous range when they touch, so marking the
+// selection in index order stays one range per contiguous run.
+void imgui_instance_mark(const mesh_t *mesh, unsigned int first, unsigned int count)
+{
+    if (count == 0)
+        return;
+    instance_buffer_t *entry = FindInstanceBuffer(mesh, true);
+    if (entry->dirty.Size > 0)
+    {
+        instance_range_t *last = &(entry->dirty.back());
+        if (first >= last->first && first <= last->first + last->count)
+        {
+            unsigned int end = first + count > last->first + last->count ? first + count : last->first + last->count;
+            last->count = end - last->first;
+            return;
+        }
+    }
+    instance_range_t range = {first, count};
+    entry->dirty.push_back(range);
+}
+
+static int CompareInstanceRange(const void *a, const void *b)
+{
+    unsigned int fa = ((const instance_range_t *)a)->first;
+    unsigned int fb = ((const instance_range_t *)b)->first;
+    return fa < fb ? -1 : (fa > fb ? 1 : 0);
+}
+
+// Sorts and merges the dirty ranges, bridging gaps of up to IMGUI_INSTANCE_MERGE_GAP
+// clean instances since re-sending a few matrices is cheaper than another call.
+static void CoalesceInstanceRanges(ImVector<instance_range_t> &dirty)
+{
+    if (dirty.Size < 2)
+        return;
+    qsort(dirty.Data, (size_t)dirty.Size, sizeof(instance_range_t), CompareInstanceRange);
+    int out = 0;
+    for (int i = 1; i < dirty.Size; i++)
+    {
+        instance_range_t *current = &(dirty[out]);
+        unsigned int end = current->first + current->count;
+        if (dirty[i].first <= end + IMGUI_INSTANCE_MERGE_GAP)
+        {
+            unsigned int next = dirty[i].first + dirty[i].count;
+            current->count = (next > end ? next : end) - current->first;
+        }
+        else
+        {
+            dirty[++out] = dirty[i];
+        }
+    }
+    dirty.resize(out + 1);
+}
+
+// Moves the current GUI's dirty ranges into batch, appending to uploads it may
+// still hold. Runs on the thread building the frames and needs no GL context.
+void imgui_instance_take(imgui_instance_batch_t *batch)
+{
+    unsigned int ranges = 0;
+    unsigned int calls = 0;
+    unsigned long long bytes = 0;
+    for (int i = 0; i < state->buffers.Size; i++)
+    {
+        instance_buffer_t *entry = state->buffers[i];
+        if (entry->dirty.Size == 0)
+            continue;
+        CoalesceInstanceRanges(entry->dirty);
+        ranges += (unsigned int)entry->dirty.Size;
+        const mesh_t *mesh = entry->mesh;
+        if (entry->buffer == 0 || mesh->mTransformation == NULL)
+        {
+            // Without a registered buffer the edits stay on the CPU copy for the host to upload.
+            entry->dirty.resize(0);
+            continue;
+        }
+        for (int r = 0; r < entry->dirty.Size; r++)
+        {
+            unsigned int first = entry->dirty[r].first;
+            unsigned int count = entry->dirty[r].count;
+            if (first >= mesh->mNumInstances)
+                continue;
+            if (first + count > mesh->mNumInstances)
+                count = mesh->mNumInstances - first;
+            instance_upload_t upload;
+            upload.buffer = entry->buffer;
+            upload.offset = entry->offset + first * entry->stride;
+            upload.stride = entry->stride;
+            upload.matrix = (unsigned int)(batch->matrices.Size / 16);
+            upload.count = count;
+            batch->uploads.push_back(upload);
+            int at = batch->matrices.Size;
+            batch->matrices.resize(at + (int)count * 16);
+            memcpy(&(batch->matrices[at]), mesh->mTransformation[first], count * sizeof(mat4));
+            // Interleaved layouts take one call per matrix.
+            calls += entry->stride == sizeof(mat4) ? 1 : count;
+            bytes += (unsigned long long)count * sizeof(mat4);
+        }
+        entry->dirty.resize(0);
+    }
+
+    // Keep the last flush that had work so the editor can show it.
+    if (ranges == 0)
+        return;
+    state->stats.flushes++;
+    state->stats.ranges = ranges;
+    state->stats.calls = calls;
+    state->stats.bytes = bytes;
+    state->stats.totalBytes += bytes;
+}
+
+// Needs the GL context of the GUI's buffers. Empties batch.
+void imgui_instance_upload(imgui_instance_batch_t *batch)
+{
+    if (batch->uploads.Size == 0)
+        return;
+    GLint lastBuffer = 0;
+    glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &lastBuffer);
+    GLuint bound = 0;
+    for (int i = 0; i < batch->uploads.Size; i++)
+    {
+        const instance_upload_t *upload = &(batch->uploads[i]);
+        const float *matrices = &(batch->matrices[upload->matrix * 16]);
+        if (upload->buffer != bound)
+        {
+            glBindBuffer(GL_ARRAY_BUFFER, upload->buffer);
+            bound = upload->buffer;
+        }
+        if (upload->stride == sizeof(mat4))
+        {
+            glBufferSubData(GL_ARRAY_BUFFER, (GLintptr)upload->offset, (GLsizeiptr)(upload->count * sizeof(mat4)), matrices);
+        }
+        else
+        {
+            for (unsigned int n = 0; n < upload->count; n++)
+                glBufferSubData(GL_ARRAY_BUFFER, (GLintptr)(upload->offset + n * upload->stride), (GLsizeiptr)sizeof(mat4), matrices + n * 16);
+        }
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, (GLuint)lastBuffer);
+    batch->uploads.resize(0);
+    batch->matrices.resize(0);
+}
+
+// Needs the GL context. Runs from imgui_end_frame; imgui_publish_frame takes the
+// ranges into the published frame instead and imgui_submit_frame uploads them.
+void imgui_instance_flush()
+{
+    if (state->batch == NULL)
+        return;
+    imgui_instance_take(state->batch);
+    imgui_instance_upload(state->batch);
+}
+
+const imgui_instance_stats_t *imgui_instance_get_stats()
+{
+    return &(state->stats);
+}
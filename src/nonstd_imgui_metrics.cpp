@@ -0,0 +1,171 @@
+#include <float.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include <nonstd.h>
+#include <nonstd_glfw_opengl.h>
+#include <tile_map.h>
+#include "nonstd_imgui.h"
+
+#define METRIC_MASK (IMGUI_METRIC_CAPACITY - 1)
+
+// One ring per metric. Producers claim a sample by bumping head and then publish
+// it with a single 64 bit store of the value's bits and the low half of its index
+// + 1, so a reader never sees a torn value and skips slots that are not yet
+// written or already reused by a later sample.
+typedef struct imgui_metric_s
+{
+    const char *name; // owned copy
+    unsigned long long *samples;
+    unsigned long long head;
+} imgui_metric_t;
+
+static imgui_metric_t metrics[IMGUI_METRIC_MAX];
+
+static unsigned long long imgui_metric_pack(unsigned long long index, float value)
+{
+    unsigned int bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return ((index + 1) << 32) | bits;
+}
+
+// Returns false when the slot does not hold sample index.
+static bool imgui_metric_unpack(unsigned long long packed, unsigned long long index, float *value)
+{
+    if ((packed >> 32) != ((index + 1) & 0xFFFFFFFFull))
+        return false;
+    unsigned int bits = (unsigned int)packed;
+    memcpy(value, &bits, sizeof(bits));
+    return true;
+}
+
+static imgui_metric_t *imgui_metric_find(const char *name)
+{
+    for (unsigned int i = 0; i < IMGUI_METRIC_MAX; i++)
+    {
+        imgui_metric_t *metric = &(metrics[i]);
+        const char *current = __atomic_load_n(&(metric->name), __ATOMIC_ACQUIRE);
+        if (current == NULL)
+        {
+            // Only the first push of a new name gets here, so the copy is rare.
+            char *copy = strdup(name);
+            if (copy == NULL)
+                return NULL;
+            const char *expected = NULL;
+            if (__atomic_compare_exchange_n(&(metric->name), &expected, (const char *)copy, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+            {
+                // The claiming thread allocates; pushes from others are dropped until it is published.
+                unsigned long long *samples = (unsigned long long *)calloc(IMGUI_METRIC_CAPACITY, sizeof(unsigned long long));
+                __atomic_store_n(&(metric->samples), samples, __ATOMIC_RELEASE);
+                return metric;
+            }
+            free(copy);
+            current = expected;
+        }
+        if (strcmp(current, name) == 0)
+            return metric;
+    }
+    return NULL;
+}
+
+// Safe to call from any thread, several GUIs push the built in series concurrently.
+void imgui_metric_push(const char *name, float value)
+{
+    if (name == NULL)
+        return;
+    imgui_metric_t *metric = imgui_metric_find(name);
+    if (metric == NULL)
+        return;
+    unsigned long long *samples = __atomic_load_n(&(metric->samples), __ATOMIC_ACQUIRE);
+    if (samples == NULL)
+        return;
+
+    unsigned long long head = __atomic_fetch_add(&(metric->head), 1, __ATOMIC_ACQ_REL);
+    __atomic_store_n(&(samples[head & METRIC_MASK]), imgui_metric_pack(head, value), __ATOMIC_RELEASE);
+}
+
+unsigned int imgui_metric_count()
+{
+    unsigned int count = 0;
+    while (count < IMGUI_METRIC_MAX && __atomic_load_n(&(metrics[count].name), __ATOMIC_ACQUIRE) != NULL)
+        count++;
+    return count;
+}
+
+const char *imgui_metric_name(unsigned int index)
+{
+    return index < IMGUI_METRIC_MAX ? __atomic_load_n(&(metrics[index].name), __ATOMIC_ACQUIRE) : NULL;
+}
+
+unsigned long long imgui_metric_total(unsigned int index)
+{
+    return index < IMGUI_METRIC_MAX ? __atomic_load_n(&(metrics[index].head), __ATOMIC_ACQUIRE) : 0;
+}
+
+// Reduces the newest numSamples samples to numBuckets min/max/avg triples, oldest
+// first. Returns the number of buckets written (fewer when there is less history).
+// Samples still being written or already overwritten are left out; a bucket left
+// without any repeats the previous one.
+unsigned int imgui_metric_decimate(unsigned int index, unsigned int numSamples, imgui_metric_bucket_t *buckets, unsigned int numBuckets)
+{
+    if (index >= IMGUI_METRIC_MAX || numBuckets == 0)
+        return 0;
+    imgui_metric_t *metric = &(metrics[index]);
+    unsigned long long *samples = __atomic_load_n(&(metric->samples), __ATOMIC_ACQUIRE);
+    if (samples == NULL)
+        return 0;
+
+    unsigned long long head = __atomic_load_n(&(metric->head), __ATOMIC_ACQUIRE);
+    // Leave a margin the producer can advance into while we read.
+    unsigned long long available = head < IMGUI_METRIC_CAPACITY - IMGUI_METRIC_CAPACITY / 16 ? head : IMGUI_METRIC_CAPACITY - IMGUI_METRIC_CAPACITY / 16;
+    unsigned long long count = numSamples < available ? numSamples : available;
+    if (count == 0)
+        return 0;
+    if (numBuckets > count)
+        numBuckets = (unsigned int)count;
+
+    unsigned long long start = head - count;
+    for (unsigned int b = 0; b < numBuckets; b++)
+    {
+        unsigned long long first = start + count * b / numBuckets;
+        unsigned long long last = start + count * (b + 1) / numBuckets;
+        float minValue = FLT_MAX, maxValue = -FLT_MAX;
+        double sum = 0.0;
+        unsigned int valid = 0;
+        for (unsigned long long i = first; i < last; i++)
+        {
+            float value;
+            if (!imgui_metric_unpack(__atomic_load_n(&(samples[i & METRIC_MASK]), __ATOMIC_ACQUIRE), i, &value))
+                continue;
+            minValue = value < minValue ? value : minValue;
+            maxValue = value > maxValue ? value : maxValue;
+            sum += value;
+            valid++;
+        }
+        if (valid == 0)
+        {
+            buckets[b] = b > 0 ? buckets[b - 1] : imgui_metric_bucket_t{0.0f, 0.0f, 0.0f};
+            continue;
+        }
+        buckets[b].min = minValue;
+        buckets[b].max = maxValue;
+        buckets[b].avg = (float)(sum / (double)valid);
+    }
+    return numBuckets;
+}
+
+// Only safe once every producer has stopped pushing.
+void imgui_metrics_cleanup()
+{
+    for (unsigned int i = 0; i < IMGUI_METRIC_MAX; i++)
+    {
+        free(metrics[i].samples);
+        free((void *)metrics[i].name);
+        metrics[i].samples = NULL;
+        metrics[i].name = NULL;
+        metrics[i].head = 0;
+    }
+}
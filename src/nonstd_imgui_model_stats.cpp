@@ -0,0 +1,418 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include <imgui.h>
+
+#include <nonstd.h>
+#include <nonstd_glfw_opengl.h>
+#include <tile_map.h>
+#include "nonstd_imgui.h"
+
+typedef struct imgui_mesh_stats_s
+{
+    unsigned int index;
+    unsigned int instances;
+    unsigned int materials;
+    unsigned long long instanceBytes;
+    unsigned long long textureBytes;
+} imgui_mesh_stats_t;
+
+typedef struct imgui_model_stats_s
+{
+    const model_t *model;
+    unsigned long long key;
+
+    unsigned int meshes;
+    unsigned int materials;
+    unsigned int instances;
+    unsigned int nodes;
+    unsigned int nodeMeshes;
+    unsigned int maxDepth;
+    unsigned int textures;
+    unsigned int uniqueTextures;
+    unsigned long long cpuBytes;
+    unsigned long long gpuBytes;
+    unsigned long long textureBytes;
+    ImVector<imgui_mesh_stats_t> meshStats;
+    ImVector<unsigned long long> materialBytes;
+} imgui_model_stats_t;
+
+static thread_local ImVector<imgui_model_stats_t *> modelStats;
+static thread_local const imgui_model_stats_t *sortStats = NULL;
+static thread_local const ImGuiTableSortSpecs *sortSpecs = NULL;
+
+// Cheap fingerprint of the model's top-level layout; a reload or edit that
+// changes counts or reallocates the lists invalidates the cached totals.
+static unsigned long long ModelKey(const model_t *model)
+{
+    unsigned long long key = 14695981039346656037ULL;
+    uintptr_t values[] = {
+        (uintptr_t)model->mNumMeshes,
+        (uintptr_t)model->mMeshList,
+        (uintptr_t)model->mNumMaterials,
+        (uintptr_t)model->mMaterialList,
+        (uintptr_t)model->mRootNode.mNumChildren,
+        (uintptr_t)model->mRootNode.mChildren,
+    };
+    for (unsigned int i = 0; i < sizeof(values) / sizeof(values[0]); i++)
+    {
+        key ^= (unsigned long long)values[i];
+        key *= 1099511628211ULL;
+    }
+    for (unsigned int i = 0; i < model->mNumMeshes; i++)
+    {
+        key ^= (unsigned long long)model->mMeshList[i].mNumInstances;
+        key *= 1099511628211ULL;
+    }
+    return key;
+}
+
+static unsigned int BytesPerPixel(GLint format)
+{
+    switch (format)
+    {
+    case GL_R8:
+    case GL_RED:
+        return 1;
+    case GL_RG8:
+    case GL_R16F:
+    case GL_RG:
+        return 2;
+    case GL_RGBA16F:
+    case GL_RG32F:
+        return 8;
+    case GL_RGB32F:
+        return 12;
+    case GL_RGBA32F:
+        return 16;
+    default:
+        // RGB8 is padded to 4 bytes by most drivers.
+        return 4;
+    }
+}
+
+// Estimated VRAM of a 2D texture, including its mip chain.
+static unsigned long long TextureBytes(GLuint texture)
+{
+    if (texture == 0 || !glIsTexture(texture))
+        return 0;
+
+    GLint lastTexture = 0;
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &lastTexture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+
+    GLint width = 0, height = 0, format = 0, compressed = 0, minFilter = 0;
+    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &width);
+    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &height);
+    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_INTERNAL_FORMAT, &format);
+    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_COMPRESSED, &compressed);
+    glGetTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, &minFilter);
+
+    unsigned long long bytes = 0;
+    if (compressed)
+    {
+        GLint size = 0;
+        glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_COMPRESSED_IMAGE_SIZE, &size);
+        bytes = (unsigned long long)size;
+    }
+    else
+    {
+        bytes = (unsigned long long)width * (unsigned long long)height * BytesPerPixel(format);
+    }
+    if (minFilter != GL_NEAREST && minFilter != GL_LINEAR)
+        bytes = bytes * 4 / 3;
+
+    glBindTexture(GL_TEXTURE_2D, (GLuint)lastTexture);
+    return bytes;
+}
+
+typedef struct node_visit_s
+{
+    const model_node_t *node;
+    unsigned int depth;
+} node_visit_t;
+
+static void ComputeModelStats(imgui_model_stats_t *stats, const model_t *model)
+{
+    stats->meshes = model->mNumMeshes;
+    stats->materials = model->mNumMaterials;
+    stats->instances = 0;
+    stats->nodes = 0;
+    stats->nodeMeshes = 0;
+    stats->maxDepth = 0;
+    stats->textures = 0;
+    stats->uniqueTextures = 0;
+    stats->textureBytes = 0;
+    stats->cpuBytes = sizeof(model_t);
+
+    stats->meshStats.resize(model->mNumMeshes);
+    for (unsigned int i = 0; i < model->mNumMeshes; i++)
+    {
+        imgui_mesh_stats_t *mesh = &(stats->meshStats[i]);
+        mesh->index = i;
+        mesh->instances = model->mMeshList[i].mNumInstances;
+        mesh->materials = 0;
+        mesh->instanceBytes = (unsigned long long)mesh->instances * sizeof(mat4);
+        mesh->textureBytes = 0;
+        stats->instances += mesh->instances;
+        stats->cpuBytes += sizeof(mesh_t) + mesh->instanceBytes;
+    }
+
+    // Textures shared between materials are only counted once towards the total.
+    ImGuiStorage seen;
+    stats->materialBytes.resize(model->mNumMaterials);
+    for (unsigned int m = 0; m < model->mNumMaterials; m++)
+    {
+        const material_t *material = &(model->mMaterialList[m]);
+        unsigned long long bytes = 0;
+        stats->cpuBytes += sizeof(material_t);
+        for (unsigned int type = 0; type < AI_TEXTURE_TYPE_MAX + 1; type++)
+        {
+            for (unsigned int t = 0; t < material->mTextureCount[type]; t++)
+            {
+                GLuint texture = (GLuint)material->mTextures[type][t].mTexturePtr;
+                unsigned long long textureBytes = TextureBytes(texture);
+                stats->textures++;
+                stats->cpuBytes += sizeof(material_texture_t);
+                bytes += textureBytes;
+                if (texture != 0 && seen.GetInt((ImGuiID)texture, 0) == 0)
+                {
+                    seen.SetInt((ImGuiID)texture, 1);
+                    stats->uniqueTextures++;
+                    stats->textureBytes += textureBytes;
+                }
+            }
+        }
+        stats->materialBytes[m] = bytes;
+
+        for (unsigned int i = 0; i < material->mNumMeshes; i++)
+        {
+            unsigned int meshIndex = (unsigned int)material->mMeshes[i];
+            if (meshIndex < model->mNumMeshes)
+            {
+                stats->meshStats[meshIndex].materials++;
+                stats->meshStats[meshIndex].textureBytes += bytes;
+            }
+        }
+    }
+
+    // Iterative walk so deep hierarchies cannot overflow the stack.
+    ImVector<node_visit_t> stack;
+    node_visit_t root = {&(model->mRootNode), 0};
+    stack.push_back(root);
+    while (stack.Size > 0)
+    {
+        node_visit_t visit = stack.back();
+        stack.pop_back();
+        stats->nodes++;
+        stats->nodeMeshes += visit.node->mNumMeshes;
+        stats->maxDepth = visit.depth > stats->maxDepth ? visit.depth : stats->maxDepth;
+        stats->cpuBytes += sizeof(model_node_t);
+        for (unsigned int i = 0; i < visit.node->mNumChildren; i++)
+        {
+            node_visit_t child = {&(visit.node->mChildren[i]), visit.depth + 1};
+            stack.push_back(child);
+        }
+    }
+
+    unsigned long long instanceBytes = 0;
+    for (unsigned int i = 0; i < model->mNumMeshes; i++)
+        instanceBytes += stats->meshStats[i].instanceBytes;
+    stats->gpuBytes = stats->textureBytes + instanceBytes;
+}
+
+static imgui_model_stats_t *GetModelStats(const model_t *model)
+{
+    imgui_model_stats_t *stats = NULL;
+    for (int i = 0; i < modelStats.Size; i++)
+    {
+        if (modelStats[i]->model == model)
+        {
+            stats = modelStats[i];
+            break;
+        }
+    }
+    if (stats == NULL)
+    {
+        stats = IM_NEW(imgui_model_stats_t)();
+        stats->model = model;
+        stats->key = 0;
+        modelStats.push_back(stats);
+    }
+
+    unsigned long long key = ModelKey(model);
+    if (stats->key != key)
+    {
+        ComputeModelStats(stats, model);
+        stats->key = key;
+        if (sortStats == stats)
+            sortStats = NULL;
+    }
+    return stats;
+}
+
+void imgui_model_stats_cleanup()
+{
+    for (int i = 0; i < modelStats.Size; i++)
+        IM_DELETE(modelStats[i]);
+    modelStats.clear();
+    sortStats = NULL;
+}
+
+static void ShowBytes(const char *label, unsigned long long bytes)
+{
+    if (bytes >= 1024ULL * 1024ULL)
+        ImGui::Text("%s: %.2f MiB", label, (double)bytes / (1024.0 * 1024.0));
+    else
+        ImGui::Text("%s: %.2f KiB", label, (double)bytes / 1024.0);
+}
+
+static int CompareMeshStats(const void *lhs, const void *rhs)
+{
+    const imgui_mesh_stats_t *a = (const imgui_mesh_stats_t *)lhs;
+    const imgui_mesh_stats_t *b = (const imgui_mesh_stats_t *)rhs;
+    for (int n = 0; n < sortSpecs->SpecsCount; n++)
+    {
+        const ImGuiTableColumnSortSpecs *spec = &(sortSpecs->Specs[n]);
+        unsigned long long va = 0, vb = 0;
+        switch (spec->ColumnIndex)
+        {
+        case 0:
+            va = a->index;
+            vb = b->index;
+            break;
+        case 1:
+            va = a->instances;
+            vb = b->instances;
+            break;
+        case 2:
+            va = a->instanceBytes;
+            vb = b->instanceBytes;
+            break;
+        case 3:
+            va = a->textureBytes;
+            vb = b->textureBytes;
+            break;
+        default:
+            va = a->instanceBytes + a->textureBytes;
+            vb = b->instanceBytes + b->textureBytes;
+            break;
+        }
+        if (va != vb)
+        {
+            int delta = va < vb ? -1 : 1;
+            return spec->SortDirection == ImGuiSortDirection_Ascending ? delta : -delta;
+        }
+    }
+    return (int)a->index - (int)b->index;
+}
+
+static void ShowHeaviestMeshes(imgui_model_stats_t *stats)
+{
+    static thread_local int topN = 16;
+    ImGui::SliderInt("Top N", &topN, 1, 256);
+
+    const ImGuiTableFlags flags = ImGuiTableFlags_Sortable | ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersOuter | ImGuiTableFlags_BordersV | ImGuiTableFlags_ScrollY;
+    ImVec2 outerSize = ImVec2(0.0f, ImGui::GetTextLineHeightWithSpacing() * 12);
+    if (!ImGui::BeginTable("Heaviest Meshes", 5, flags, outerSize))
+        return;
+    ImGui::TableSetupScrollFreeze(0, 1);
+    ImGui::TableSetupColumn("Mesh");
+    ImGui::TableSetupColumn("Instances");
+    ImGui::TableSetupColumn("Instance KiB");
+    ImGui::TableSetupColumn("Texture KiB");
+    ImGui::TableSetupColumn("Total KiB", ImGuiTableColumnFlags_DefaultSort | ImGuiTableColumnFlags_PreferSortDescending);
+    ImGui::TableHeadersRow();
+
+    // Only re-sort when the specs or the cached data changed.
+    ImGuiTableSortSpecs *specs = ImGui::TableGetSortSpecs();
+    if (specs != NULL && (specs->SpecsDirty || sortStats != stats) && stats->meshStats.Size > 1)
+    {
+        sortSpecs = specs;
+        qsort(stats->meshStats.Data, (size_t)stats->meshStats.Size, sizeof(imgui_mesh_stats_t), CompareMeshStats);
+        sortSpecs = NULL;
+        sortStats = stats;
+        specs->SpecsDirty = false;
+    }
+
+    int rows = stats->meshStats.Size < topN ? stats->meshStats.Size : topN;
+    ImGuiListClipper clipper;
+    clipper.Begin(rows);
+    while (clipper.Step())
+    {
+        for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; row++)
+        {
+            const imgui_mesh_stats_t *mesh = &(stats->meshStats[row]);
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("%u", mesh->index);
+            ImGui::TableNextColumn();
+            ImGui::Text("%u", mesh->instances);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1f", (double)mesh->instanceBytes / 1024.0);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1f", (double)mesh->textureBytes / 1024.0);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1f", (double)(mesh->instanceBytes + mesh->textureBytes) / 1024.0);
+        }
+    }
+    ImGui::EndTable();
+}
+
+void ShowModelStats(model_t *model)
+{
+    imgui_model_stats_t *stats = GetModelStats(model);
+    ImGui::Text("Meshes: %u  Materials: %u", stats->meshes, stats->materials);
+    ImGui::Text("Instances: %u", stats->instances);
+    ImGui::Text("Nodes: %u  Max Depth: %u  Node Meshes: %u", stats->nodes, stats->maxDepth, stats->nodeMeshes);
+    ImGui::Text("Textures: %u (%u unique)", stats->textures, stats->uniqueTextures);
+    ShowBytes("CPU", stats->cpuBytes);
+    ShowBytes("GPU", stats->gpuBytes);
+    ShowBytes("GPU Textures", stats->textureBytes);
+
+    imgui_open_next_tree();
+    if (stats->materials > 0 && ImGui::TreeNode("Material Memory"))
+    {
+        ImGuiListClipper clipper;
+        clipper.Begin(stats->materialBytes.Size);
+        while (clipper.Step())
+        {
+            for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++)
+                ImGui::Text("Material %d: %.1f KiB", i, (double)stats->materialBytes[i] / 1024.0);
+        }
+        ImGui::TreePop();
+    }
+    imgui_open_next_tree();
+    if (stats->meshes > 0 && ImGui::TreeNode("Heaviest Meshes"))
+    {
+        ShowHeaviestMeshes(stats);
+        ImGui::TreePop();
+    }
+}
+
+void ShowSceneStats(unsigned int num_models, model_t *model)
+{
+    unsigned int meshes = 0, materials = 0, instances = 0, nodes = 0, maxDepth = 0, textures = 0;
+    unsigned long long cpuBytes = 0, gpuBytes = 0;
+    for (unsigned int i = 0; i < num_models; i++)
+    {
+        const imgui_model_stats_t *stats = GetModelStats(&(model[i]));
+        meshes += stats->meshes;
+        materials += stats->materials;
+        instances += stats->instances;
+        nodes += stats->nodes;
+        textures += stats->textures;
+        maxDepth = stats->maxDepth > maxDepth ? stats->maxDepth : maxDepth;
+        cpuBytes += stats->cpuBytes;
+        gpuBytes += stats->gpuBytes;
+    }
+    ImGui::Text("Models: %u  Meshes: %u  Materials: %u", num_models, meshes, materials);
+    ImGui::Text("Instances: %u  Nodes: %u  Max Depth: %u", instances, nodes, maxDepth);
+    ImGui::Text("Textures: %u", textures);
+    ShowBytes("CPU", cpuBytes);
+    ShowBytes("GPU", gpuBytes);
+}
@@ -0,0 +1,203 @@
+#include <stdlib.h>
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include <nonstd.h>
+#include <nonstd_glfw_opengl.h>
+#include <tile_map.h>
+#include "nonstd_imgui.h"
+
+typedef struct imgui_profiler_query_s
+{
+    GLuint query;
+    int pending;
+    unsigned long long frame;
+} imgui_profiler_query_t;
+
+typedef struct imgui_profiler_s
+{
+    imgui_profiler_frame_t frames[IMGUI_PROFILER_MAX_FRAMES];
+    unsigned long long frameIndex;
+    int inFrame;
+    int depth;
+    unsigned int stack[IMGUI_PROFILER_MAX_SCOPES];
+
+    int gpuSupported;
+    int gpuActive;
+    imgui_profiler_query_t queries[IMGUI_PROFILER_GPU_QUERIES];
+} imgui_profiler_t;
+
+// Fixed-size ring of frames, nothing is allocated after imgui_profiler_init. Each
+// GUI times its own frames; threads that have not bound one use the default.
+static imgui_profiler_t defaultProfiler;
+static thread_local imgui_profiler_t *profiler = &defaultProfiler;
+
+imgui_profiler_t *imgui_profiler_init()
+{
+    profiler = (imgui_profiler_t *)calloc(1, sizeof(imgui_profiler_t));
+    if (profiler == NULL)
+    {
+        profiler = &defaultProfiler;
+        return NULL;
+    }
+    profiler->gpuSupported = GLEW_VERSION_3_3 || GLEW_ARB_timer_query;
+    if (profiler->gpuSupported)
+    {
+        for (unsigned int i = 0; i < IMGUI_PROFILER_GPU_QUERIES; i++)
+        {
+            glGenQueries(1, &(profiler->queries[i].query));
+        }
+    }
+    return profiler;
+}
+
+int imgui_profiler_cleanup()
+{
+    if (profiler->gpuSupported)
+    {
+        for (unsigned int i = 0; i < IMGUI_PROFILER_GPU_QUERIES; i++)
+        {
+            glDeleteQueries(1, &(profiler->queries[i].query));
+        }
+    }
+    if (profiler != &defaultProfiler)
+        free(profiler);
+    profiler = &defaultProfiler;
+    return 0;
+}
+
+void imgui_profiler_bind(imgui_profiler_t *bound)
+{
+    profiler = bound != NULL ? bound : &defaultProfiler;
+}
+
+static imgui_profiler_frame_t *imgui_profiler_current()
+{
+    return &(profiler->frames[profiler->frameIndex % IMGUI_PROFILER_MAX_FRAMES]);
+}
+
+// Collects finished timer queries without ever waiting on the GPU.
+static void imgui_profiler_poll_queries()
+{
+    for (unsigned int i = 0; i < IMGUI_PROFILER_GPU_QUERIES; i++)
+    {
+        imgui_profiler_query_t *q = &(profiler->queries[i]);
+        if (!q->pending)
+            continue;
+
+        GLint available = 0;
+        glGetQueryObjectiv(q->query, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available)
+            continue;
+
+        GLuint64 elapsed = 0;
+        glGetQueryObjectui64v(q->query, GL_QUERY_RESULT, &elapsed);
+        q->pending = 0;
+        if (profiler->frameIndex - q->frame < IMGUI_PROFILER_MAX_FRAMES)
+        {
+            profiler->frames[q->frame % IMGUI_PROFILER_MAX_FRAMES].gpuTime = (double)elapsed * 1e-9;
+        }
+    }
+}
+
+void imgui_profiler_begin_frame()
+{
+    if (profiler->gpuSupported)
+        imgui_profiler_poll_queries();
+
+    imgui_profiler_frame_t *frame = imgui_profiler_current();
+    frame->start = glfwGetTime();
+    frame->end = frame->start;
+    frame->gpuTime = -1.0;
+    frame->numScopes = 0;
+    profiler->depth = 0;
+    profiler->inFrame = 1;
+}
+
+void imgui_profiler_end_frame()
+{
+    if (!profiler->inFrame)
+        return;
+    while (profiler->depth > 0)
+        imgui_profiler_pop();
+
+    imgui_profiler_current()->end = glfwGetTime();
+    profiler->inFrame = 0;
+    profiler->frameIndex++;
+}
+
+void imgui_profiler_push(const char *name)
+{
+    imgui_profiler_frame_t *frame = imgui_profiler_current();
+    if (!profiler->inFrame || frame->numScopes >= IMGUI_PROFILER_MAX_SCOPES)
+    {
+        // Still track the depth so the matching pop stays balanced.
+        if (profiler->depth < IMGUI_PROFILER_MAX_SCOPES)
+            profiler->stack[profiler->depth] = IMGUI_PROFILER_MAX_SCOPES;
+        profiler->depth++;
+        return;
+    }
+
+    imgui_profiler_scope_t *scope = &(frame->scopes[frame->numScopes]);
+    scope->name = name;
+    scope->depth = profiler->depth;
+    scope->start = glfwGetTime();
+    scope->end = scope->start;
+    if (profiler->depth < IMGUI_PROFILER_MAX_SCOPES)
+        profiler->stack[profiler->depth] = frame->numScopes;
+    profiler->depth++;
+    frame->numScopes++;
+}
+
+void imgui_profiler_pop()
+{
+    if (profiler->depth <= 0)
+        return;
+    profiler->depth--;
+    if (profiler->depth >= IMGUI_PROFILER_MAX_SCOPES)
+        return;
+
+    unsigned int index = profiler->stack[profiler->depth];
+    if (index < IMGUI_PROFILER_MAX_SCOPES)
+        imgui_profiler_current()->scopes[index].end = glfwGetTime();
+}
+
+void imgui_profiler_gpu_begin()
+{
+    if (!profiler->gpuSupported || !profiler->inFrame)
+        return;
+
+    // If the slot is still in flight the GPU is more than IMGUI_PROFILER_GPU_QUERIES
+    // frames behind; skip this frame rather than stall on the old result.
+    imgui_profiler_query_t *q = &(profiler->queries[profiler->frameIndex % IMGUI_PROFILER_GPU_QUERIES]);
+    if (q->pending)
+        return;
+
+    glBeginQuery(GL_TIME_ELAPSED, q->query);
+    q->frame = profiler->frameIndex;
+    profiler->gpuActive = 1;
+}
+
+void imgui_profiler_gpu_end()
+{
+    if (!profiler->gpuActive)
+        return;
+
+    glEndQuery(GL_TIME_ELAPSED);
+    profiler->queries[profiler->frameIndex % IMGUI_PROFILER_GPU_QUERIES].pending = 1;
+    profiler->gpuActive = 0;
+}
+
+unsigned int imgui_profiler_num_frames()
+{
+    return profiler->frameIndex < IMGUI_PROFILER_MAX_FRAMES ? (unsigned int)profiler->frameIndex : IMGUI_PROFILER_MAX_FRAMES;
+}
+
+// framesAgo == 0 is the most recently completed frame.
+const imgui_profiler_frame_t *imgui_profiler_get_frame(unsigned int framesAgo)
+{
+    if (framesAgo >= imgui_profiler_num_frames())
+        return NULL;
+    return &(profiler->frames[(profiler->frameIndex - 1 - framesAgo) % IMGUI_PROFILER_MAX_FRAMES]);
+}
@@ -0,0 +1,399 @@
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define PROJECTION_X86 1
+#endif
+
+#include <nonstd.h>
+#include <nonstd_glfw_opengl.h>
+#include <tile_map.h>
+#include "nonstd_imgui.h"
+
+#define PROJECTION_PI 3.14159265358979323846
+#define PROJECTION_DEG2RAD (PROJECTION_PI / 180.0)
+#define PROJECTION_LN2 0.69314718055994530942
+#define PROJECTION_SQRT2 1.41421356237309504880
+
+// Mercator diverges at the poles, latitudes are clamped to this (in degrees).
+#define PROJECTION_MAX_LAT 89.5
+
+// Single precision constants shared by every kernel, derived once per call.
+typedef struct projection_constants_s
+{
+    int mercator;
+    float lon0;     // radians
+    float kx;       // meters per radian of longitude
+    float ky;       // meters per radian of latitude (equirectangular) or per unit isometric latitude
+    float x0;
+    float y0;
+    float e;        // first eccentricity
+    float maxLat;   // degrees
+} projection_constants_t;
+
+static double projection_eccentricity(const imgui_projection_t *p, double *a)
+{
+    *a = p->a > 0.0 ? p->a : 1.0;
+    double b = p->b > 0.0 && p->b < *a ? p->b : *a;
+    return sqrt(1.0 - (b * b) / (*a * *a));
+}
+
+static double projection_scale(const imgui_projection_t *p)
+{
+    return p->k0 != 0.0 ? p->k0 : 1.0;
+}
+
+static void projection_constants(const imgui_projection_t *p, projection_constants_t *c)
+{
+    double a = 0.0;
+    double e = projection_eccentricity(p, &a);
+    double ak = a * projection_scale(p);
+    c->mercator = p->type == IMGUI_PROJECTION_MERCATOR;
+    c->lon0 = (float)(p->lon0 * PROJECTION_DEG2RAD);
+    c->kx = (float)(c->mercator ? ak : ak * cos(p->lat0 * PROJECTION_DEG2RAD));
+    c->ky = (float)(c->mercator ? ak * 0.5 : ak);
+    c->x0 = (float)p->x0;
+    c->y0 = (float)p->y0;
+    c->e = (float)e;
+    c->maxLat = (float)PROJECTION_MAX_LAT;
+}
+
+// sin(x) for |x| <= pi/2, Taylor series to x^11 (error < 1e-7 on that range).
+static inline float projection_sinf(float x)
+{
+    float x2 = x * x;
+    float p = -2.5052108e-08f;
+    p = p * x2 + 2.7557319e-06f;
+    p = p * x2 - 1.9841270e-04f;
+    p = p * x2 + 8.3333333e-03f;
+    p = p * x2 - 1.6666667e-01f;
+    return x + x * x2 * p;
+}
+
+// cos(x) for |x| <= pi/2, Taylor series to x^12.
+static inline float projection_cosf(float x)
+{
+    float x2 = x * x;
+    float p = 2.0876757e-09f;
+    p = p * x2 - 2.7557319e-07f;
+    p = p * x2 + 2.4801587e-05f;
+    p = p * x2 - 1.3888889e-03f;
+    p = p * x2 + 4.1666667e-02f;
+    p = p * x2 - 0.5f;
+    return 1.0f + x2 * p;
+}
+
+// ln(x) for finite x > 0: exponent split, then 2 atanh(z) with z = (m - 1) / (m + 1).
+static inline float projection_logf(float x)
+{
+    uint32_t bits;
+    memcpy(&bits, &x, sizeof(bits));
+    int exponent = (int)((bits >> 23) & 0xff) - 127;
+    bits = (bits & 0x007fffff) | 0x3f800000;
+    float m;
+    memcpy(&m, &bits, sizeof(m));
+    if (m > (float)PROJECTION_SQRT2)
+    {
+        m *= 0.5f;
+        exponent++;
+    }
+    float z = (m - 1.0f) / (m + 1.0f);
+    float z2 = z * z;
+    float p = 1.0f / 9.0f;
+    p = p * z2 + 1.0f / 7.0f;
+    p = p * z2 + 1.0f / 5.0f;
+    p = p * z2 + 1.0f / 3.0f;
+    p = p * z2 + 1.0f;
+    return (float)exponent * (float)PROJECTION_LN2 + 2.0f * z * p;
+}
+
+// The isometric latitude ln((1 + sin phi) / (1 - sin phi)) is evaluated as
+// 2 ln(cot u) with u = (90 - |lat|) / 2, which keeps full precision near the
+// poles where 1 - sin phi cancels in single precision.
+static void projection_forward_scalar(const projection_constants_t *c, const float *lon, const float *lat, float *x, float *y, unsigned int n)
+{
+    const float deg2rad = (float)PROJECTION_DEG2RAD;
+    const float halfDeg2rad = (float)(PROJECTION_DEG2RAD * 0.5);
+    for (unsigned int i = 0; i < n; i++)
+    {
+        float latitude = lat[i] > c->maxLat ? c->maxLat : (lat[i] < -c->maxLat ? -c->maxLat : lat[i]);
+        x[i] = c->x0 + c->kx * (lon[i] * deg2rad - c->lon0);
+        if (c->mercator)
+        {
+            float u = (90.0f - fabsf(latitude)) * halfDeg2rad;
+            float q = 2.0f * projection_logf(projection_cosf(u) / projection_sinf(u));
+            q = latitude < 0.0f ? -q : q;
+            float es = c->e * projection_sinf(latitude * deg2rad);
+            q -= c->e * projection_logf((1.0f + es) / (1.0f - es));
+            y[i] = c->y0 + c->ky * q;
+        }
+        else
+        {
+            y[i] = c->y0 + c->ky * latitude * deg2rad;
+        }
+    }
+}
+
+#ifdef PROJECTION_X86
+
+static inline __m128 projection_sin_sse(__m128 x)
+{
+    __m128 x2 = _mm_mul_ps(x, x);
+    __m128 p = _mm_set1_ps(-2.5052108e-08f);
+    p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(2.7557319e-06f));
+    p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(-1.9841270e-04f));
+    p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(8.3333333e-03f));
+    p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(-1.6666667e-01f));
+    return _mm_add_ps(x, _mm_mul_ps(_mm_mul_ps(x, x2), p));
+}
+
+static inline __m128 projection_cos_sse(__m128 x)
+{
+    __m128 x2 = _mm_mul_ps(x, x);
+    __m128 p = _mm_set1_ps(2.0876757e-09f);
+    p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(-2.7557319e-07f));
+    p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(2.4801587e-05f));
+    p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(-1.3888889e-03f));
+    p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(4.1666667e-02f));
+    p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(-0.5f));
+    return _mm_add_ps(_mm_set1_ps(1.0f), _mm_mul_ps(x2, p));
+}
+
+static inline __m128 projection_log_sse(__m128 x)
+{
+    __m128i bits = _mm_castps_si128(x);
+    __m128i exponent = _mm_sub_epi32(_mm_and_si128(_mm_srli_epi32(bits, 23), _mm_set1_epi32(0xff)), _mm_set1_epi32(127));
+    __m128 m = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x007fffff)), _mm_set1_epi32(0x3f800000)));
+    __m128 big = _mm_cmpgt_ps(m, _mm_set1_ps((float)PROJECTION_SQRT2));
+    m = _mm_or_ps(_mm_and_ps(big, _mm_mul_ps(m, _mm_set1_ps(0.5f))), _mm_andnot_ps(big, m));
+    __m128 e = _mm_add_ps(_mm_cvtepi32_ps(exponent), _mm_and_ps(big, _mm_set1_ps(1.0f)));
+
+    __m128 one = _mm_set1_ps(1.0f);
+    __m128 z = _mm_div_ps(_mm_sub_ps(m, one), _mm_add_ps(m, one));
+    __m128 z2 = _mm_mul_ps(z, z);
+    __m128 p = _mm_set1_ps(1.0f / 9.0f);
+    p = _mm_add_ps(_mm_mul_ps(p, z2), _mm_set1_ps(1.0f / 7.0f));
+    p = _mm_add_ps(_mm_mul_ps(p, z2), _mm_set1_ps(1.0f / 5.0f));
+    p = _mm_add_ps(_mm_mul_ps(p, z2), _mm_set1_ps(1.0f / 3.0f));
+    p = _mm_add_ps(_mm_mul_ps(p, z2), one);
+    return _mm_add_ps(_mm_mul_ps(e, _mm_set1_ps((float)PROJECTION_LN2)), _mm_mul_ps(_mm_add_ps(z, z), p));
+}
+
+static void projection_forward_sse(const projection_constants_t *c, const float *lon, const float *lat, float *x, float *y, unsigned int n)
+{
+    const __m128 deg2rad = _mm_set1_ps((float)PROJECTION_DEG2RAD);
+    const __m128 halfDeg2rad = _mm_set1_ps((float)(PROJECTION_DEG2RAD * 0.5));
+    const __m128 maxLat = _mm_set1_ps(c->maxLat);
+    const __m128 minLat = _mm_set1_ps(-c->maxLat);
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    const __m128 ninety = _mm_set1_ps(90.0f);
+    const __m128 two = _mm_set1_ps(2.0f);
+    const __m128 lon0 = _mm_set1_ps(c->lon0);
+    const __m128 kx = _mm_set1_ps(c->kx);
+    const __m128 ky = _mm_set1_ps(c->ky);
+    const __m128 x0 = _mm_set1_ps(c->x0);
+    const __m128 y0 = _mm_set1_ps(c->y0);
+    const __m128 e = _mm_set1_ps(c->e);
+    const __m128 one = _mm_set1_ps(1.0f);
+
+    unsigned int i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128 latitude = _mm_max_ps(_mm_min_ps(_mm_loadu_ps(lat + i), maxLat), minLat);
+        __m128 lambda = _mm_mul_ps(_mm_loadu_ps(lon + i), deg2rad);
+        _mm_storeu_ps(x + i, _mm_add_ps(x0, _mm_mul_ps(kx, _mm_sub_ps(lambda, lon0))));
+        if (c->mercator)
+        {
+            __m128 sign = _mm_and_ps(latitude, signMask);
+            __m128 u = _mm_mul_ps(_mm_sub_ps(ninety, _mm_andnot_ps(signMask, latitude)), halfDeg2rad);
+            __m128 q = _mm_mul_ps(two, projection_log_sse(_mm_div_ps(projection_cos_sse(u), projection_sin_sse(u))));
+            q = _mm_xor_ps(q, sign);
+            __m128 es = _mm_mul_ps(e, projection_sin_sse(_mm_mul_ps(latitude, deg2rad)));
+            q = _mm_sub_ps(q, _mm_mul_ps(e, projection_log_sse(_mm_div_ps(_mm_add_ps(one, es), _mm_sub_ps(one, es)))));
+            _mm_storeu_ps(y + i, _mm_add_ps(y0, _mm_mul_ps(ky, q)));
+        }
+        else
+        {
+            _mm_storeu_ps(y + i, _mm_add_ps(y0, _mm_mul_ps(ky, _mm_mul_ps(latitude, deg2rad))));
+        }
+    }
+    projection_forward_scalar(c, lon + i, lat + i, x + i, y + i, n - i);
+}
+
+#pragma GCC push_options
+#pragma GCC target("avx2,fma")
+
+static inline __m256 projection_sin_avx2(__m256 x)
+{
+    __m256 x2 = _mm256_mul_ps(x, x);
+    __m256 p = _mm256_set1_ps(-2.5052108e-08f);
+    p = _mm256_fmadd_ps(p, x2, _mm256_set1_ps(2.7557319e-06f));
+    p = _mm256_fmadd_ps(p, x2, _mm256_set1_ps(-1.9841270e-04f));
+    p = _mm256_fmadd_ps(p, x2, _mm256_set1_ps(8.3333333e-03f));
+    p = _mm256_fmadd_ps(p, x2, _mm256_set1_ps(-1.6666667e-01f));
+    return _mm256_fmadd_ps(_mm256_mul_ps(x, x2), p, x);
+}
+
+static inline __m256 projection_cos_avx2(__m256 x)
+{
+    __m256 x2 = _mm256_mul_ps(x, x);
+    __m256 p = _mm256_set1_ps(2.0876757e-09f);
+    p = _mm256_fmadd_ps(p, x2, _mm256_set1_ps(-2.7557319e-07f));
+    p = _mm256_fmadd_ps(p, x2, _mm256_set1_ps(2.4801587e-05f));
+    p = _mm256_fmadd_ps(p, x2, _mm256_set1_ps(-1.3888889e-03f));
+    p = _mm256_fmadd_ps(p, x2, _mm256_set1_ps(4.1666667e-02f));
+    p = _mm256_fmadd_ps(p, x2, _mm256_set1_ps(-0.5f));
+    return _mm256_fmadd_ps(x2, p, _mm256_set1_ps(1.0f));
+}
+
+static inline __m256 projection_log_avx2(__m256 x)
+{
+    __m256i bits = _mm256_castps_si256(x);
+    __m256i exponent = _mm256_sub_epi32(_mm256_and_si256(_mm256_srli_epi32(bits, 23), _mm256_set1_epi32(0xff)), _mm256_set1_epi32(127));
+    __m256 m = _mm256_castsi256_ps(_mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi32(0x007fffff)), _mm256_set1_epi32(0x3f800000)));
+    __m256 big = _mm256_cmp_ps(m, _mm256_set1_ps((float)PROJECTION_SQRT2), _CMP_GT_OQ);
+    m = _mm256_blendv_ps(m, _mm256_mul_ps(m, _mm256_set1_ps(0.5f)), big);
+    __m256 e = _mm256_add_ps(_mm256_cvtepi32_ps(exponent), _mm256_and_ps(big, _mm256_set1_ps(1.0f)));
+
+    __m256 one = _mm256_set1_ps(1.0f);
+    __m256 z = _mm256_div_ps(_mm256_sub_ps(m, one), _mm256_add_ps(m, one));
+    __m256 z2 = _mm256_mul_ps(z, z);
+    __m256 p = _mm256_set1_ps(1.0f / 9.0f);
+    p = _mm256_fmadd_ps(p, z2, _mm256_set1_ps(1.0f / 7.0f));
+    p = _mm256_fmadd_ps(p, z2, _mm256_set1_ps(1.0f / 5.0f));
+    p = _mm256_fmadd_ps(p, z2, _mm256_set1_ps(1.0f / 3.0f));
+    p = _mm256_fmadd_ps(p, z2, one);
+    return _mm256_fmadd_ps(e, _mm256_set1_ps((float)PROJECTION_LN2), _mm256_mul_ps(_mm256_add_ps(z, z), p));
+}
+
+static void projection_forward_avx2(const projection_constants_t *c, const float *lon, const float *lat, float *x, float *y, unsigned int n)
+{
+    const __m256 deg2rad = _mm256_set1_ps((float)PROJECTION_DEG2RAD);
+    const __m256 halfDeg2rad = _mm256_set1_ps((float)(PROJECTION_DEG2RAD * 0.5));
+    const __m256 maxLat = _mm256_set1_ps(c->maxLat);
+    const __m256 minLat = _mm256_set1_ps(-c->maxLat);
+    const __m256 signMask = _mm256_set1_ps(-0.0f);
+    const __m256 ninety = _mm256_set1_ps(90.0f);
+    const __m256 two = _mm256_set1_ps(2.0f);
+    const __m256 lon0 = _mm256_set1_ps(c->lon0);
+    const __m256 kx = _mm256_set1_ps(c->kx);
+    const __m256 ky = _mm256_set1_ps(c->ky);
+    const __m256 x0 = _mm256_set1_ps(c->x0);
+    const __m256 y0 = _mm256_set1_ps(c->y0);
+    const __m256 e = _mm256_set1_ps(c->e);
+    const __m256 one = _mm256_set1_ps(1.0f);
+
+    unsigned int i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256 latitude = _mm256_max_ps(_mm256_min_ps(_mm256_loadu_ps(lat + i), maxLat), minLat);
+        __m256 lambda = _mm256_mul_ps(_mm256_loadu_ps(lon + i), deg2rad);
+        _mm256_storeu_ps(x + i, _mm256_fmadd_ps(kx, _mm256_sub_ps(lambda, lon0), x0));
+        if (c->mercator)
+        {
+            __m256 sign = _mm256_and_ps(latitude, signMask);
+            __m256 u = _mm256_mul_ps(_mm256_sub_ps(ninety, _mm256_andnot_ps(signMask, latitude)), halfDeg2rad);
+            __m256 q = _mm256_mul_ps(two, projection_log_avx2(_mm256_div_ps(projection_cos_avx2(u), projection_sin_avx2(u))));
+            q = _mm256_xor_ps(q, sign);
+            __m256 es = _mm256_mul_ps(e, projection_sin_avx2(_mm256_mul_ps(latitude, deg2rad)));
+            q = _mm256_fnmadd_ps(e, projection_log_avx2(_mm256_div_ps(_mm256_add_ps(one, es), _mm256_sub_ps(one, es))), q);
+            _mm256_storeu_ps(y + i, _mm256_fmadd_ps(ky, q, y0));
+        }
+        else
+        {
+            _mm256_storeu_ps(y + i, _mm256_fmadd_ps(ky, _mm256_mul_ps(latitude, deg2rad), y0));
+        }
+    }
+    projection_forward_scalar(c, lon + i, lat + i, x + i, y + i, n - i);
+}
+
+#pragma GCC pop_options
+
+#endif /* PROJECTION_X86 */
+
+typedef void (*projection_kernel_fn)(const projection_constants_t *c, const float *lon, const float *lat, float *x, float *y, unsigned int n);
+
+static projection_kernel_fn projectionKernel = NULL;
+static const char *projectionKernelName = "scalar";
+
+static void projection_select_kernel()
+{
+    projectionKernel = projection_forward_scalar;
+#ifdef PROJECTION_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+    {
+        projectionKernel = projection_forward_avx2;
+        projectionKernelName = "avx2";
+    }
+    else if (__builtin_cpu_supports("sse2"))
+    {
+        projectionKernel = projection_forward_sse;
+        projectionKernelName = "sse2";
+    }
+#endif
+}
+
+void imgui_projection_forward(const imgui_projection_t *projection, const float *lon, const float *lat, float *x, float *y, unsigned int n)
+{
+    if (projectionKernel == NULL)
+        projection_select_kernel();
+    projection_constants_t c;
+    projection_constants(projection, &c);
+    projectionKernel(&c, lon, lat, x, y, n);
+}
+
+const char *imgui_projection_kernel_name()
+{
+    if (projectionKernel == NULL)
+        projection_select_kernel();
+    return projectionKernelName;
+}
+
+void imgui_projection_forward_reference(const imgui_projection_t *projection, double lon, double lat, double *x, double *y)
+{
+    double a = 0.0;
+    double e = projection_eccentricity(projection, &a);
+    double ak = a * projection_scale(projection);
+    double lambda = (lon - projection->lon0) * PROJECTION_DEG2RAD;
+    double phi = (lat > PROJECTION_MAX_LAT ? PROJECTION_MAX_LAT : (lat < -PROJECTION_MAX_LAT ? -PROJECTION_MAX_LAT : lat)) * PROJECTION_DEG2RAD;
+    if (projection->type == IMGUI_PROJECTION_MERCATOR)
+    {
+        double s = sin(phi);
+        *x = projection->x0 + ak * lambda;
+        *y = projection->y0 + ak * (atanh(s) - e * atanh(e * s));
+    }
+    else
+    {
+        *x = projection->x0 + ak * cos(projection->lat0 * PROJECTION_DEG2RAD) * lambda;
+        *y = projection->y0 + ak * phi;
+    }
+}
+
+void imgui_projection_inverse_reference(const imgui_projection_t *projection, double x, double y, double *lon, double *lat)
+{
+    double a = 0.0;
+    double e = projection_eccentricity(projection, &a);
+    double ak = a * projection_scale(projection);
+    if (projection->type == IMGUI_PROJECTION_MERCATOR)
+    {
+        // Fixed point iteration on the isometric latitude, converges in a few steps for e < 0.1.
+        double t = exp(-(y - projection->y0) / ak);
+        double phi = PROJECTION_PI / 2.0 - 2.0 * atan(t);
+        for (int i = 0; i < 8; i++)
+        {
+            double es = e * sin(phi);
+            phi = PROJECTION_PI / 2.0 - 2.0 * atan(t * pow((1.0 - es) / (1.0 + es), 0.5 * e));
+        }
+        *lat = phi / PROJECTION_DEG2RAD;
+        *lon = projection->lon0 + (x - projection->x0) / ak / PROJECTION_DEG2RAD;
+    }
+    else
+    {
+        double kx = ak * cos(projection->lat0 * PROJECTION_DEG2RAD);
+        *lat = (y - projection->y0) / ak / PROJECTION_DEG2RAD;
+        *lon = projection->lon0 + (kx != 0.0 ? (x - projection->x0) / kx / PROJECTION_DEG2RAD : 0.0);
+    }
+}
@@ -0,0 +1,461 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include <imgui.h>
+#include <imgui_impl_opengl3.h>
+
+#include <nonstd.h>
+#include <nonstd_glfw_opengl.h>
+#include <tile_map.h>
+#include "nonstd_imgui.h"
+
+// Number of frames the ring can have in flight before a write has to wait.
+#define IMGUI_RENDERER_SEGMENTS 3
+#define IMGUI_RENDERER_MIN_VERTICES (1 << 16)
+#define IMGUI_RENDERER_MIN_INDICES (1 << 17)
+
+typedef struct imgui_renderer_s
+{
+    int streaming;
+    GLuint program;
+    GLint locProjMtx;
+    GLint locTexture;
+    GLuint vao;
+    GLuint vbo;
+    GLuint ibo;
+    ImDrawVert *vtxMap;
+    ImDrawIdx *idxMap;
+    unsigned int segmentVertices;
+    unsigned int segmentIndices;
+    GLsync fences[IMGUI_RENDERER_SEGMENTS];
+    unsigned int segment;
+
+    // Reused every frame for the batched multi-draw arguments.
+    ImVector<GLsizei> counts;
+    ImVector<void *> offsets;
+    ImVector<GLint> baseVertices;
+
+    imgui_renderer_stats_t stats;
+} imgui_renderer_t;
+
+// Each GUI has its own renderer since GL objects belong to one context; the one a
+// thread draws with is bound by imgui_renderer_bind, threads without one use the default.
+static imgui_renderer_t defaultRenderer;
+static thread_local imgui_renderer_t *renderer = &defaultRenderer;
+
+static const char *vertexShaderSource =
+    "#version 330 core\n"
+    "layout (location = 0) in vec2 Position;\n"
+    "layout (location = 1) in vec2 UV;\n"
+    "layout (location = 2) in vec4 Color;\n"
+    "uniform mat4 ProjMtx;\n"
+    "out vec2 Frag_UV;\n"
+    "out vec4 Frag_Color;\n"
+    "void main()\n"
+    "{\n"
+    "    Frag_UV = UV;\n"
+    "    Frag_Color = Color;\n"
+    "    gl_Position = ProjMtx * vec4(Position.xy, 0, 1);\n"
+    "}\n";
+
+static const char *fragmentShaderSource =
+    "#version 330 core\n"
+    "in vec2 Frag_UV;\n"
+    "in vec4 Frag_Color;\n"
+    "uniform sampler2D Texture;\n"
+    "layout (location = 0) out vec4 Out_Color;\n"
+    "void main()\n"
+    "{\n"
+    "    Out_Color = Frag_Color * texture(Texture, Frag_UV.st);\n"
+    "}\n";
+
+static GLuint imgui_renderer_compile(GLenum type, const char *source)
+{
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, NULL);
+    glCompileShader(shader);
+    GLint status = 0;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+    if (!status)
+    {
+        glDeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+static void imgui_renderer_destroy_buffers()
+{
+    for (unsigned int i = 0; i < IMGUI_RENDERER_SEGMENTS; i++)
+    {
+        if (renderer->fences[i] != NULL)
+        {
+            glClientWaitSync(renderer->fences[i], GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+            glDeleteSync(renderer->fences[i]);
+            renderer->fences[i] = NULL;
+        }
+    }
+    if (renderer->vbo != 0)
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, renderer->vbo);
+        glUnmapBuffer(GL_ARRAY_BUFFER);
+        glDeleteBuffers(1, &(renderer->vbo));
+        renderer->vbo = 0;
+        renderer->vtxMap = NULL;
+    }
+    if (renderer->ibo != 0)
+    {
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, renderer->ibo);
+        glUnmapBuffer(GL_ELEMENT_ARRAY_BUFFER);
+        glDeleteBuffers(1, &(renderer->ibo));
+        renderer->ibo = 0;
+        renderer->idxMap = NULL;
+    }
+}
+
+// (Re)creates the persistently mapped rings, each IMGUI_RENDERER_SEGMENTS segments long.
+static int imgui_renderer_create_buffers(unsigned int segmentVertices, unsigned int segmentIndices)
+{
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    GLsizeiptr vtxSize = (GLsizeiptr)segmentVertices * IMGUI_RENDERER_SEGMENTS * sizeof(ImDrawVert);
+    GLsizeiptr idxSize = (GLsizeiptr)segmentIndices * IMGUI_RENDERER_SEGMENTS * sizeof(ImDrawIdx);
+
+    glBindVertexArray(renderer->vao);
+
+    glGenBuffers(1, &(renderer->vbo));
+    glBindBuffer(GL_ARRAY_BUFFER, renderer->vbo);
+    glBufferStorage(GL_ARRAY_BUFFER, vtxSize, NULL, flags);
+    renderer->vtxMap = (ImDrawVert *)glMapBufferRange(GL_ARRAY_BUFFER, 0, vtxSize, flags);
+
+    glEnableVertexAttribArray(0);
+    glEnableVertexAttribArray(1);
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(ImDrawVert), (GLvoid *)offsetof(ImDrawVert, pos));
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(ImDrawVert), (GLvoid *)offsetof(ImDrawVert, uv));
+    glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(ImDrawVert), (GLvoid *)offsetof(ImDrawVert, col));
+
+    glGenBuffers(1, &(renderer->ibo));
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, renderer->ibo);
+    glBufferStorage(GL_ELEMENT_ARRAY_BUFFER, idxSize, NULL, flags);
+    renderer->idxMap = (ImDrawIdx *)glMapBufferRange(GL_ELEMENT_ARRAY_BUFFER, 0, idxSize, flags);
+
+    glBindVertexArray(0);
+
+    renderer->segmentVertices = segmentVertices;
+    renderer->segmentIndices = segmentIndices;
+    return renderer->vtxMap != NULL && renderer->idxMap != NULL;
+}
+
+static void imgui_renderer_release()
+{
+    imgui_renderer_destroy_buffers();
+    if (renderer->vao != 0)
+        glDeleteVertexArrays(1, &(renderer->vao));
+    if (renderer->program != 0)
+        glDeleteProgram(renderer->program);
+    renderer->vao = 0;
+    renderer->program = 0;
+    renderer->streaming = 0;
+    renderer->stats.streaming = 0;
+    renderer->counts.clear();
+    renderer->offsets.clear();
+    renderer->baseVertices.clear();
+}
+
+imgui_renderer_t *imgui_renderer_init()
+{
+    renderer = IM_NEW(imgui_renderer_t)();
+    if (!(GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage) || !(GLEW_VERSION_3_2 || GLEW_ARB_draw_elements_base_vertex))
+        return renderer;
+
+    GLuint vs = imgui_renderer_compile(GL_VERTEX_SHADER, vertexShaderSource);
+    GLuint fs = imgui_renderer_compile(GL_FRAGMENT_SHADER, fragmentShaderSource);
+    if (vs == 0 || fs == 0)
+    {
+        glDeleteShader(vs);
+        glDeleteShader(fs);
+        return renderer;
+    }
+    renderer->program = glCreateProgram();
+    glAttachShader(renderer->program, vs);
+    glAttachShader(renderer->program, fs);
+    glLinkProgram(renderer->program);
+    glDetachShader(renderer->program, vs);
+    glDetachShader(renderer->program, fs);
+    glDeleteShader(vs);
+    glDeleteShader(fs);
+    GLint status = 0;
+    glGetProgramiv(renderer->program, GL_LINK_STATUS, &status);
+    if (!status)
+    {
+        glDeleteProgram(renderer->program);
+        renderer->program = 0;
+        return renderer;
+    }
+    renderer->locProjMtx = glGetUniformLocation(renderer->program, "ProjMtx");
+    renderer->locTexture = glGetUniformLocation(renderer->program, "Texture");
+
+    glGenVertexArrays(1, &(renderer->vao));
+    if (!imgui_renderer_create_buffers(IMGUI_RENDERER_MIN_VERTICES, IMGUI_RENDERER_MIN_INDICES))
+    {
+        imgui_renderer_release();
+        return renderer;
+    }
+    renderer->segment = 0;
+    renderer->streaming = 1;
+    renderer->stats.streaming = 1;
+    return renderer;
+}
+
+int imgui_renderer_cleanup()
+{
+    imgui_renderer_release();
+    if (renderer != &defaultRenderer)
+        IM_DELETE(renderer);
+    renderer = &defaultRenderer;
+    return 0;
+}
+
+void imgui_renderer_bind(imgui_renderer_t *bound)
+{
+    renderer = bound != NULL ? bound : &defaultRenderer;
+}
+
+static void imgui_renderer_setup_state(ImDrawData *drawData, int fbWidth, int fbHeight)
+{
+    glEnable(GL_BLEND);
+    glBlendEquation(GL_FUNC_ADD);
+    glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    glDisable(GL_CULL_FACE);
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_STENCIL_TEST);
+    glEnable(GL_SCISSOR_TEST);
+    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+
+    glViewport(0, 0, (GLsizei)fbWidth, (GLsizei)fbHeight);
+    float L = drawData->DisplayPos.x;
+    float R = drawData->DisplayPos.x + drawData->DisplaySize.x;
+    float T = drawData->DisplayPos.y;
+    float B = drawData->DisplayPos.y + drawData->DisplaySize.y;
+    const float ortho[4][4] = {
+        {2.0f / (R - L), 0.0f, 0.0f, 0.0f},
+        {0.0f, 2.0f / (T - B), 0.0f, 0.0f},
+        {0.0f, 0.0f, -1.0f, 0.0f},
+        {(R + L) / (L - R), (T + B) / (B - T), 0.0f, 1.0f},
+    };
+    glUseProgram(renderer->program);
+    glUniform1i(renderer->locTexture, 0);
+    glUniformMatrix4fv(renderer->locProjMtx, 1, GL_FALSE, &ortho[0][0]);
+    glBindVertexArray(renderer->vao);
+    glActiveTexture(GL_TEXTURE0);
+}
+
+static void imgui_renderer_flush()
+{
+    if (renderer->counts.Size == 0)
+        return;
+    glMultiDrawElementsBaseVertex(GL_TRIANGLES, renderer->counts.Data, sizeof(ImDrawIdx) == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT,
+                                  (const void *const *)renderer->offsets.Data, renderer->counts.Size, renderer->baseVertices.Data);
+    renderer->stats.drawCalls++;
+    renderer->counts.resize(0);
+    renderer->offsets.resize(0);
+    renderer->baseVertices.resize(0);
+}
+
+// Writes every draw list of the frame into one segment of the persistent ring
+// and draws runs of commands sharing a texture and clip rect with one
+// glMultiDrawElementsBaseVertex each. Falls back to the stock backend when
+// ARB_buffer_storage is unavailable.
+void imgui_renderer_render(struct ImDrawData *drawData)
+{
+    if (!renderer->streaming)
+    {
+        ImGui_ImplOpenGL3_RenderDrawData(drawData);
+        return;
+    }
+
+    int fbWidth = (int)(drawData->DisplaySize.x * drawData->FramebufferScale.x);
+    int fbHeight = (int)(drawData->DisplaySize.y * drawData->FramebufferScale.y);
+    if (fbWidth <= 0 || fbHeight <= 0)
+        return;
+
+#if IMGUI_VERSION_NUM >= 19200
+    // Texture creation and updates are still owned by the stock backend.
+    if (drawData->Textures != NULL)
+        for (ImTextureData *tex : *drawData->Textures)
+            if (tex->Status != ImTextureStatus_OK)
+                ImGui_ImplOpenGL3_UpdateTexture(tex);
+#endif
+
+    renderer->stats.drawCalls = 0;
+    renderer->stats.bytes = 0;
+
+    if ((unsigned int)drawData->TotalVtxCount > renderer->segmentVertices || (unsigned int)drawData->TotalIdxCount > renderer->segmentIndices)
+    {
+        unsigned int vertices = renderer->segmentVertices;
+        unsigned int indices = renderer->segmentIndices;
+        while (vertices < (unsigned int)drawData->TotalVtxCount)
+            vertices *= 2;
+        while (indices < (unsigned int)drawData->TotalIdxCount)
+            indices *= 2;
+        imgui_renderer_destroy_buffers();
+        if (!imgui_renderer_create_buffers(vertices, indices))
+        {
+            // The renderer itself stays alive, it belongs to the GUI until imgui_cleanup.
+            imgui_renderer_destroy_buffers();
+            renderer->streaming = 0;
+            renderer->stats.streaming = 0;
+            ImGui_ImplOpenGL3_RenderDrawData(drawData);
+            return;
+        }
+        renderer->segment = 0;
+        renderer->stats.resizes++;
+    }
+
+    // Only waits if the GPU is a full IMGUI_RENDERER_SEGMENTS frames behind.
+    GLsync fence = renderer->fences[renderer->segment];
+    if (fence != NULL)
+    {
+        if (glClientWaitSync(fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+        {
+            renderer->stats.stalls++;
+            glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+        }
+        glDeleteSync(fence);
+        renderer->fences[renderer->segment] = NULL;
+    }
+
+    unsigned int vtxBase = renderer->segment * renderer->segmentVertices;
+    unsigned int idxBase = renderer->segment * renderer->segmentIndices;
+    unsigned int vtxOffset = 0;
+    unsigned int idxOffset = 0;
+    for (int n = 0; n < drawData->CmdListsCount; n++)
+    {
+        const ImDrawList *list = drawData->CmdLists[n];
+        memcpy(renderer->vtxMap + vtxBase + vtxOffset, list->VtxBuffer.Data, (size_t)list->VtxBuffer.size_in_bytes());
+        memcpy(renderer->idxMap + idxBase + idxOffset, list->IdxBuffer.Data, (size_t)list->IdxBuffer.size_in_bytes());
+        vtxOffset += list->VtxBuffer.Size;
+        idxOffset += list->IdxBuffer.Size;
+    }
+    renderer->stats.bytes = (unsigned long long)vtxOffset * sizeof(ImDrawVert) + (unsigned long long)idxOffset * sizeof(ImDrawIdx);
+
+    // Backup the GL state we touch.
+    GLint lastProgram, lastTexture, lastActiveTexture, lastVertexArray, lastArrayBuffer;
+    GLint lastViewport[4], lastScissorBox[4], lastPolygonMode[2];
+    GLint lastBlendSrcRgb, lastBlendDstRgb, lastBlendSrcAlpha, lastBlendDstAlpha, lastBlendEqRgb, lastBlendEqAlpha;
+    glGetIntegerv(GL_ACTIVE_TEXTURE, &lastActiveTexture);
+    glActiveTexture(GL_TEXTURE0);
+    glGetIntegerv(GL_CURRENT_PROGRAM, &lastProgram);
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &lastTexture);
+    glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &lastArrayBuffer);
+    glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &lastVertexArray);
+    glGetIntegerv(GL_POLYGON_MODE, lastPolygonMode);
+    glGetIntegerv(GL_VIEWPORT, lastViewport);
+    glGetIntegerv(GL_SCISSOR_BOX, lastScissorBox);
+    glGetIntegerv(GL_BLEND_SRC_RGB, &lastBlendSrcRgb);
+    glGetIntegerv(GL_BLEND_DST_RGB, &lastBlendDstRgb);
+    glGetIntegerv(GL_BLEND_SRC_ALPHA, &lastBlendSrcAlpha);
+    glGetIntegerv(GL_BLEND_DST_ALPHA, &lastBlendDstAlpha);
+    glGetIntegerv(GL_BLEND_EQUATION_RGB, &lastBlendEqRgb);
+    glGetIntegerv(GL_BLEND_EQUATION_ALPHA, &lastBlendEqAlpha);
+    GLboolean lastEnableBlend = glIsEnabled(GL_BLEND);
+    GLboolean lastEnableCullFace = glIsEnabled(GL_CULL_FACE);
+    GLboolean lastEnableDepthTest = glIsEnabled(GL_DEPTH_TEST);
+    GLboolean lastEnableStencilTest = glIsEnabled(GL_STENCIL_TEST);
+    GLboolean lastEnableScissorTest = glIsEnabled(GL_SCISSOR_TEST);
+
+    imgui_renderer_setup_state(drawData, fbWidth, fbHeight);
+
+    ImVec2 clipOff = drawData->DisplayPos;
+    ImVec2 clipScale = drawData->FramebufferScale;
+    GLuint boundTexture = 0;
+    ImVec4 boundClip = ImVec4(-1.0f, -1.0f, -1.0f, -1.0f);
+    vtxOffset = 0;
+    idxOffset = 0;
+    for (int n = 0; n < drawData->CmdListsCount; n++)
+    {
+        const ImDrawList *list = drawData->CmdLists[n];
+        for (int c = 0; c < list->CmdBuffer.Size; c++)
+        {
+            const ImDrawCmd *cmd = &(list->CmdBuffer[c]);
+            if (cmd->UserCallback != NULL)
+            {
+                imgui_renderer_flush();
+                if (cmd->UserCallback == ImDrawCallback_ResetRenderState)
+                    imgui_renderer_setup_state(drawData, fbWidth, fbHeight);
+                else
+                    cmd->UserCallback(list, cmd);
+                boundTexture = 0;
+                boundClip = ImVec4(-1.0f, -1.0f, -1.0f, -1.0f);
+                continue;
+            }
+
+            ImVec2 clipMin((cmd->ClipRect.x - clipOff.x) * clipScale.x, (cmd->ClipRect.y - clipOff.y) * clipScale.y);
+            ImVec2 clipMax((cmd->ClipRect.z - clipOff.x) * clipScale.x, (cmd->ClipRect.w - clipOff.y) * clipScale.y);
+            if (clipMax.x <= clipMin.x || clipMax.y <= clipMin.y)
+                continue;
+
+            GLuint texture = (GLuint)(intptr_t)cmd->GetTexID();
+            ImVec4 clip = ImVec4(clipMin.x, clipMin.y, clipMax.x, clipMax.y);
+            if (texture != boundTexture || memcmp(&clip, &boundClip, sizeof(ImVec4)) != 0)
+            {
+                imgui_renderer_flush();
+                glBindTexture(GL_TEXTURE_2D, texture);
+                glScissor((int)clipMin.x, (int)((float)fbHeight - clipMax.y), (int)(clipMax.x - clipMin.x), (int)(clipMax.y - clipMin.y));
+                boundTexture = texture;
+                boundClip = clip;
+            }
+
+            renderer->counts.push_back((GLsizei)cmd->ElemCount);
+            renderer->offsets.push_back((void *)(intptr_t)((idxBase + idxOffset + cmd->IdxOffset) * sizeof(ImDrawIdx)));
+            renderer->baseVertices.push_back((GLint)(vtxBase + vtxOffset + cmd->VtxOffset));
+        }
+        vtxOffset += list->VtxBuffer.Size;
+        idxOffset += list->IdxBuffer.Size;
+    }
+    imgui_renderer_flush();
+
+    renderer->fences[renderer->segment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    renderer->segment = (renderer->segment + 1) % IMGUI_RENDERER_SEGMENTS;
+
+    // Restore modified GL state
+    glUseProgram(lastProgram);
+    glBindTexture(GL_TEXTURE_2D, lastTexture);
+    glActiveTexture(lastActiveTexture);
+    glBindVertexArray(lastVertexArray);
+    glBindBuffer(GL_ARRAY_BUFFER, lastArrayBuffer);
+    glBlendEquationSeparate(lastBlendEqRgb, lastBlendEqAlpha);
+    glBlendFuncSeparate(lastBlendSrcRgb, lastBlendDstRgb, lastBlendSrcAlpha, lastBlendDstAlpha);
+    if (lastEnableBlend)
+        glEnable(GL_BLEND);
+    else
+        glDisable(GL_BLEND);
+    if (lastEnableCullFace)
+        glEnable(GL_CULL_FACE);
+    else
+        glDisable(GL_CULL_FACE);
+    if (lastEnableDepthTest)
+        glEnable(GL_DEPTH_TEST);
+    else
+        glDisable(GL_DEPTH_TEST);
+    if (lastEnableStencilTest)
+        glEnable(GL_STENCIL_TEST);
+    else
+        glDisable(GL_STENCIL_TEST);
+    if (lastEnableScissorTest)
+        glEnable(GL_SCISSOR_TEST);
+    else
+        glDisable(GL_SCISSOR_TEST);
+    glPolygonMode(GL_FRONT_AND_BACK, (GLenum)lastPolygonMode[0]);
+    glViewport(lastViewport[0], lastViewport[1], (GLsizei)lastViewport[2], (GLsizei)lastViewport[3]);
+    glScissor(lastScissorBox[0], lastScissorBox[1], (GLsizei)lastScissorBox[2], (GLsizei)lastScissorBox[3]);
+}
+
+const imgui_renderer_stats_t *imgui_renderer_get_stats()
+{
+    return &(renderer->stats);
+}
@@ -0,0 +1,546 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include <imgui.h>
+#include <imgui_internal.h>
+
+#include <nonstd.h>
+#include <nonstd_glfw_opengl.h>
+#include <tile_map.h>
+#include "nonstd_imgui.h"
+
+#define REPLAY_MAGIC "NIIR"
+#define REPLAY_VERSION 1
+
+// Log layout, host byte order:
+//   header: magic, version, IMGUI_VERSION_NUM, tool options size and bytes, ini size and bytes
+//   frame:  delta time, display size, framebuffer scale (floats), event count (uint16)
+//   event:  type (uint8) followed by a type specific payload, see ReplayWriteEvent
+typedef struct replay_frame_header_s
+{
+    float deltaTime;
+    float displayWidth;
+    float displayHeight;
+    float scaleX;
+    float scaleY;
+    uint16_t numEvents;
+} __attribute__((packed)) replay_frame_header_t;
+
+typedef struct replay_recorder_s
+{
+    FILE *file;
+    ImVector<unsigned char> buffer;
+    unsigned int nextEventId; // events below this were written in an earlier frame
+    unsigned int frames;
+    unsigned long long bytes;
+} replay_recorder_t;
+
+typedef struct replay_player_s
+{
+    unsigned char *data;
+    size_t size;
+    size_t cursor;
+    size_t toolsOffset;
+    size_t firstFrame;
+    imgui_tool_options_t *tools;
+    const char *iniFilename;
+    unsigned int liveEventId; // queued events from here on came from the backend
+    int started;
+    int fed; // the current frame came from the log
+    ImVector<imgui_replay_frame_t> timings;
+} replay_player_t;
+
+static thread_local replay_recorder_t recorder;
+static thread_local replay_player_t player;
+
+static void ReplayPut(ImVector<unsigned char> &buffer, const void *data, size_t size)
+{
+    int offset = buffer.Size;
+    buffer.resize(buffer.Size + (int)size);
+    memcpy(buffer.Data + offset, data, size);
+}
+
+static void ReplayPutU8(ImVector<unsigned char> &buffer, unsigned int value)
+{
+    buffer.push_back((unsigned char)value);
+}
+
+static void ReplayPutU32(ImVector<unsigned char> &buffer, uint32_t value)
+{
+    ReplayPut(buffer, &value, sizeof(value));
+}
+
+static void ReplayPutF32(ImVector<unsigned char> &buffer, float value)
+{
+    ReplayPut(buffer, &value, sizeof(value));
+}
+
+int imgui_record_begin(const char *path, const imgui_tool_options_t *tools)
+{
+    if (recorder.file != NULL || player.data != NULL)
+        return 1;
+    FILE *file = fopen(path, "wb");
+    if (file == NULL)
+        return 1;
+
+    ImGuiContext &g = *ImGui::GetCurrentContext();
+    size_t iniSize = 0;
+    const char *ini = ImGui::SaveIniSettingsToMemory(&iniSize);
+    ImVector<unsigned char> &buffer = recorder.buffer;
+    buffer.resize(0);
+    ReplayPut(buffer, REPLAY_MAGIC, 4);
+    ReplayPutU32(buffer, REPLAY_VERSION);
+    ReplayPutU32(buffer, IMGUI_VERSION_NUM);
+    ReplayPutU32(buffer, sizeof(imgui_tool_options_t));
+    ReplayPut(buffer, tools, sizeof(imgui_tool_options_t));
+    ReplayPutU32(buffer, (uint32_t)iniSize);
+    ReplayPut(buffer, ini, iniSize);
+    if (fwrite(buffer.Data, 1, (size_t)buffer.Size, file) != (size_t)buffer.Size)
+    {
+        fclose(file);
+        return 1;
+    }
+    recorder.file = file;
+    recorder.bytes = (unsigned long long)buffer.Size;
+    recorder.frames = 0;
+    // Events already queued belong to the frame before the recording.
+    recorder.nextEventId = g.InputEventsNextEventId;
+    return 0;
+}
+
+int imgui_record_end()
+{
+    if (recorder.file == NULL)
+        return 1;
+    int err = fclose(recorder.file) != 0;
+    recorder.file = NULL;
+    recorder.buffer.clear();
+    return err;
+}
+
+int imgui_recording()
+{
+    return recorder.file != NULL;
+}
+
+unsigned int imgui_record_frames()
+{
+    return recorder.frames;
+}
+
+static void ReplayWriteEvent(ImVector<unsigned char> &buffer, const ImGuiInputEvent *e)
+{
+    ReplayPutU8(buffer, (unsigned int)e->Type);
+    switch (e->Type)
+    {
+    case ImGuiInputEventType_MousePos:
+        ReplayPutF32(buffer, e->MousePos.PosX);
+        ReplayPutF32(buffer, e->MousePos.PosY);
+        ReplayPutU8(buffer, (unsigned int)e->MousePos.MouseSource);
+        break;
+    case ImGuiInputEventType_MouseWheel:
+        ReplayPutF32(buffer, e->MouseWheel.WheelX);
+        ReplayPutF32(buffer, e->MouseWheel.WheelY);
+        ReplayPutU8(buffer, (unsigned int)e->MouseWheel.MouseSource);
+        break;
+    case ImGuiInputEventType_MouseButton:
+        ReplayPutU8(buffer, (unsigned int)e->MouseButton.Button);
+        ReplayPutU8(buffer, e->MouseButton.Down);
+        ReplayPutU8(buffer, (unsigned int)e->MouseButton.MouseSource);
+        break;
+    case ImGuiInputEventType_MouseViewport:
+        ReplayPutU32(buffer, e->MouseViewport.HoveredViewportID);
+        break;
+    case ImGuiInputEventType_Key:
+        ReplayPutU32(buffer, (uint32_t)e->Key.Key);
+        ReplayPutU8(buffer, e->Key.Down);
+        ReplayPutF32(buffer, e->Key.AnalogValue);
+        break;
+    case ImGuiInputEventType_Text:
+        ReplayPutU32(buffer, e->Text.Char);
+        break;
+    case ImGuiInputEventType_Focus:
+        ReplayPutU8(buffer, e->AppFocused.Focused);
+        break;
+    default:
+        break;
+    }
+}
+
+// Appends the frame's new input events and io timing to the log. With the
+// trickling input queue events can stay queued for several frames, so only
+// events newer than the last recorded frame are written.
+static void ReplayRecordFrame()
+{
+    ImGuiContext &g = *ImGui::GetCurrentContext();
+    ImGuiIO &io = ImGui::GetIO();
+    ImVector<unsigned char> &buffer = recorder.buffer;
+    buffer.resize(0);
+
+    replay_frame_header_t header;
+    header.deltaTime = io.DeltaTime;
+    header.displayWidth = io.DisplaySize.x;
+    header.displayHeight = io.DisplaySize.y;
+    header.scaleX = io.DisplayFramebufferScale.x;
+    header.scaleY = io.DisplayFramebufferScale.y;
+    header.numEvents = 0;
+    ReplayPut(buffer, &header, sizeof(header));
+    for (int i = 0; i < g.InputEventsQueue.Size && header.numEvents < UINT16_MAX; i++)
+    {
+        const ImGuiInputEvent *e = &(g.InputEventsQueue[i]);
+        if (e->EventId < recorder.nextEventId)
+            continue;
+        ReplayWriteEvent(buffer, e);
+        header.numEvents++;
+    }
+    memcpy(buffer.Data, &header, sizeof(header));
+    recorder.nextEventId = g.InputEventsNextEventId;
+
+    if (fwrite(buffer.Data, 1, (size_t)buffer.Size, recorder.file) != (size_t)buffer.Size)
+    {
+        imgui_record_end();
+        return;
+    }
+    recorder.frames++;
+    recorder.bytes += (unsigned long long)buffer.Size;
+}
+
+static bool ReplayGet(void *dst, size_t size)
+{
+    if (player.cursor + size > player.size)
+        return false;
+    memcpy(dst, player.data + player.cursor, size);
+    player.cursor += size;
+    return true;
+}
+
+int imgui_replay_begin(const char *path, imgui_tool_options_t *tools)
+{
+    if (recorder.file != NULL || player.data != NULL)
+        return 1;
+    FILE *file = fopen(path, "rb");
+    if (file == NULL)
+        return 1;
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    unsigned char *data = size > 0 ? (unsigned char *)malloc((size_t)size) : NULL;
+    if (data == NULL || fread(data, 1, (size_t)size, file) != (size_t)size)
+    {
+        free(data);
+        fclose(file);
+        return 1;
+    }
+    fclose(file);
+
+    player.data = data;
+    player.size = (size_t)size;
+    player.cursor = 0;
+    char magic[4];
+    uint32_t version = 0, imguiVersion = 0, toolsSize = 0, iniSize = 0;
+    bool ok = ReplayGet(magic, sizeof(magic)) && memcmp(magic, REPLAY_MAGIC, 4) == 0 &&
+              ReplayGet(&version, sizeof(version)) && version == REPLAY_VERSION &&
+              ReplayGet(&imguiVersion, sizeof(imguiVersion)) && imguiVersion == IMGUI_VERSION_NUM &&
+              ReplayGet(&toolsSize, sizeof(toolsSize)) && toolsSize == sizeof(imgui_tool_options_t) &&
+              player.cursor + toolsSize <= player.size;
+    if (ok)
+    {
+        player.toolsOffset = player.cursor;
+        player.cursor += toolsSize;
+        ok = ReplayGet(&iniSize, sizeof(iniSize)) && player.cursor + iniSize <= player.size;
+    }
+    if (!ok)
+    {
+        free(player.data);
+        player.data = NULL;
+        return 1;
+    }
+    player.cursor += iniSize;
+    player.firstFrame = player.cursor;
+    player.tools = tools;
+    player.started = 0;
+    player.fed = 0;
+    player.liveEventId = 0;
+    player.timings.resize(0);
+    return 0;
+}
+
+static void ReplayFinish()
+{
+    if (player.started)
+        ImGui::GetIO().IniFilename = player.iniFilename;
+    player.started = 0;
+    free(player.data);
+    player.data = NULL;
+    player.size = 0;
+    player.cursor = 0;
+}
+
+int imgui_replay_end()
+{
+    if (player.data == NULL)
+        return 1;
+    ReplayFinish();
+    return 0;
+}
+
+int imgui_replay_active()
+{
+    return player.data != NULL && player.cursor < player.size;
+}
+
+// Restores the window layout and tool options the log was recorded with. The
+// ini file is not written while replaying so the user's layout is left alone.
+static void ReplayStart()
+{
+    ImGuiIO &io = ImGui::GetIO();
+    const unsigned char *tools = player.data + player.toolsOffset;
+    uint32_t iniSize = 0;
+    memcpy(&iniSize, tools + sizeof(imgui_tool_options_t), sizeof(iniSize));
+    if (player.tools != NULL)
+        memcpy(player.tools, tools, sizeof(imgui_tool_options_t));
+    ImGui::LoadIniSettingsFromMemory((const char *)tools + sizeof(imgui_tool_options_t) + sizeof(iniSize), iniSize);
+    player.iniFilename = io.IniFilename;
+    io.IniFilename = NULL;
+    player.started = 1;
+}
+
+static bool ReplayReadEvent(ImGuiIO &io)
+{
+    uint8_t type = 0;
+    if (!ReplayGet(&type, sizeof(type)))
+        return false;
+    float x = 0.0f, y = 0.0f;
+    uint8_t a = 0, b = 0, source = 0;
+    uint32_t value = 0;
+    switch (type)
+    {
+    case ImGuiInputEventType_MousePos:
+        if (!ReplayGet(&x, sizeof(x)) || !ReplayGet(&y, sizeof(y)) || !ReplayGet(&source, sizeof(source)))
+            return false;
+        io.AddMouseSourceEvent((ImGuiMouseSource)source);
+        io.AddMousePosEvent(x, y);
+        return true;
+    case ImGuiInputEventType_MouseWheel:
+        if (!ReplayGet(&x, sizeof(x)) || !ReplayGet(&y, sizeof(y)) || !ReplayGet(&source, sizeof(source)))
+            return false;
+        io.AddMouseSourceEvent((ImGuiMouseSource)source);
+        io.AddMouseWheelEvent(x, y);
+        return true;
+    case ImGuiInputEventType_MouseButton:
+        if (!ReplayGet(&a, sizeof(a)) || !ReplayGet(&b, sizeof(b)) || !ReplayGet(&source, sizeof(source)))
+            return false;
+        io.AddMouseSourceEvent((ImGuiMouseSource)source);
+        io.AddMouseButtonEvent(a, b != 0);
+        return true;
+    case ImGuiInputEventType_MouseViewport:
+        if (!ReplayGet(&value, sizeof(value)))
+            return false;
+        io.AddMouseViewportEvent(value);
+        return true;
+    case ImGuiInputEventType_Key:
+        if (!ReplayGet(&value, sizeof(value)) || !ReplayGet(&b, sizeof(b)) || !ReplayGet(&x, sizeof(x)))
+            return false;
+        io.AddKeyAnalogEvent((ImGuiKey)value, b != 0, x);
+        return true;
+    case ImGuiInputEventType_Text:
+        if (!ReplayGet(&value, sizeof(value)))
+            return false;
+        io.AddInputCharacter(value);
+        return true;
+    case ImGuiInputEventType_Focus:
+        if (!ReplayGet(&b, sizeof(b)))
+            return false;
+        io.AddFocusEvent(b != 0);
+        return true;
+    default:
+        return false;
+    }
+}
+
+// Replaces the backend's input and timing with the next frame of the log.
+static void ReplayFeedFrame()
+{
+    ImGuiContext &g = *ImGui::GetCurrentContext();
+    ImGuiIO &io = ImGui::GetIO();
+    if (!player.started)
+        ReplayStart();
+
+    // Events the backend queued since the last replayed frame are live input;
+    // older ones are replayed events the trickling queue held back.
+    for (int i = g.InputEventsQueue.Size - 1; i >= 0; i--)
+    {
+        if (g.InputEventsQueue[i].EventId >= player.liveEventId)
+            g.InputEventsQueue.erase(g.InputEventsQueue.Data + i);
+    }
+
+    replay_frame_header_t header;
+    bool ok = ReplayGet(&header, sizeof(header)) && header.deltaTime > 0.0f;
+    for (unsigned int i = 0; ok && i < header.numEvents; i++)
+        ok = ReplayReadEvent(io);
+    if (!ok)
+    {
+        // Truncated or corrupt log: stop here and keep the frames replayed so far.
+        player.fed = 0;
+        ReplayFinish();
+        return;
+    }
+    io.DeltaTime = header.deltaTime;
+    io.DisplaySize = ImVec2(header.displayWidth, header.displayHeight);
+    io.DisplayFramebufferScale = ImVec2(header.scaleX, header.scaleY);
+    player.liveEventId = g.InputEventsNextEventId;
+    player.fed = 1;
+}
+
+// Called by imgui_start_frame between the backend's NewFrame and ImGui::NewFrame.
+void imgui_replay_new_frame()
+{
+    if (recorder.file != NULL)
+        ReplayRecordFrame();
+    else if (imgui_replay_active())
+        ReplayFeedFrame();
+}
+
+// Called once the frame's draw data is final. GPU times arrive a few frames
+// late, so recent frames are revisited until the profiler ring has them.
+void imgui_replay_end_frame()
+{
+    if (!player.fed)
+        return;
+    player.fed = 0;
+
+    imgui_replay_frame_t timing;
+    memset(&timing, 0, sizeof(timing));
+    const imgui_profiler_frame_t *frame = imgui_profiler_get_frame(0);
+    timing.cpuMs = frame != NULL ? (float)((frame->end - frame->start) * 1000.0) : 0.0f;
+    timing.gpuMs = -1.0f;
+    ImDrawData *drawData = ImGui::GetDrawData();
+    if (drawData != NULL && drawData->Valid)
+    {
+        timing.drawLists = (unsigned int)drawData->CmdListsCount;
+        for (int i = 0; i < drawData->CmdListsCount; i++)
+            timing.drawCalls += (unsigned int)drawData->CmdLists[i]->CmdBuffer.Size;
+        timing.vertices = (unsigned int)drawData->TotalVtxCount;
+        timing.indices = (unsigned int)drawData->TotalIdxCount;
+    }
+    player.timings.push_back(timing);
+
+    unsigned int count = (unsigned int)player.timings.Size;
+    for (unsigned int ago = 0; ago <= IMGUI_PROFILER_GPU_QUERIES && ago < count; ago++)
+    {
+        const imgui_profiler_frame_t *past = imgui_profiler_get_frame(ago);
+        if (past != NULL && past->gpuTime >= 0.0)
+            player.timings[count - 1 - ago].gpuMs = (float)(past->gpuTime * 1000.0);
+    }
+
+    if (player.data != NULL && player.cursor >= player.size)
+        ReplayFinish();
+}
+
+unsigned int imgui_replay_num_frames()
+{
+    return (unsigned int)player.timings.Size;
+}
+
+const imgui_replay_frame_t *imgui_replay_get_frames()
+{
+    return player.timings.Data;
+}
+
+unsigned int imgui_replay_progress(unsigned int *total)
+{
+    if (total != NULL)
+        *total = (unsigned int)(player.size > player.firstFrame ? player.size - player.firstFrame : 0);
+    return (unsigned int)(player.cursor > player.firstFrame ? player.cursor - player.firstFrame : 0);
+}
+
+static int CompareReplayFloat(const void *a, const void *b)
+{
+    float fa = *(const float *)a;
+    float fb = *(const float *)b;
+    return fa < fb ? -1 : (fa > fb ? 1 : 0);
+}
+
+void imgui_replay_summarize(imgui_replay_summary_t *summary)
+{
+    memset(summary, 0, sizeof(*summary));
+    unsigned int count = (unsigned int)player.timings.Size;
+    if (count == 0)
+        return;
+    float *cpu = (float *)malloc(count * sizeof(float));
+    unsigned int gpuFrames = 0;
+    for (unsigned int i = 0; i < count; i++)
+    {
+        const imgui_replay_frame_t *timing = &(player.timings[i]);
+        cpu[i] = timing->cpuMs;
+        summary->cpuMean += timing->cpuMs;
+        if (timing->gpuMs >= 0.0f)
+        {
+            summary->gpuMean += timing->gpuMs;
+            gpuFrames++;
+        }
+        summary->drawCallsMean += (float)timing->drawCalls;
+        summary->drawCallsMax = timing->drawCalls > summary->drawCallsMax ? timing->drawCalls : summary->drawCallsMax;
+    }
+    qsort(cpu, count, sizeof(float), CompareReplayFloat);
+    summary->frames = count;
+    summary->cpuMean /= (float)count;
+    summary->cpuP50 = cpu[count / 2];
+    summary->cpuP95 = cpu[(count * 95) / 100 < count ? (count * 95) / 100 : count - 1];
+    summary->cpuMax = cpu[count - 1];
+    summary->gpuMean = gpuFrames > 0 ? summary->gpuMean / (float)gpuFrames : -1.0f;
+    summary->drawCallsMean /= (float)count;
+    free(cpu);
+}
+
+// CSV with one row per replayed frame, preceded by the summary as comments.
+int imgui_replay_write_report(const char *path)
+{
+    FILE *file = fopen(path, "w");
+    if (file == NULL)
+        return 1;
+    imgui_replay_summary_t summary;
+    imgui_replay_summarize(&summary);
+    fprintf(file, "# imgui %s, %u frames\n", IMGUI_VERSION, summary.frames);
+    fprintf(file, "# cpu ms mean %.4f p50 %.4f p95 %.4f max %.4f, gpu ms mean %.4f\n", summary.cpuMean, summary.cpuP50, summary.cpuP95, summary.cpuMax, summary.gpuMean);
+    fprintf(file, "# draw calls mean %.2f max %u\n", summary.drawCallsMean, summary.drawCallsMax);
+    fprintf(file, "frame,cpu_ms,gpu_ms,draw_calls,draw_lists,vertices,indices\n");
+    for (int i = 0; i < player.timings.Size; i++)
+    {
+        const imgui_replay_frame_t *timing = &(player.timings[i]);
+        fprintf(file, "%d,%.4f,%.4f,%u,%u,%u,%u\n", i, timing->cpuMs, timing->gpuMs, timing->drawCalls, timing->drawLists, timing->vertices, timing->indices);
+    }
+    return fclose(file) != 0;
+}
+
+int imgui_replay_run(
+    nonstd_imgui_t *gui,
+    task_queue_t *tq,
+    unsigned int numCameras,
+    camera_t *cameraList,
+    unsigned int numModels,
+    model_t *modelList,
+    map_t *map)
+{
+    unsigned int frames = 0;
+    while (imgui_replay_active())
+    {
+        imgui_draw(gui, tq, numCameras, cameraList, numModels, modelList, map);
+        frames++;
+    }
+    return (int)frames;
+}
+
+void imgui_replay_cleanup()
+{
+    imgui_record_end();
+    if (player.data != NULL)
+        ReplayFinish();
+    player.timings.clear();
+    recorder.buffer.clear();
+}
@@ -0,0 +1,544 @@
+#include <ctype.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include <imgui.h>
+
+#include <nonstd.h>
+#include <nonstd_glfw_opengl.h>
+#include <tile_map.h>
+#include "nonstd_imgui.h"
+
+#define SEARCH_KIND_MODEL 0
+#define SEARCH_KIND_SCENE 1
+#define SEARCH_QUERY_MAX 256
+
+typedef struct search_buffer_s
+{
+    char *data;
+    size_t size;
+    size_t cap;
+} search_buffer_t;
+
+typedef struct search_entry_s
+{
+    unsigned int text;    // lowercased name, offset into lowered
+    unsigned int display; // original name, offset into names
+    int kind;
+    unsigned int a, b, c;
+    const void *ptr;
+} search_entry_t;
+
+// One immutable index per model_t or aiScene. Workers build it into plain malloc
+// memory; the UI thread swaps it in once ready. refs counts the owner plus the
+// queued task, whoever drops the last one frees the segment.
+typedef struct search_segment_s
+{
+    int sourceKind;
+    const void *owner;
+    unsigned long long key;
+    int refs;
+    int ready;
+    imgui_task_status_t *status;
+
+    search_entry_t *entries;
+    unsigned int numEntries;
+    unsigned int capEntries;
+    // Lowercased names are packed back to back in entry order so short queries
+    // can run one memmem over the whole buffer.
+    search_buffer_t lowered;
+    search_buffer_t names;
+
+    // Trigram postings in CSR form: entries of trigramKeys[i] are
+    // postings[trigramOffsets[i] .. trigramOffsets[i + 1]).
+    uint32_t *trigramKeys;
+    uint32_t *trigramOffsets;
+    uint32_t *postings;
+    unsigned int numTrigrams;
+} search_segment_t;
+
+typedef struct search_slot_s
+{
+    search_segment_t *current;  // queried
+    search_segment_t *building; // replaces current once ready
+} search_slot_t;
+
+static thread_local ImVector<search_slot_t> modelSlots;
+static thread_local ImVector<search_slot_t> sceneSlots;
+static thread_local imgui_search_stats_t searchStats;
+
+static void SearchSegmentFree(search_segment_t *segment)
+{
+    free(segment->entries);
+    free(segment->lowered.data);
+    free(segment->names.data);
+    free(segment->trigramKeys);
+    free(segment->trigramOffsets);
+    free(segment->postings);
+    free(segment);
+}
+
+static void SearchSegmentRelease(search_segment_t *segment)
+{
+    if (segment != NULL && __atomic_sub_fetch(&(segment->refs), 1, __ATOMIC_ACQ_REL) == 0)
+        SearchSegmentFree(segment);
+}
+
+static unsigned int SearchAddString(search_buffer_t *buffer, const char *text, size_t len, bool lower)
+{
+    if (buffer->size + len + 1 > buffer->cap)
+    {
+        size_t cap = buffer->cap > 0 ? buffer->cap * 2 : 4096;
+        while (cap < buffer->size + len + 1)
+            cap *= 2;
+        buffer->data = (char *)realloc(buffer->data, cap);
+        buffer->cap = cap;
+    }
+    unsigned int offset = (unsigned int)buffer->size;
+    char *dst = buffer->data + offset;
+    for (size_t i = 0; i < len; i++)
+        dst[i] = lower ? (char)tolower((unsigned char)text[i]) : text[i];
+    dst[len] = '\0';
+    buffer->size += len + 1;
+    return offset;
+}
+
+static void SearchAdd(search_segment_t *segment, const char *name, size_t len, int kind, unsigned int a, unsigned int b, unsigned int c, const void *ptr)
+{
+    if (name == NULL || len == 0)
+        return;
+    if (segment->numEntries == segment->capEntries)
+    {
+        segment->capEntries = segment->capEntries > 0 ? segment->capEntries * 2 : 1024;
+        segment->entries = (search_entry_t *)realloc(segment->entries, segment->capEntries * sizeof(search_entry_t));
+    }
+    search_entry_t *entry = &(segment->entries[segment->numEntries++]);
+    entry->text = SearchAddString(&(segment->lowered), name, len, true);
+    entry->display = SearchAddString(&(segment->names), name, len, false);
+    entry->kind = kind;
+    entry->a = a;
+    entry->b = b;
+    entry->c = c;
+    entry->ptr = ptr;
+}
+
+static void SearchCollectModel(search_segment_t *segment, const model_t *model)
+{
+    // model_t nodes and meshes carry no names; texture paths are what can be searched.
+    for (unsigned int m = 0; m < model->mNumMaterials; m++)
+    {
+        const material_t *material = &(model->mMaterialList[m]);
+        for (unsigned int type = 0; type < AI_TEXTURE_TYPE_MAX + 1; type++)
+        {
+            for (unsigned int t = 0; t < material->mTextureCount[type]; t++)
+            {
+                const aiString *path = &(material->mTextures[type][t].path);
+                SearchAdd(segment, path->data, path->length, IMGUI_SEARCH_MODEL_TEXTURE, m, type, t, material);
+            }
+        }
+    }
+}
+
+static void SearchCollectMetadata(search_segment_t *segment, const aiMetadata *meta, const void *node)
+{
+    if (meta == NULL)
+        return;
+    for (unsigned int i = 0; i < meta->mNumProperties; i++)
+        SearchAdd(segment, meta->mKeys[i].data, meta->mKeys[i].length, IMGUI_SEARCH_AI_METADATA, i, 0, 0, node);
+}
+
+static void SearchCollectScene(search_segment_t *segment, const aiScene *scene)
+{
+    // Iterative walk so deep hierarchies cannot overflow the worker's stack. Plain
+    // malloc here, the pooled ImGui allocator is only safe on the UI thread.
+    size_t stackSize = 0, stackCap = 256;
+    const aiNode **stack = (const aiNode **)malloc(stackCap * sizeof(const aiNode *));
+    if (scene->mRootNode != NULL)
+        stack[stackSize++] = scene->mRootNode;
+    while (stackSize > 0)
+    {
+        const aiNode *node = stack[--stackSize];
+        SearchAdd(segment, node->mName.data, node->mName.length, IMGUI_SEARCH_AI_NODE, 0, 0, 0, node);
+        SearchCollectMetadata(segment, node->mMetaData, node);
+        if (stackSize + node->mNumChildren > stackCap)
+        {
+            while (stackSize + node->mNumChildren > stackCap)
+                stackCap *= 2;
+            stack = (const aiNode **)realloc(stack, stackCap * sizeof(const aiNode *));
+        }
+        for (unsigned int i = 0; i < node->mNumChildren; i++)
+        {
+            if (node->mChildren[i] != NULL)
+                stack[stackSize++] = node->mChildren[i];
+        }
+    }
+    free(stack);
+    for (unsigned int i = 0; i < scene->mNumMeshes; i++)
+    {
+        if (scene->mMeshes[i] != NULL)
+            SearchAdd(segment, scene->mMeshes[i]->mName.data, scene->mMeshes[i]->mName.length, IMGUI_SEARCH_AI_MESH, i, 0, 0, scene->mMeshes[i]);
+    }
+    for (unsigned int i = 0; i < scene->mNumMaterials; i++)
+    {
+        const aiMaterial *material = scene->mMaterials[i];
+        if (material == NULL)
+            continue;
+        for (unsigned int p = 0; p < material->mNumProperties; p++)
+        {
+            const aiMaterialProperty *prop = material->mProperties[p];
+            // String properties are a 32 bit length followed by the characters.
+            if (prop->mType != aiPTI_String || prop->mDataLength <= 4 || strcmp(prop->mKey.data, "$tex.file") != 0)
+                continue;
+            uint32_t len = 0;
+            memcpy(&len, prop->mData, sizeof(len));
+            if (len <= prop->mDataLength - 4)
+                SearchAdd(segment, prop->mData + 4, len, IMGUI_SEARCH_AI_MATERIAL, i, prop->mSemantic, prop->mIndex, material);
+        }
+    }
+    for (unsigned int i = 0; i < scene->mNumTextures; i++)
+    {
+        if (scene->mTextures[i] != NULL)
+            SearchAdd(segment, scene->mTextures[i]->mFilename.data, scene->mTextures[i]->mFilename.length, IMGUI_SEARCH_AI_TEXTURE, i, 0, 0, scene->mTextures[i]);
+    }
+    SearchCollectMetadata(segment, scene->mMetaData, NULL);
+}
+
+static int CompareSearchPair(const void *a, const void *b)
+{
+    uint64_t va = *(const uint64_t *)a;
+    uint64_t vb = *(const uint64_t *)b;
+    return va < vb ? -1 : (va > vb ? 1 : 0);
+}
+
+static inline uint32_t SearchTrigram(const char *text)
+{
+    return ((uint32_t)(unsigned char)text[0] << 16) | ((uint32_t)(unsigned char)text[1] << 8) | (uint32_t)(unsigned char)text[2];
+}
+
+// Sorted (trigram, entry) pairs, deduplicated, then split into keys and postings.
+static void SearchBuildTrigrams(search_segment_t *segment)
+{
+    size_t numPairs = 0;
+    for (unsigned int e = 0; e < segment->numEntries; e++)
+    {
+        size_t len = strlen(segment->lowered.data + segment->entries[e].text);
+        numPairs += len >= 3 ? len - 2 : 0;
+    }
+    uint64_t *pairs = (uint64_t *)malloc((numPairs + 1) * sizeof(uint64_t));
+    size_t n = 0;
+    for (unsigned int e = 0; e < segment->numEntries; e++)
+    {
+        const char *text = segment->lowered.data + segment->entries[e].text;
+        for (size_t i = 0; text[i] != '\0' && text[i + 1] != '\0' && text[i + 2] != '\0'; i++)
+            pairs[n++] = ((uint64_t)SearchTrigram(text + i) << 32) | e;
+        if ((e & 1023) == 0)
+            imgui_task_progress(segment->status, e, segment->numEntries * 2ull, segment->lowered.size);
+    }
+    imgui_task_stage(segment->status, "Sorting");
+    qsort(pairs, n, sizeof(uint64_t), CompareSearchPair);
+
+    segment->postings = (uint32_t *)malloc((n + 1) * sizeof(uint32_t));
+    segment->trigramKeys = (uint32_t *)malloc((n + 1) * sizeof(uint32_t));
+    segment->trigramOffsets = (uint32_t *)malloc((n + 2) * sizeof(uint32_t));
+    unsigned int numPostings = 0;
+    unsigned int numTrigrams = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        if (i > 0 && pairs[i] == pairs[i - 1])
+            continue;
+        uint32_t key = (uint32_t)(pairs[i] >> 32);
+        if (numTrigrams == 0 || segment->trigramKeys[numTrigrams - 1] != key)
+        {
+            segment->trigramKeys[numTrigrams] = key;
+            segment->trigramOffsets[numTrigrams] = numPostings;
+            numTrigrams++;
+        }
+        segment->postings[numPostings++] = (uint32_t)pairs[i];
+    }
+    segment->trigramOffsets[numTrigrams] = numPostings;
+    segment->numTrigrams = numTrigrams;
+    free(pairs);
+}
+
+static void *SearchBuildTask(void *args)
+{
+    search_segment_t *segment = (search_segment_t *)args;
+    double start = glfwGetTime();
+    imgui_task_begin(segment->status);
+    imgui_task_stage(segment->status, "Collecting");
+    if (segment->sourceKind == SEARCH_KIND_MODEL)
+        SearchCollectModel(segment, (const model_t *)segment->owner);
+    else
+        SearchCollectScene(segment, (const aiScene *)segment->owner);
+    imgui_task_stage(segment->status, "Trigrams");
+    SearchBuildTrigrams(segment);
+    imgui_task_progress(segment->status, segment->numEntries * 2ull, segment->numEntries * 2ull, segment->lowered.size);
+    imgui_task_end(segment->status, IMGUI_TASK_DONE);
+    __atomic_store_n(&(segment->ready), 1, __ATOMIC_RELEASE);
+    SearchSegmentRelease(segment);
+    imgui_tq_record("imgui_search_build", glfwGetTime() - start);
+    return NULL;
+}
+
+static unsigned long long SearchModelKey(const model_t *model)
+{
+    unsigned long long key = 14695981039346656037ULL;
+    uintptr_t values[] = {(uintptr_t)model, (uintptr_t)model->mMaterialList, (uintptr_t)model->mNumMaterials};
+    for (unsigned int i = 0; i < sizeof(values) / sizeof(values[0]); i++)
+    {
+        key ^= (unsigned long long)values[i];
+        key *= 1099511628211ULL;
+    }
+    return key;
+}
+
+static unsigned long long SearchSceneKey(const aiScene *scene)
+{
+    unsigned long long key = 14695981039346656037ULL;
+    uintptr_t values[] = {(uintptr_t)scene, (uintptr_t)scene->mRootNode, (uintptr_t)scene->mNumMeshes,
+                          (uintptr_t)scene->mNumMaterials, (uintptr_t)scene->mNumTextures, (uintptr_t)scene->mMetaData};
+    for (unsigned int i = 0; i < sizeof(values) / sizeof(values[0]); i++)
+    {
+        key ^= (unsigned long long)values[i];
+        key *= 1099511628211ULL;
+    }
+    return key;
+}
+
+// Starts a rebuild of one slot when its source changed and swaps in finished builds.
+static void SearchUpdateSlot(search_slot_t *slot, int sourceKind, const void *owner, unsigned long long key, task_queue_t *tq)
+{
+    if (slot->building != NULL && __atomic_load_n(&(slot->building->ready), __ATOMIC_ACQUIRE))
+    {
+        SearchSegmentRelease(slot->current);
+        slot->current = slot->building;
+        slot->building = NULL;
+        searchStats.generation++;
+    }
+    search_segment_t *latest = slot->building != NULL ? slot->building : slot->current;
+    if (latest != NULL && latest->owner == owner && latest->key == key)
+        return;
+    if (owner == NULL)
+    {
+        SearchSegmentRelease(slot->current);
+        slot->current = NULL;
+        searchStats.generation++;
+        return;
+    }
+
+    // A superseded build finishes on its own and is freed by its task.
+    SearchSegmentRelease(slot->building);
+    search_segment_t *segment = (search_segment_t *)calloc(1, sizeof(search_segment_t));
+    segment->sourceKind = sourceKind;
+    segment->owner = owner;
+    segment->key = key;
+    segment->refs = 2;
+    segment->status = imgui_task_claim("Search index");
+    slot->building = segment;
+    if (tq == NULL)
+    {
+        SearchBuildTask(segment);
+        return;
+    }
+    async_task_t task = {0};
+    task.funcName = "imgui_search_build";
+    task.func = SearchBuildTask;
+    task.args = segment;
+    QUEUE_PUSH(tq->queue, task, 1);
+}
+
+void imgui_search_update(task_queue_t *tq, unsigned int numModels, const model_t *models, unsigned int numScenes, const struct aiScene **scenes)
+{
+    numModels = models != NULL ? numModels : 0;
+    numScenes = scenes != NULL ? numScenes : 0;
+    unsigned int oldModels = (unsigned int)modelSlots.Size;
+    unsigned int oldScenes = (unsigned int)sceneSlots.Size;
+    for (unsigned int i = numModels; i < oldModels; i++)
+        SearchUpdateSlot(&(modelSlots[i]), SEARCH_KIND_MODEL, NULL, 0, tq);
+    for (unsigned int i = numScenes; i < oldScenes; i++)
+        SearchUpdateSlot(&(sceneSlots[i]), SEARCH_KIND_SCENE, NULL, 0, tq);
+    if (numModels > oldModels)
+    {
+        modelSlots.resize(numModels);
+        memset(modelSlots.Data + oldModels, 0, (numModels - oldModels) * sizeof(search_slot_t));
+    }
+    if (numScenes > oldScenes)
+    {
+        sceneSlots.resize(numScenes);
+        memset(sceneSlots.Data + oldScenes, 0, (numScenes - oldScenes) * sizeof(search_slot_t));
+    }
+
+    searchStats.entries = 0;
+    searchStats.trigrams = 0;
+    searchStats.building = 0;
+    for (unsigned int i = 0; i < numModels; i++)
+        SearchUpdateSlot(&(modelSlots[i]), SEARCH_KIND_MODEL, &(models[i]), SearchModelKey(&(models[i])), tq);
+    for (unsigned int i = 0; i < numScenes; i++)
+    {
+        const aiScene *scene = scenes[i];
+        SearchUpdateSlot(&(sceneSlots[i]), SEARCH_KIND_SCENE, scene, scene != NULL ? SearchSceneKey(scene) : 0, tq);
+    }
+    for (int pass = 0; pass < 2; pass++)
+    {
+        ImVector<search_slot_t> &slots = pass == 0 ? modelSlots : sceneSlots;
+        for (int i = 0; i < slots.Size; i++)
+        {
+            if (slots[i].current != NULL)
+            {
+                searchStats.entries += slots[i].current->numEntries;
+                searchStats.trigrams += slots[i].current->numTrigrams;
+            }
+            searchStats.building += slots[i].building != NULL;
+        }
+    }
+}
+
+static int SearchFindTrigram(const search_segment_t *segment, uint32_t key)
+{
+    int lo = 0, hi = (int)segment->numTrigrams - 1;
+    while (lo <= hi)
+    {
+        int mid = (lo + hi) / 2;
+        if (segment->trigramKeys[mid] < key)
+            lo = mid + 1;
+        else if (segment->trigramKeys[mid] > key)
+            hi = mid - 1;
+        else
+            return mid;
+    }
+    return -1;
+}
+
+static void SearchEmit(const search_segment_t *segment, unsigned int source, const search_entry_t *entry, imgui_search_result_t *results, unsigned int max, unsigned int *count)
+{
+    if (*count < max)
+    {
+        imgui_search_result_t *result = &(results[*count]);
+        result->kind = entry->kind;
+        result->source = source;
+        result->owner = segment->owner;
+        result->a = entry->a;
+        result->b = entry->b;
+        result->c = entry->c;
+        result->ptr = entry->ptr;
+        result->text = segment->names.data + entry->display;
+    }
+    (*count)++;
+}
+
+// Index of the entry whose lowercased name contains offset.
+static unsigned int SearchEntryAt(const search_segment_t *segment, size_t offset)
+{
+    unsigned int lo = 0, hi = segment->numEntries;
+    while (hi - lo > 1)
+    {
+        unsigned int mid = (lo + hi) / 2;
+        if (segment->entries[mid].text <= offset)
+            lo = mid;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+// Candidates come from the rarest trigram of the query and are confirmed with
+// strstr. Queries shorter than a trigram scan the packed names with memchr, which
+// cannot match across names because of their terminators, and stop at max results.
+static void SearchSegment(const search_segment_t *segment, unsigned int source, const char *query, size_t len, imgui_search_result_t *results, unsigned int max, unsigned int *count)
+{
+    if (len < 3)
+    {
+        const char *data = segment->lowered.data;
+        size_t offset = 0;
+        while (*count < max && offset < segment->lowered.size)
+        {
+            const char *match = (const char *)memchr(data + offset, query[0], segment->lowered.size - offset);
+            if (match == NULL)
+                break;
+            if (len == 2 && match[1] != query[1])
+            {
+                // The terminator after every name keeps match[1] in bounds.
+                offset = (size_t)(match - data) + 1;
+                continue;
+            }
+            unsigned int e = SearchEntryAt(segment, (size_t)(match - data));
+            SearchEmit(segment, source, &(segment->entries[e]), results, max, count);
+            offset = segment->entries[e].text + strlen(data + segment->entries[e].text) + 1;
+        }
+        return;
+    }
+    int best = -1;
+    unsigned int bestSize = 0;
+    for (size_t i = 0; i + 2 < len; i++)
+    {
+        int index = SearchFindTrigram(segment, SearchTrigram(query + i));
+        if (index < 0)
+            return;
+        unsigned int size = segment->trigramOffsets[index + 1] - segment->trigramOffsets[index];
+        if (best < 0 || size < bestSize)
+        {
+            best = index;
+            bestSize = size;
+        }
+    }
+    for (uint32_t p = segment->trigramOffsets[best]; p < segment->trigramOffsets[best + 1]; p++)
+    {
+        const search_entry_t *entry = &(segment->entries[segment->postings[p]]);
+        if (len == 3 || strstr(segment->lowered.data + entry->text, query) != NULL)
+            SearchEmit(segment, source, entry, results, max, count);
+    }
+}
+
+unsigned int imgui_search_query(const char *query, imgui_search_result_t *results, unsigned int max, unsigned int *total)
+{
+    double start = glfwGetTime();
+    char lower[SEARCH_QUERY_MAX];
+    size_t len = 0;
+    for (; query[len] != '\0' && len < SEARCH_QUERY_MAX - 1; len++)
+        lower[len] = (char)tolower((unsigned char)query[len]);
+    lower[len] = '\0';
+
+    unsigned int count = 0;
+    if (len > 0)
+    {
+        for (int i = 0; i < modelSlots.Size; i++)
+        {
+            if (modelSlots[i].current != NULL)
+                SearchSegment(modelSlots[i].current, (unsigned int)i, lower, len, results, max, &count);
+        }
+        for (int i = 0; i < sceneSlots.Size; i++)
+        {
+            if (sceneSlots[i].current != NULL)
+                SearchSegment(sceneSlots[i].current, (unsigned int)i, lower, len, results, max, &count);
+        }
+    }
+    if (total != NULL)
+        *total = count;
+    searchStats.querySeconds = glfwGetTime() - start;
+    return count < max ? count : max;
+}
+
+const imgui_search_stats_t *imgui_search_get_stats()
+{
+    return &(searchStats);
+}
+
+void imgui_search_cleanup()
+{
+    for (int pass = 0; pass < 2; pass++)
+    {
+        ImVector<search_slot_t> &slots = pass == 0 ? modelSlots : sceneSlots;
+        for (int i = 0; i < slots.Size; i++)
+        {
+            SearchSegmentRelease(slots[i].current);
+            SearchSegmentRelease(slots[i].building);
+        }
+        slots.clear();
+    }
+    memset(&searchStats, 0, sizeof(searchStats));
+}
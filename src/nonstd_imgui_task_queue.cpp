@@ -0,0 +1,295 @@
+#include <math.h>
+#include <string.h>
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include <nonstd.h>
+#include <nonstd_glfw_opengl.h>
+#include <tile_map.h>
+#include "nonstd_imgui.h"
+
+static imgui_tq_func_stats_t funcStats[IMGUI_TQ_MAX_FUNCS];
+static imgui_task_status_t taskStatus[IMGUI_TASK_STATUS_MAX];
+
+static unsigned int imgui_tq_slot(const queue_t *q, void *ptr, unsigned int numSlots)
+{
+    unsigned int slot = (unsigned int)(((char *)ptr - (char *)q->start) / q->item_size);
+    return slot < numSlots ? slot : 0;
+}
+
+// Number of pending tasks, from one read of head and tail.
+unsigned int imgui_tq_depth(task_queue_t *tq)
+{
+    queue_t *q = &(tq->queue);
+    if (q->start == NULL || q->item_size == 0)
+        return 0;
+    unsigned int numSlots = (unsigned int)(q->buf_len / q->item_size);
+    if (numSlots == 0)
+        return 0;
+    unsigned int tailSlot = imgui_tq_slot(q, __atomic_load_n(&(q->tail), __ATOMIC_ACQUIRE), numSlots);
+    unsigned int headSlot = imgui_tq_slot(q, __atomic_load_n(&(q->head), __ATOMIC_ACQUIRE), numSlots);
+    return (headSlot + numSlots - tailSlot) % numSlots;
+}
+
+// Copies the pending task names without taking the queue lock. The copy is
+// validated against a second read of tail: any slot the workers consumed
+// while we were copying may already have been reused by a push, so it is
+// dropped. What remains was still pending after the copy and is consistent.
+int imgui_tq_snapshot(task_queue_t *tq, imgui_tq_snapshot_t *snapshot)
+{
+    queue_t *q = &(tq->queue);
+    snapshot->time = glfwGetTime();
+    snapshot->depth = 0;
+    snapshot->numTasks = 0;
+    if (q->start == NULL || q->item_size == 0)
+        return 1;
+
+    unsigned int numSlots = (unsigned int)(q->buf_len / q->item_size);
+    snapshot->numSlots = numSlots;
+    if (numSlots == 0)
+        return 1;
+
+    void *tail = __atomic_load_n(&(q->tail), __ATOMIC_ACQUIRE);
+    void *head = __atomic_load_n(&(q->head), __ATOMIC_ACQUIRE);
+    unsigned int tailSlot = imgui_tq_slot(q, tail, numSlots);
+    unsigned int headSlot = imgui_tq_slot(q, head, numSlots);
+    unsigned int depth = (headSlot + numSlots - tailSlot) % numSlots;
+    unsigned int numCopy = depth < IMGUI_TQ_SNAPSHOT_MAX ? depth : IMGUI_TQ_SNAPSHOT_MAX;
+
+    for (unsigned int k = 0; k < numCopy; k++)
+    {
+        async_task_t *task = (async_task_t *)((char *)q->start + ((tailSlot + k) % numSlots) * q->item_size);
+        snapshot->funcNames[k] = __atomic_load_n(&(task->funcName), __ATOMIC_RELAXED);
+    }
+
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    unsigned int tailSlotAfter = imgui_tq_slot(q, __atomic_load_n(&(q->tail), __ATOMIC_ACQUIRE), numSlots);
+    unsigned int consumed = (tailSlotAfter + numSlots - tailSlot) % numSlots;
+    if (consumed > depth)
+    {
+        // The ring wrapped under us, nothing we copied can be trusted.
+        consumed = numCopy;
+    }
+    if (consumed >= numCopy)
+    {
+        numCopy = 0;
+    }
+    else if (consumed > 0)
+    {
+        memmove(snapshot->funcNames, snapshot->funcNames + consumed, (numCopy - consumed) * sizeof(const char *));
+        numCopy -= consumed;
+    }
+
+    snapshot->headSlot = headSlot;
+    snapshot->tailSlot = tailSlotAfter;
+    snapshot->depth = depth - (consumed < depth ? consumed : depth);
+    snapshot->numTasks = numCopy;
+    return 0;
+}
+
+// Rates are derived from how far head and tail moved between two snapshots,
+// which is exact as long as fewer than numSlots tasks pass between calls.
+void imgui_tq_update_stats(imgui_tq_stats_t *stats, const imgui_tq_snapshot_t *snapshot)
+{
+    if (snapshot->numSlots == 0)
+        return;
+    if (stats->lastTime <= 0.0)
+    {
+        stats->lastTime = snapshot->time;
+        stats->lastHeadSlot = snapshot->headSlot;
+        stats->lastTailSlot = snapshot->tailSlot;
+        return;
+    }
+
+    double dt = snapshot->time - stats->lastTime;
+    if (dt <= 0.0)
+        return;
+    unsigned int pushed = (snapshot->headSlot + snapshot->numSlots - stats->lastHeadSlot) % snapshot->numSlots;
+    unsigned int popped = (snapshot->tailSlot + snapshot->numSlots - stats->lastTailSlot) % snapshot->numSlots;
+    stats->enqueued += pushed;
+    stats->dequeued += popped;
+
+    // Exponential smoothing with a time constant of roughly half a second.
+    float alpha = (float)(dt / (dt + 0.5));
+    stats->enqueueRate += alpha * ((float)(pushed / dt) - stats->enqueueRate);
+    stats->dequeueRate += alpha * ((float)(popped / dt) - stats->dequeueRate);
+
+    stats->lastTime = snapshot->time;
+    stats->lastHeadSlot = snapshot->headSlot;
+    stats->lastTailSlot = snapshot->tailSlot;
+}
+
+static imgui_tq_func_stats_t *imgui_tq_find_func(const char *funcName)
+{
+    for (unsigned int i = 0; i < IMGUI_TQ_MAX_FUNCS; i++)
+    {
+        imgui_tq_func_stats_t *entry = &(funcStats[i]);
+        const char *name = __atomic_load_n(&(entry->funcName), __ATOMIC_ACQUIRE);
+        if (name == NULL)
+        {
+            const char *expected = NULL;
+            if (__atomic_compare_exchange_n(&(entry->funcName), &expected, funcName, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+                return entry;
+            name = expected;
+        }
+        if (name == funcName || strcmp(name, funcName) == 0)
+            return entry;
+    }
+    return NULL;
+}
+
+// Safe to call from any worker thread, only touches atomics.
+void imgui_tq_record(const char *funcName, double seconds)
+{
+    if (funcName == NULL)
+        return;
+    imgui_tq_func_stats_t *entry = imgui_tq_find_func(funcName);
+    if (entry == NULL)
+        return;
+
+    unsigned long long micros = seconds > 0.0 ? (unsigned long long)(seconds * 1e6) : 0;
+    int bucket = micros > 1 ? (int)log2((double)micros) : 0;
+    if (bucket >= IMGUI_TQ_LATENCY_BUCKETS)
+        bucket = IMGUI_TQ_LATENCY_BUCKETS - 1;
+
+    __atomic_fetch_add(&(entry->count), 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&(entry->totalMicros), micros, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&(entry->latency[bucket]), 1, __ATOMIC_RELAXED);
+}
+
+unsigned int imgui_tq_read_func_stats(imgui_tq_func_stats_t *out, unsigned int max)
+{
+    unsigned int count = 0;
+    for (unsigned int i = 0; i < IMGUI_TQ_MAX_FUNCS && count < max; i++)
+    {
+        const imgui_tq_func_stats_t *entry = &(funcStats[i]);
+        const char *name = __atomic_load_n(&(entry->funcName), __ATOMIC_ACQUIRE);
+        if (name == NULL)
+            break;
+        out[count].funcName = name;
+        out[count].count = __atomic_load_n(&(entry->count), __ATOMIC_RELAXED);
+        out[count].totalMicros = __atomic_load_n(&(entry->totalMicros), __ATOMIC_RELAXED);
+        for (unsigned int b = 0; b < IMGUI_TQ_LATENCY_BUCKETS; b++)
+            out[count].latency[b] = __atomic_load_n(&(entry->latency[b]), __ATOMIC_RELAXED);
+        count++;
+    }
+    return count;
+}
+
+// __atomic_store_n only takes integers and pointers, doubles go through the generic form.
+static void imgui_task_store_time(double *time, double value)
+{
+    __atomic_store(time, &value, __ATOMIC_RELEASE);
+}
+
+double imgui_task_load_time(const double *time)
+{
+    double value;
+    __atomic_load(time, &value, __ATOMIC_ACQUIRE);
+    return value;
+}
+
+imgui_task_status_t *imgui_task_claim(const char *name)
+{
+    for (unsigned int i = 0; i < IMGUI_TASK_STATUS_MAX; i++)
+    {
+        imgui_task_status_t *status = &(taskStatus[i]);
+        int expected = IMGUI_TASK_FREE;
+        // The slot is hidden from readers while claimed and only published as
+        // queued, with a release store, once every field is filled in.
+        if (__atomic_load_n(&(status->state), __ATOMIC_RELAXED) == IMGUI_TASK_FREE &&
+            __atomic_compare_exchange_n(&(status->state), &expected, IMGUI_TASK_CLAIMED, false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED))
+        {
+            __atomic_store_n(&(status->cancel), 0, __ATOMIC_RELAXED);
+            __atomic_store_n(&(status->name), name, __ATOMIC_RELAXED);
+            __atomic_store_n(&(status->stage), (const char *)NULL, __ATOMIC_RELAXED);
+            __atomic_store_n(&(status->done), 0ull, __ATOMIC_RELAXED);
+            __atomic_store_n(&(status->total), 0ull, __ATOMIC_RELAXED);
+            __atomic_store_n(&(status->bytes), 0ull, __ATOMIC_RELAXED);
+            imgui_task_store_time(&(status->startTime), 0.0);
+            imgui_task_store_time(&(status->endTime), 0.0);
+            imgui_task_store_time(&(status->queuedTime), glfwGetTime());
+            __atomic_store_n(&(status->state), IMGUI_TASK_QUEUED, __ATOMIC_RELEASE);
+            return status;
+        }
+    }
+    return NULL;
+}
+
+// Tasks split into several queue entries may all call begin, the first one wins.
+void imgui_task_begin(imgui_task_status_t *status)
+{
+    if (status == NULL)
+        return;
+    int expected = IMGUI_TASK_QUEUED;
+    if (__atomic_compare_exchange_n(&(status->state), &expected, IMGUI_TASK_RUNNING, false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED))
+        imgui_task_store_time(&(status->startTime), glfwGetTime());
+}
+
+void imgui_task_stage(imgui_task_status_t *status, const char *stage)
+{
+    if (status != NULL)
+        __atomic_store_n(&(status->stage), stage, __ATOMIC_RELEASE);
+}
+
+void imgui_task_progress(imgui_task_status_t *status, unsigned long long done, unsigned long long total, unsigned long long bytes)
+{
+    if (status == NULL)
+        return;
+    __atomic_store_n(&(status->total), total, __ATOMIC_RELAXED);
+    __atomic_store_n(&(status->bytes), bytes, __ATOMIC_RELAXED);
+    __atomic_store_n(&(status->done), done, __ATOMIC_RELEASE);
+}
+
+// Adds to done and bytes, for work spread over several workers.
+void imgui_task_advance(imgui_task_status_t *status, unsigned long long done, unsigned long long bytes)
+{
+    if (status == NULL)
+        return;
+    __atomic_fetch_add(&(status->bytes), bytes, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&(status->done), done, __ATOMIC_RELEASE);
+}
+
+int imgui_task_cancelled(const imgui_task_status_t *status)
+{
+    return status != NULL && __atomic_load_n(&(status->cancel), __ATOMIC_ACQUIRE);
+}
+
+void imgui_task_cancel(imgui_task_status_t *status)
+{
+    if (status != NULL)
+        __atomic_store_n(&(status->cancel), 1, __ATOMIC_RELEASE);
+}
+
+void imgui_task_end(imgui_task_status_t *status, int state)
+{
+    if (status == NULL)
+        return;
+    if (state < IMGUI_TASK_DONE)
+        state = IMGUI_TASK_DONE;
+    imgui_task_store_time(&(status->endTime), glfwGetTime());
+    __atomic_store_n(&(status->state), state, __ATOMIC_RELEASE);
+}
+
+// Returns the slot at index once it is published, NULL otherwise.
+imgui_task_status_t *imgui_task_status(unsigned int index)
+{
+    if (index >= IMGUI_TASK_STATUS_MAX || __atomic_load_n(&(taskStatus[index].state), __ATOMIC_ACQUIRE) <= IMGUI_TASK_FREE)
+        return NULL;
+    return &(taskStatus[index]);
+}
+
+// Frees finished slots after they were shown for IMGUI_TASK_STATUS_LINGER seconds.
+void imgui_task_reap(double now)
+{
+    for (unsigned int i = 0; i < IMGUI_TASK_STATUS_MAX; i++)
+    {
+        imgui_task_status_t *status = &(taskStatus[i]);
+        int state = __atomic_load_n(&(status->state), __ATOMIC_ACQUIRE);
+        // Every GUI reaps; the exchange fails if another reaper freed the slot
+        // and a submitter claimed it again since the load.
+        if (state >= IMGUI_TASK_DONE && now - imgui_task_load_time(&(status->endTime)) > IMGUI_TASK_STATUS_LINGER)
+            __atomic_compare_exchange_n(&(status->state), &state, IMGUI_TASK_FREE, false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED);
+    }
+}
@@ -0,0 +1,425 @@
+#include <string.h>
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include <imgui.h>
+
+#include <nonstd.h>
+#include <nonstd_glfw_opengl.h>
+#include <tile_map.h>
+#include "nonstd_imgui.h"
+
+#define THUMBNAIL_NONE -1
+// Largest preview; reserved from the budget while a build is queued.
+#define THUMBNAIL_MAX_BYTES ((unsigned long long)IMGUI_THUMBNAIL_SIZE * IMGUI_THUMBNAIL_SIZE * 4)
+
+typedef struct imgui_thumbnail_s
+{
+    GLuint source;
+    GLuint thumbnail; // 0 while queued or when the source could not be blitted (compressed, depth, ...)
+    int width;
+    int height;
+    unsigned long long bytes;
+    unsigned int usedFrame; // never evicted during the frame that draws it
+    int queued;             // waiting for the GL thread to build it
+    int prev;
+    int next;
+} imgui_thumbnail_t;
+
+// GL work requested while a frame was built, run where the frame is rendered.
+typedef struct imgui_thumbnail_batch_s
+{
+    ImVector<GLuint> builds;  // sources to downscale
+    ImVector<GLuint> deletes; // evicted previews, not drawn by this or any later frame
+} imgui_thumbnail_batch_t;
+
+typedef struct imgui_thumbnail_cache_s
+{
+    ImVector<imgui_thumbnail_t> entries;
+    ImGuiStorage lookup; // source texture -> entry index + 1
+    int head;            // most recently used
+    int tail;            // least recently used
+    int freeList;
+    GLuint readFramebuffer;
+    GLuint drawFramebuffer;
+    unsigned int frame;
+    unsigned int queuedThisFrame;
+    imgui_thumbnail_batch_t pending;  // requests of the frame being built
+    imgui_thumbnail_batch_t *batch;   // used by imgui_thumbnail_flush
+    unsigned char lock;               // the UI thread and the GL thread share the entries
+    imgui_thumbnail_stats_t stats;
+} imgui_thumbnail_cache_t;
+
+// Per GUI like the renderer: framebuffers are not shared between GL contexts.
+static imgui_thumbnail_cache_t defaultCache;
+static thread_local imgui_thumbnail_cache_t *cache = &defaultCache;
+
+static void thumbnail_lock()
+{
+    while (__atomic_test_and_set(&(cache->lock), __ATOMIC_ACQUIRE))
+        ;
+}
+
+static void thumbnail_unlock()
+{
+    __atomic_clear(&(cache->lock), __ATOMIC_RELEASE);
+}
+
+static void imgui_thumbnail_unlink(int index)
+{
+    imgui_thumbnail_t *entry = &(cache->entries[index]);
+    if (entry->prev != THUMBNAIL_NONE)
+        cache->entries[entry->prev].next = entry->next;
+    else
+        cache->head = entry->next;
+    if (entry->next != THUMBNAIL_NONE)
+        cache->entries[entry->next].prev = entry->prev;
+    else
+        cache->tail = entry->prev;
+    entry->prev = entry->next = THUMBNAIL_NONE;
+}
+
+static void imgui_thumbnail_push_front(int index)
+{
+    imgui_thumbnail_t *entry = &(cache->entries[index]);
+    entry->prev = THUMBNAIL_NONE;
+    entry->next = cache->head;
+    if (cache->head != THUMBNAIL_NONE)
+        cache->entries[cache->head].prev = index;
+    cache->head = index;
+    if (cache->tail == THUMBNAIL_NONE)
+        cache->tail = index;
+}
+
+// The preview texture is deleted by the GL thread once no frame in flight draws it.
+static void imgui_thumbnail_release(int index)
+{
+    imgui_thumbnail_t *entry = &(cache->entries[index]);
+    imgui_thumbnail_unlink(index);
+    if (entry->thumbnail != 0)
+        cache->pending.deletes.push_back(entry->thumbnail);
+    cache->lookup.SetInt((ImGuiID)entry->source, 0);
+    cache->stats.bytes -= entry->bytes;
+    cache->stats.count--;
+    memset(entry, 0, sizeof(imgui_thumbnail_t));
+    entry->next = cache->freeList;
+    cache->freeList = index;
+}
+
+// Returns 0 when the budget cannot fit needed more bytes without evicting a
+// preview the current frame already drew.
+static int imgui_thumbnail_evict(unsigned long long needed)
+{
+    while (cache->tail != THUMBNAIL_NONE && cache->stats.bytes + needed > cache->stats.budget)
+    {
+        if (cache->entries[cache->tail].usedFrame == cache->frame)
+            return 0;
+        imgui_thumbnail_release(cache->tail);
+        cache->stats.evictions++;
+    }
+    return cache->stats.bytes + needed <= cache->stats.budget;
+}
+
+static void imgui_thumbnail_batch_delete(imgui_thumbnail_batch_t *batch)
+{
+    if (batch->deletes.Size > 0)
+        glDeleteTextures(batch->deletes.Size, batch->deletes.Data);
+    batch->deletes.resize(0);
+}
+
+static void imgui_thumbnail_release_all()
+{
+    for (int i = 0; i < cache->entries.Size; i++)
+    {
+        if (cache->entries[i].thumbnail != 0)
+            glDeleteTextures(1, &(cache->entries[i].thumbnail));
+    }
+    imgui_thumbnail_batch_delete(&(cache->pending));
+    if (cache->readFramebuffer != 0)
+        glDeleteFramebuffers(1, &(cache->readFramebuffer));
+    if (cache->drawFramebuffer != 0)
+        glDeleteFramebuffers(1, &(cache->drawFramebuffer));
+
+    cache->entries.clear();
+    cache->lookup.Clear();
+    cache->pending.builds.clear();
+    cache->pending.deletes.clear();
+    cache->head = cache->tail = cache->freeList = THUMBNAIL_NONE;
+    cache->readFramebuffer = cache->drawFramebuffer = 0;
+    cache->queuedThisFrame = 0;
+    memset(&(cache->stats), 0, sizeof(cache->stats));
+}
+
+imgui_thumbnail_cache_t *imgui_thumbnail_init(unsigned long long budget)
+{
+    cache = IM_NEW(imgui_thumbnail_cache_t)();
+    cache->head = cache->tail = cache->freeList = THUMBNAIL_NONE;
+    cache->stats.budget = budget;
+    cache->stats.maxBuildsPerFrame = IMGUI_THUMBNAIL_BUILDS_PER_FRAME;
+    cache->batch = imgui_thumbnail_batch_create();
+    glGenFramebuffers(1, &(cache->readFramebuffer));
+    glGenFramebuffers(1, &(cache->drawFramebuffer));
+    return cache;
+}
+
+int imgui_thumbnail_cleanup()
+{
+    imgui_thumbnail_release_all();
+    imgui_thumbnail_batch_destroy(cache->batch);
+    cache->batch = NULL;
+    if (cache != &defaultCache)
+        IM_DELETE(cache);
+    cache = &defaultCache;
+    return 0;
+}
+
+void imgui_thumbnail_bind(imgui_thumbnail_cache_t *bound)
+{
+    cache = bound != NULL ? bound : &defaultCache;
+}
+
+imgui_thumbnail_batch_t *imgui_thumbnail_batch_create()
+{
+    return IM_NEW(imgui_thumbnail_batch_t)();
+}
+
+// Needs the GL context when the batch still holds evicted previews.
+void imgui_thumbnail_batch_destroy(imgui_thumbnail_batch_t *batch)
+{
+    if (batch == NULL)
+        return;
+    imgui_thumbnail_batch_delete(batch);
+    IM_DELETE(batch);
+}
+
+void imgui_thumbnail_begin_frame()
+{
+    thumbnail_lock();
+    cache->frame++;
+    cache->queuedThisFrame = 0;
+    thumbnail_unlock();
+}
+
+void imgui_thumbnail_set_budget(unsigned long long budget)
+{
+    thumbnail_lock();
+    cache->stats.budget = budget;
+    imgui_thumbnail_evict(0);
+    thumbnail_unlock();
+}
+
+void imgui_thumbnail_invalidate(unsigned int texture)
+{
+    thumbnail_lock();
+    int index = cache->lookup.GetInt((ImGuiID)texture, 0) - 1;
+    if (index >= 0)
+        imgui_thumbnail_release(index);
+    thumbnail_unlock();
+}
+
+const imgui_thumbnail_stats_t *imgui_thumbnail_get_stats()
+{
+    return &(cache->stats);
+}
+
+// Downscales mip 0 of source into a new IMGUI_THUMBNAIL_SIZE texture with a
+// single linear blit. Returns 0 when the source is not color-renderable.
+static GLuint imgui_thumbnail_build(GLuint source, int *width, int *height)
+{
+    GLint lastTexture = 0, lastRead = 0, lastDraw = 0;
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &lastTexture);
+    glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &lastRead);
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &lastDraw);
+
+    GLint srcWidth = 0, srcHeight = 0, compressed = 0;
+    glBindTexture(GL_TEXTURE_2D, source);
+    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &srcWidth);
+    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &srcHeight);
+    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_COMPRESSED, &compressed);
+
+    GLuint thumbnail = 0;
+    if (srcWidth > 0 && srcHeight > 0 && !compressed)
+    {
+        // Keep the aspect ratio, never upscale.
+        int w = srcWidth, h = srcHeight;
+        if (w > IMGUI_THUMBNAIL_SIZE || h > IMGUI_THUMBNAIL_SIZE)
+        {
+            if (w >= h)
+            {
+                h = h * IMGUI_THUMBNAIL_SIZE / w;
+                w = IMGUI_THUMBNAIL_SIZE;
+            }
+            else
+            {
+                w = w * IMGUI_THUMBNAIL_SIZE / h;
+                h = IMGUI_THUMBNAIL_SIZE;
+            }
+        }
+        w = w > 0 ? w : 1;
+        h = h > 0 ? h : 1;
+
+        glGenTextures(1, &thumbnail);
+        glBindTexture(GL_TEXTURE_2D, thumbnail);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, cache->readFramebuffer);
+        glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, source, 0);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, cache->drawFramebuffer);
+        glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, thumbnail, 0);
+
+        if (glCheckFramebufferStatus(GL_READ_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE &&
+            glCheckFramebufferStatus(GL_DRAW_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE)
+        {
+            glBlitFramebuffer(0, 0, srcWidth, srcHeight, 0, 0, w, h, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+            *width = w;
+            *height = h;
+        }
+        else
+        {
+            glDeleteTextures(1, &thumbnail);
+            thumbnail = 0;
+        }
+
+        glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, 0, 0);
+        glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, 0, 0);
+    }
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, (GLuint)lastRead);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, (GLuint)lastDraw);
+    glBindTexture(GL_TEXTURE_2D, (GLuint)lastTexture);
+    return thumbnail;
+}
+
+// Runs on the thread building the frame and makes no GL calls: a miss queues the
+// build for imgui_thumbnail_flush or the batch imgui_publish_frame hands to the renderer.
+int imgui_thumbnail_get(unsigned int texture, unsigned int *thumbnail, int *width, int *height)
+{
+    *thumbnail = 0;
+    if (texture == 0 || cache->readFramebuffer == 0)
+        return 0;
+
+    thumbnail_lock();
+    int index = cache->lookup.GetInt((ImGuiID)texture, 0) - 1;
+    if (index >= 0)
+    {
+        cache->stats.hits++;
+        imgui_thumbnail_unlink(index);
+        imgui_thumbnail_push_front(index);
+        imgui_thumbnail_t *entry = &(cache->entries[index]);
+        entry->usedFrame = cache->frame;
+        *thumbnail = entry->thumbnail;
+        *width = entry->width;
+        *height = entry->height;
+        thumbnail_unlock();
+        return *thumbnail != 0;
+    }
+
+    // Spread builds over frames so opening a large material list does not stall.
+    cache->stats.misses++;
+    unsigned long long bytes = THUMBNAIL_MAX_BYTES;
+    int queue = 1;
+    if (bytes > cache->stats.budget)
+    {
+        // Too large for the whole budget, remember the failure rather than retrying.
+        bytes = 0;
+        queue = 0;
+    }
+    if (cache->queuedThisFrame >= cache->stats.maxBuildsPerFrame || !imgui_thumbnail_evict(bytes))
+    {
+        // Over the per frame limit, or the rest of the budget is drawn by this frame.
+        thumbnail_unlock();
+        return 0;
+    }
+
+    if (cache->freeList != THUMBNAIL_NONE)
+    {
+        index = cache->freeList;
+        cache->freeList = cache->entries[index].next;
+    }
+    else
+    {
+        index = cache->entries.Size;
+        cache->entries.push_back(imgui_thumbnail_t());
+    }
+    imgui_thumbnail_t *entry = &(cache->entries[index]);
+    memset(entry, 0, sizeof(imgui_thumbnail_t));
+    entry->source = texture;
+    entry->bytes = bytes;
+    entry->usedFrame = cache->frame;
+    entry->queued = queue;
+    imgui_thumbnail_push_front(index);
+    cache->lookup.SetInt((ImGuiID)texture, index + 1);
+    cache->stats.bytes += bytes;
+    cache->stats.count++;
+    if (queue)
+    {
+        cache->pending.builds.push_back(texture);
+        cache->queuedThisFrame++;
+    }
+    thumbnail_unlock();
+    return 0;
+}
+
+// Moves the builds and deletes requested since the last take into batch,
+// appending to the ones it may still hold. Needs no GL context.
+void imgui_thumbnail_take(imgui_thumbnail_batch_t *batch)
+{
+    thumbnail_lock();
+    for (int i = 0; i < cache->pending.builds.Size; i++)
+        batch->builds.push_back(cache->pending.builds[i]);
+    for (int i = 0; i < cache->pending.deletes.Size; i++)
+        batch->deletes.push_back(cache->pending.deletes[i]);
+    cache->pending.builds.resize(0);
+    cache->pending.deletes.resize(0);
+    thumbnail_unlock();
+}
+
+// Needs the GL context of the cache's framebuffers. Deletes the evicted previews,
+// builds the queued ones and empties batch; a build whose entry was evicted
+// meanwhile is dropped.
+void imgui_thumbnail_run(imgui_thumbnail_batch_t *batch)
+{
+    imgui_thumbnail_batch_delete(batch);
+    for (int i = 0; i < batch->builds.Size; i++)
+    {
+        GLuint source = batch->builds[i];
+        int w = 0, h = 0;
+        GLuint built = glIsTexture(source) ? imgui_thumbnail_build(source, &w, &h) : 0;
+        unsigned long long bytes = (unsigned long long)w * (unsigned long long)h * 4;
+
+        thumbnail_lock();
+        int index = cache->lookup.GetInt((ImGuiID)source, 0) - 1;
+        imgui_thumbnail_t *entry = index >= 0 ? &(cache->entries[index]) : NULL;
+        if (entry != NULL && entry->queued)
+        {
+            entry->thumbnail = built;
+            entry->width = w;
+            entry->height = h;
+            cache->stats.bytes += bytes;
+            cache->stats.bytes -= entry->bytes;
+            entry->bytes = bytes;
+            entry->queued = 0;
+            cache->stats.builds++;
+            built = 0;
+        }
+        thumbnail_unlock();
+        // Never handed to ImGui, so it can go right away.
+        if (built != 0)
+            glDeleteTextures(1, &built);
+    }
+    batch->builds.resize(0);
+}
+
+// Needs the GL context. Runs from imgui_end_frame; imgui_publish_frame takes the
+// requests into the published frame instead.
+void imgui_thumbnail_flush()
+{
+    if (cache->batch == NULL)
+        return;
+    imgui_thumbnail_take(cache->batch);
+    imgui_thumbnail_run(cache->batch);
+}